@@ -26,6 +26,7 @@ namespace detail
 	class	events_operation;
 	struct	basic_window;
 	class	window_manager;
+	class	damage_region;
 
 	
 	/// @brief	fundamental core component, it provides an abstraction to the OS platform and some basic functions.
@@ -44,7 +45,10 @@ namespace detail
 
 		~bedrock();
 		void pump_event(window, bool is_modal);
-		void flush_surface(core_window_t*, bool forced, const rectangle* update_area = nullptr);
+		void flush_surface(core_window_t*, bool forced, const damage_region* damage = nullptr);
+
+		/// Asks the thread of a root window to flush the pending frame of the root window, it can be called by any thread.
+		void post_frame(core_window_t* root_wd);
 		static int inc_window(unsigned tid = 0);
 		thread_context* open_thread_context(unsigned tid = 0);
 		thread_context* get_thread_context(unsigned tid = 0);
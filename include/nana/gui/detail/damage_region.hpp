@@ -0,0 +1,178 @@
+/*
+ *	Damage Region Implementation
+ *	Nana C++ Library(http://www.nanapro.org)
+ *	Copyright(C) 2017 Jinhao(cnjinhao@hotmail.com)
+ *
+ *	Distributed under the Boost Software License, Version 1.0.
+ *	(See accompanying file LICENSE_1_0.txt or copy at
+ *	http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *	@file: nana/gui/detail/damage_region.hpp
+ *
+ */
+
+#ifndef NANA_GUI_DETAIL_DAMAGE_REGION_HPP
+#define NANA_GUI_DETAIL_DAMAGE_REGION_HPP
+#include <nana/push_ignore_diagnostic>
+
+#include <nana/gui/basis.hpp>
+#include <nana/gui/layout_utility.hpp>
+#include <vector>
+#include <algorithm>
+
+namespace nana{
+namespace detail
+{
+	//class damage_region
+	//@brief:	A list of rectangles which are damaged and need to be recomposed and copied to the screen, the rectangles
+	//			are in the root coordinate. A rectangle is merged with another if their bounding rectangle doesn't cover
+	//			much more pixels than they do, and the pair wasting the fewest pixels is merged if there are too many
+	//			rectangles. The rectangles may overlap each other.
+	class damage_region
+	{
+		static const std::size_t max_rectangles = 8;
+	public:
+		damage_region() = default;
+
+		explicit damage_region(const rectangle& r)
+		{
+			add(r);
+		}
+
+		bool empty() const
+		{
+			return rects_.empty();
+		}
+
+		const std::vector<rectangle>& rectangles() const
+		{
+			return rects_;
+		}
+
+		void clear()
+		{
+			rects_.clear();
+		}
+
+		void add(rectangle r)
+		{
+			if (r.empty())
+				return;
+
+			for (std::size_t i = 0; i < rects_.size();)
+			{
+				if (covered(r, rects_[i]))
+					return;
+
+				if (covered(rects_[i], r))
+				{
+					rects_.erase(rects_.begin() + i);
+					continue;
+				}
+
+				//The merged rectangle may be merged with the rectangles which have been tested.
+				if (_m_waste(rects_[i], r) * 4 <= _m_pixels(_m_unite(rects_[i], r)))
+				{
+					r = _m_unite(rects_[i], r);
+					rects_.erase(rects_.begin() + i);
+					i = 0;
+					continue;
+				}
+				++i;
+			}
+
+			rects_.push_back(r);
+
+			if (rects_.size() > max_rectangles)
+			{
+				std::size_t first = 0, second = 1;
+				auto least = _m_waste(rects_[0], rects_[1]);
+				for (std::size_t i = 0; i < rects_.size(); ++i)
+				{
+					for (std::size_t k = i + 1; k < rects_.size(); ++k)
+					{
+						auto const waste = _m_waste(rects_[i], rects_[k]);
+						if (waste < least)
+						{
+							least = waste;
+							first = i;
+							second = k;
+						}
+					}
+				}
+
+				r = _m_unite(rects_[first], rects_[second]);
+				rects_.erase(rects_.begin() + second);
+				rects_.erase(rects_.begin() + first);
+				add(r);
+			}
+		}
+
+		void add(const damage_region& other)
+		{
+			for (auto & r : other.rects_)
+				add(r);
+		}
+
+		//Clips the rectangles by the specified rectangle, the rectangles outside it are removed.
+		void clip(const rectangle& r)
+		{
+			std::vector<rectangle> clipped;
+			for (auto & dr : rects_)
+			{
+				rectangle ovlp;
+				if (overlap(dr, r, ovlp))
+					clipped.push_back(ovlp);
+			}
+			rects_.swap(clipped);
+		}
+
+		bool overlapped(const rectangle& r) const
+		{
+			for (auto & dr : rects_)
+			{
+				if (::nana::overlapped(dr, r))
+					return true;
+			}
+			return false;
+		}
+
+		rectangle bounds() const
+		{
+			if (rects_.empty())
+				return{};
+
+			auto r = rects_[0];
+			for (auto & dr : rects_)
+				r = _m_unite(r, dr);
+			return r;
+		}
+	private:
+		static rectangle _m_unite(const rectangle& a, const rectangle& b)
+		{
+			auto const x = (std::min)(a.x, b.x);
+			auto const y = (std::min)(a.y, b.y);
+			return{ x, y, static_cast<unsigned>((std::max)(a.right(), b.right()) - x), static_cast<unsigned>((std::max)(a.bottom(), b.bottom()) - y) };
+		}
+
+		static unsigned long long _m_pixels(const rectangle& r)
+		{
+			return static_cast<unsigned long long>(r.width) * r.height;
+		}
+
+		//Returns the number of pixels which are covered by the bounding rectangle but not by the two rectangles.
+		static unsigned long long _m_waste(const rectangle& a, const rectangle& b)
+		{
+			rectangle ovlp;
+			auto const ovlp_pixels = (overlap(a, b, ovlp) ? _m_pixels(ovlp) : 0);
+			return _m_pixels(_m_unite(a, b)) - (_m_pixels(a) + _m_pixels(b) - ovlp_pixels);
+		}
+	private:
+		std::vector<rectangle> rects_;
+	};
+}//end namespace detail
+}//end namespace nana
+
+#include <nana/pop_ignore_diagnostic>
+
+#endif //NANA_GUI_DETAIL_DAMAGE_REGION_HPP
@@ -5,6 +5,7 @@
 #include <nana/paint/pixel_buffer.hpp>
 #include <nana/gui/layout_utility.hpp>
 #include <nana/gui/detail/window_layout.hpp>
+#include <nana/gui/detail/damage_region.hpp>
 
 namespace nana{
 	namespace detail
@@ -56,7 +57,7 @@ namespace nana{
 				}
 			}
 
-			void render(core_window_t * wd, bool forced, const rectangle* update_area = nullptr)
+			void render(core_window_t * wd, bool forced, const damage_region* damage = nullptr)
 			{
 				bool copy_separately = true;
 				std::vector<std::pair<rectangle, core_window_t*>>	rd_set;
@@ -80,8 +81,8 @@ namespace nana{
 						{
 							if (action.window == wd)
 							{
-								if (update_area)
-									::nana::overlap(*update_area, rectangle(r), r);
+								if (damage)
+									::nana::overlap(damage->bounds(), rectangle(r), r);
 								copy_separately = false;
 							}
 
@@ -116,9 +117,20 @@ namespace nana{
 					rectangle vr;
 					if (window_layer::read_visual_rectangle(wd, vr))
 					{
-						if (update_area)
-							::nana::overlap(*update_area, rectangle(vr), vr);
-						wd->root_graph->paste(wd->root, vr, vr.x, vr.y);
+						if (damage)
+						{
+							//Only the damaged pixels are copied to the screen, and the screen is updated once for all of them.
+							std::vector<rectangle> areas;
+							rectangle r;
+							for (auto & dr : damage->rectangles())
+							{
+								if (::nana::overlap(dr, vr, r))
+									areas.push_back(r);
+							}
+							wd->root_graph->paste(wd->root, areas);
+						}
+						else
+							wd->root_graph->paste(wd->root, vr, vr.x, vr.y);
 					}
 				}
 
@@ -15,6 +15,7 @@
 
 #include "../basis.hpp"
 #include <nana/paint/image.hpp>
+#include <functional>
 
 namespace nana
 {
@@ -30,6 +30,7 @@ namespace nana{
 namespace detail
 {
 	struct basic_window;
+	class damage_region;
 
 	//class window_layout
 	class window_layout
@@ -49,11 +50,14 @@ namespace detail
 			try_refresh
 		};
 	public:
-		static void paint(core_window_t*, paint_operation, bool request_refresh_children);
+		//paint
+		//@brief:	Paints the window and recomposes it into the root graphics. If a damage region is specified, only the
+		//			damaged pixels are recomposed, the region is ignored when the children are requested to be refreshed.
+		static void paint(core_window_t*, paint_operation, bool request_refresh_children, const damage_region* = nullptr);
 
-		static bool maproot(core_window_t*, bool have_refreshed, bool request_refresh_children);
+		static bool maproot(core_window_t*, bool have_refreshed, bool request_refresh_children, const damage_region* = nullptr);
 
-		static void paste_children_to_graphics(core_window_t*, nana::paint::graphics& graph);
+		static void paste_children_to_graphics(core_window_t*, nana::paint::graphics& graph, const damage_region* = nullptr);
 
 		//read_visual_rectangle
 		//@brief:	Reads the visual rectangle of a window, the visual rectangle's reference frame is to root widget,
@@ -76,6 +80,14 @@ namespace detail
 		//@brief:paste children window to the root graphics directly. just paste the visual rectangle
 		static void _m_paste_children(core_window_t*, bool have_refreshed, bool request_refresh_children, const nana::rectangle& parent_rect, nana::paint::graphics& graph, const nana::point& graph_rpos);
 
+		//_m_maproot
+		//@brief: recompose the specified rectangle of the window, its children and the siblings which cover it into the root graphics.
+		static void _m_maproot(core_window_t*, bool have_refreshed, bool request_refresh_children, const nana::rectangle& vr);
+
+		//_m_refresh
+		//@brief: refreshes the drawer of the window, the window is marked as refreshing during the refresh.
+		static void _m_refresh(core_window_t*);
+
 		static void _m_paint_glass_window(core_window_t*, bool is_redraw, bool is_child_refreshed, bool called_by_notify, bool notify_other);
 
 		//Notify the windows which have brground to update their background buffer.
@@ -23,6 +23,7 @@
 #include "event_code.hpp"
 #include "inner_fwd.hpp"
 #include <functional>
+#include <chrono>
 
 namespace nana
 {
@@ -38,6 +39,7 @@ namespace nana{
 namespace detail
 {
 	class widget_notifier_interface;	//forward declaration
+	class damage_region;				//forward declaration
 
 	struct root_misc;
 
@@ -69,6 +71,12 @@ namespace detail
 
 		using core_window_t = basic_window;
 
+		struct refresh_statistics
+		{
+			std::size_t frames;		//The number of frames which are displayed for the coalesced refreshes.
+			std::size_t skipped;	//The number of refreshes which are merged into the pending refreshes.
+		};
+
 		window_manager();
 		~window_manager();
 
@@ -117,12 +125,19 @@ namespace detail
 
 		//Copy the root buffer that wnd specified into DeviceContext
 		void map(core_window_t*, bool forced, const rectangle* update_area = nullptr);
+		void map(core_window_t*, bool forced, const damage_region&);
 
 		bool update(core_window_t*, bool redraw, bool force, const rectangle* update_area = nullptr);
 		void refresh_tree(core_window_t*);
 
 		void do_lazy_refresh(core_window_t*, bool force_copy_to_screen, bool refresh_tree = false);
 
+		void frame_rate(unsigned fps);
+		unsigned frame_rate() const;
+		void flush_refresh();
+		void flush_frame(core_window_t* root_wd);
+		refresh_statistics refresh_stats() const;
+
 		bool get_graphics(core_window_t*, nana::paint::graphics&);
 		bool get_visual_rectangle(core_window_t*, nana::rectangle&);
 
@@ -161,6 +176,14 @@ namespace detail
 		void _m_move_core(core_window_t*, const point& delta);
 		core_window_t* _m_find(core_window_t*, const point&);
 		static bool _m_effective(core_window_t*, const point& root_pos);
+
+		void _m_map(core_window_t*, bool forced, const damage_region*);
+		bool _m_defer(core_window_t*, bool redraw, const rectangle* update_area);
+		void _m_schedule(std::chrono::steady_clock::time_point due);
+		void _m_flush_frame(core_window_t* root_wd);
+		void _m_flush_frames();
+		std::chrono::steady_clock::time_point _m_post_frames();
+		void _m_frame_proc();
 	private:
 		mutable mutex_type mutex_;
 
@@ -299,9 +299,32 @@ namespace API
 	 * @param window_handle A handle to the window to be refreshed.
 	 */
 	void refresh_window(window window_handle);
+
+	/// Refreshes the window like refresh_window(window), but only the specified area is recomposed and displayed.
+	/// It is useful when a small part of the window is changed, such as a hovered item.
+	/// @param area The damaged area in the coordinate of the window.
+	void refresh_window(window window_handle, const rectangle& area);
 	void refresh_window_tree(window);      ///< Refreshes the specified window and all its children windows, then display it immediately
 	void update_window(window);            ///< Copies the off-screen buffer to the screen for immediate display.
 
+	/// Sets the maximum number of frames per second for the refreshes which are requested outside of event handlers.
+	/// The refreshes of a root window within a frame interval are coalesced and displayed at once, 0 disables the coalescence.
+	/// The default is 60.
+	/// A rate above 1000000 is treated as 0.
+	/// @remark When a frame is due, the coalesced refreshes are displayed by the GUI thread of the root window, the drawers
+	/// are not invoked by other threads.
+	void refresh_rate(unsigned fps);
+	unsigned refresh_rate();
+	void flush_refresh();                  ///< Displays the coalesced refreshes immediately.
+
+	struct refresh_statistics
+	{
+		std::size_t frames;		///< The number of frames which are displayed for the coalesced refreshes.
+		std::size_t skipped;	///< The number of refreshes which are merged into the pending refreshes.
+	};
+
+	refresh_statistics refresh_stats();
+
 	void window_caption(window, const std::string& title_utf8);
 	void window_caption(window, const std::wstring& title);
 	::std::string window_caption(window);
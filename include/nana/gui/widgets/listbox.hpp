@@ -703,6 +703,22 @@ namespace nana
 
 			using inline_notifier_interface = detail::inline_widget_notifier_interface<index_pair, inline_widget_status, ::std::string>;
 
+			/// The keys which are extracted from the texts of a column for the default sorting
+			enum class sort_key
+			{
+				text,		///< The texts are compared in byte order
+				numeric,	///< The texts are compared as numbers, the texts which are not numbers are placed after the numbers
+				locale		///< The texts are compared by the collation of the user's locale
+			};
+
+			/// The options of importing items from delimited text, such as CSV and TSV.
+			struct import_options
+			{
+				char sep{ '\t' };			///< The separator of fields.
+				bool quoted{ false };		///< The fields may be enclosed in quotation marks(RFC 4180), a quoted field may contain separators and line breaks.
+				bool skip_first_row{ false };	///< Skips the first row, such as a header.
+			};
+
 			// struct essence
 			//@brief:	this struct gives many data for listbox,
 			//			the state of the struct does not effect on member funcions, therefore all data members are public.
@@ -1039,10 +1055,49 @@ namespace nana
 
 				model_guard model();
 
+				/// Makes the category virtual, its items are provided by a source instead of being stored by the listbox.
+				/**
+				 * The listbox only keeps the number of items, the cells of an item are requested from the source when the item is
+				 * displayed, and the recently requested items are cached. The items of a virtual category can't be inserted, erased
+				 * or modified one by one, and they are not sorted by the listbox.
+				 * @param items The number of items.
+				 * @param source A function which returns the cells of the item at the specified absolute position.
+				 */
+				void virtualize(size_type items, std::function<std::vector<cell>(size_type pos)> source);
+
+				/// Changes the number of items of a virtual category, the states of the removed items are discarded.
+				void virtual_size(size_type items);
+
+				/// Discards the cached items of a virtual category, the cells are requested again when they are displayed.
+				void invalidate();
+
 				/// Appends one item at the end of this category with the specifies text in the column fields
 				void append(std::initializer_list<std::string> texts_utf8);
 				void append(std::initializer_list<std::wstring> texts);
 
+				/// Appends items at the end of this category in a batch.
+				/**
+				 * The texts are copied into the column storage of the category at once, it doesn't allocate memory for each item.
+				 * @param items_utf8 The texts of each item in the order of columns, the texts beyond the columns are ignored.
+				 */
+				void append_items(const std::vector<std::vector<std::string>>& items_utf8);
+
+				/// Appends items at the end of this category from delimited text in UTF-8.
+				/**
+				 * The text is parsed by multiple threads and the fields are copied into the column storage of the category directly,
+				 * a row is ended by LF or CRLF and the blank lines are skipped. The fields beyond the columns are ignored.
+				 * @return The number of appended items.
+				 */
+				size_type import_items(const char* data, std::size_t len, const import_options&);
+
+				/// Appends items at the end of this category from a file of delimited text in UTF-8.
+				/**
+				 * The file is mapped into memory if it is possible, it is not read into a buffer. Throws std::runtime_error
+				 * if the file can't be opened.
+				 * @return The number of appended items.
+				 */
+				size_type import_file(const std::string& file_utf8, const import_options&);
+
 				size_type columns() const;
 
 				cat_proxy& text(std::string);
@@ -1126,6 +1181,9 @@ namespace nana
 					 only_checked_items {false},
 					 only_visible_columns{true};
 
+				/// Encloses the fields which contain the separator, quotation marks or line breaks in quotation marks(RFC 4180).
+				bool quote_fields{ false };
+
 				using columns_indexs = std::vector<size_type>;
 				columns_indexs columns_order;
 			};
@@ -1137,6 +1195,10 @@ namespace nana
 	{
 		mutable drawerbase::listbox::item_proxy item;
 
+		/// The number of the items whose states are changed. It is greater than 1 if the states are changed in a batch, such as
+		/// selecting all the items, then the event is emitted once and the item refers to the first changed item.
+		std::size_t changed_items{ 1 };
+
 		arg_listbox(const drawerbase::listbox::item_proxy&) noexcept;
 	};
 
@@ -1287,11 +1349,17 @@ the nana::detail::basic_window member pointer scheme
 		/// The options of exporting items into a string variable
 		using export_options = drawerbase::listbox::export_options;
 
+		/// The options of importing items from delimited text
+		using import_options = drawerbase::listbox::import_options;
+
 		/// The interface for user-defined inline widgets
 		using inline_notifier_interface = drawerbase::listbox::inline_notifier_interface;
 
 		/// Column operations
 		using column_interface = drawerbase::listbox::column_interface;
+
+		/// The keys of the default sorting
+		using sort_key = drawerbase::listbox::sort_key;
 	public:
 
 		/// Constructors
@@ -1449,6 +1517,11 @@ the nana::detail::basic_window member pointer scheme
 
 		void checkable(bool);
 		index_pairs checked() const;                         ///<Returns the items which are checked.
+		size_type size_checked() const;                      ///<Returns the number of the checked items.
+
+		/// Checks or unchecks all the items, the checked event is emitted once. Checking is ignored if single check is enabled.
+		/// Only the displayed items are changed if the items are filtered.
+		void check_all(bool ck = true);
 
 		void clear(size_type cat);			///<Removes all the items from the specified category
 		void clear();						///<Removes all the items from all categories
@@ -1464,6 +1537,9 @@ the nana::detail::basic_window member pointer scheme
 		void set_sort_compare(	size_type col,
 								std::function<bool(const std::string&, nana::any*, const std::string&, nana::any*, bool reverse)> strick_ordering);
 
+		/// Sets the key for the default sorting of a column, it is ignored if the column has a sort compare.
+		void set_sort_key(size_type col, sort_key);
+
 		/// sort() and ivalidate any existing reference from display position to absolute item, that is: after sort() display offset point to different items
 		void sort_col(size_type col, bool reverse = false);
 		size_type sort_col() const;
@@ -1472,7 +1548,41 @@ the nana::detail::basic_window member pointer scheme
 		void unsort();
 		bool freeze_sort(bool freeze);
 
+		/// Filters the items by a predicate, only the items which are accepted are displayed.
+		/**
+		 * The filter is also applied to the items which are inserted or modified later, it is not applied to the virtual categories.
+		 * The filter invalidates the display positions, the absolute positions of the items are not changed.
+		 * @param pred A predicate which determines whether an item is displayed by its cells. The filter is removed if it is empty.
+		 * @param narrowing Indicates whether the predicate accepts a subset of the items which are accepted by the current filter,
+		 *		only the displayed items are tested if it is true.
+		 */
+		void filter(std::function<bool(const std::vector<cell>&)> pred, bool narrowing = false);
+
+		/// Filters the items by a text query, only the items which contain the query in one of the specified columns are displayed.
+		/**
+		 * The ASCII letters are compared case-insensitively. When the query is extended, such as the user is typing, only the
+		 * displayed items are tested. The items of the categories without a model are tested by multiple threads.
+		 * @param query_utf8 The text to search for. The filter is removed if it is empty.
+		 * @param columns The absolute positions of the columns to search in, all columns are searched if it is empty.
+		 */
+		void filter_text(const std::string& query_utf8, std::vector<size_type> columns = {});
+
+		/// Removes the filter, all items are displayed.
+		void unfilter();
+
+		/// Determines whether the items are filtered.
+		bool filtered() const;
+
 		index_pairs selected() const;		///<Get the absolute indexs of all the selected items
+		size_type size_selected() const;	///<Returns the number of the selected items.
+
+		/// Selects or deselects all the items, the selected event is emitted once. Selecting is ignored if single selection is enabled.
+		/// Only the displayed items are changed if the items are filtered.
+		void select_all(bool sel = true);
+
+		/// Inverts the selection of all the items, the selected event is emitted once. It is ignored if single selection is enabled.
+		/// Only the displayed items are inverted if the items are filtered.
+		void invert_selection();
 
 		void show_header(bool);
 		bool visible_header() const;
@@ -1484,6 +1594,14 @@ the nana::detail::basic_window member pointer scheme
 		void enable_single(bool for_selection, bool category_limited);
 		void disable_single(bool for_selection);
 		export_options& def_export_options();
+
+		/// Exports the header and the items in the display order through an output function.
+		/**
+		 * The text is written in chunks, it is not built in memory. If the columns_order of options is empty, the columns
+		 * are exported in the order of header.
+		 * @param output The function which is invoked with each chunk of the text.
+		 */
+		void export_items(const export_options&, std::function<void(const char* data, std::size_t len)> output) const;
 	private:
 		drawerbase::listbox::essence & _m_ess() const;
 		nana::any* _m_anyobj(size_type cat, size_type index, bool allocate_if_empty) const override;
@@ -17,11 +17,14 @@
 
 #include "textbase.hpp"
 #include "text_editor_part.hpp"
+#include "text_lexer.hpp"
 #include <nana/unicode_bidi.hpp>
 
 #include <nana/gui/detail/general_events.hpp>
 
 #include <functional>
+#include <atomic>
+#include <memory>
 
 namespace nana
 {
@@ -36,6 +39,30 @@ namespace nana{	namespace widgets
 {
 	namespace skeletons
 	{
+		/// A queue of the lines which are pushed by any thread and appended to a text_editor by the GUI thread.
+		/// It is shared with the owner of the text_editor, the lines can be pushed without accessing the text_editor.
+		class line_stream
+		{
+			struct node;
+
+			line_stream(const line_stream&) = delete;
+			line_stream& operator=(const line_stream&) = delete;
+		public:
+			line_stream() = default;
+			~line_stream();
+
+			/// Queues the lines of a text, a trailing new line doesn't make an empty line. Returns false if it is disabled.
+			bool push(std::wstring text);
+
+			/// Returns the queued lines in the order they were pushed, and empties the queue.
+			std::vector<std::wstring> take();
+
+			void enable(bool);
+		private:
+			std::atomic<bool> enabled_{ false };
+			std::atomic<node*> head_{ nullptr };	//The last queued line, the lines are linked in the reversed order.
+		};
+
 		class text_editor
 		{
 			struct attributes;
@@ -44,15 +71,17 @@ namespace nana{	namespace widgets
 			class behavior_linewrapped;
 
 			enum class command{
-				backspace, input_text, move_text,
+				backspace, input_text, move_text, replace_text,
 			};
 			//Commands for undoable
 			template<typename EnumCommand> class basic_undoable;
 			class undo_backspace;
 			class undo_input_text;
 			class undo_move_text;
+			class undo_replace_text;
 
 			class keyword_parser;
+			class background_lexer;
 			class helper_pencil;
 
 			struct text_section;
@@ -92,6 +121,21 @@ namespace nana{	namespace widgets
 			void set_keyword(const ::std::wstring& kw, const std::string& name, bool case_sensitive, bool whole_word_matched);
 			void erase_keyword(const ::std::wstring& kw);
 
+			/// Sets a lexer which highlights the text in a worker thread, the keywords are not highlighted while a lexer is set.
+			void set_lexer(::std::shared_ptr<text_lexer_interface>);
+
+			/// Searches the whole text in parallel, the fn is invoked with the matches of a batch of lines in order, and the
+			/// search is stopped if it returns false. Returns the number of reported matches.
+			/// Throws std::regex_error if the pattern is an invalid regular expression.
+			std::size_t find_all(const ::std::wstring& pattern, const text_search_options&, const ::std::function<bool(const ::std::vector<text_range>&)>& fn);
+
+			/// Replaces all the matches, it is undone as one step. The replacement is cut at its first CR or LF.
+			/// Returns the number of replaced matches.
+			std::size_t replace_all(const ::std::wstring& pattern, const ::std::wstring& replacement, const text_search_options&);
+
+			/// Highlights the matches of the visible lines with a scheme which is set by set_highlight(). An empty pattern removes the highlight.
+			void highlight_matches(const ::std::wstring& pattern, const text_search_options&, const ::std::string& scheme);
+
 			colored_area_access_interface& colored_area();
 
 			void set_accept(std::function<bool(char_type)>);
@@ -199,6 +243,15 @@ namespace nana{	namespace widgets
 			void backspace(bool record_undo = true);
 			void undo(bool reverse);
 			void set_undo_queue_length(std::size_t len);
+			void set_undo_memory_limit(std::size_t bytes);
+
+			/// Enables the lines queued by stream_queue() to be appended once per frame, and the oldest lines are discarded
+			/// if the number of lines exceeds max_lines. 0 means unlimited.
+			void stream(bool enable, std::size_t max_lines);
+
+			/// Returns the queue of the lines to be appended, it is kept by the owner to push lines from any thread.
+			/// The queue is disabled when the text_editor is destroyed.
+			const std::shared_ptr<line_stream>& stream_queue() const;
 			void move_ns(bool to_north);	//Moves up and down
 			void move_left();
 			void move_right();
@@ -235,6 +288,7 @@ namespace nana{	namespace widgets
 			::nana::color _m_bgcolor() const;
 
 			void _m_reset_content_size(bool calc_lines = false);
+			void _m_flush_stream();
 			void _m_reset();
 
 			//Inserts text at position where the caret is
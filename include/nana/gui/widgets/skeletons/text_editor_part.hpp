@@ -4,6 +4,7 @@
 
 #include "../../detail/widget_geometrics.hpp"
 #include <vector>
+#include <utility>
 
 namespace nana
 {
@@ -22,6 +23,7 @@ namespace nana
 
 			//forward declaration
 			class text_editor;
+			class line_stream;
 
 			struct text_editor_scheme
 				: public ::nana::widget_geometrics
@@ -33,6 +35,17 @@ namespace nana
 				parameters::mouse_wheel mouse_wheel;	///< The number of lines/characters to scroll when the vertical/horizontal mouse wheel is moved.
 			};
 
+			/// The options for searching text.
+			struct text_search_options
+			{
+				bool regex{ false };			///< The pattern is an ECMAScript regular expression.
+				bool case_sensitive{ true };
+				bool whole_word{ false };		///< The matched text is not adjacent to a letter, a digit or an underscore.
+			};
+
+			/// A matched text, it is the range [first.x, second.x) of the line first.y.
+			using text_range = std::pair<upoint, upoint>;
+
 			class text_editor_event_interface
 			{
 			public:
@@ -0,0 +1,52 @@
+/*
+ *	A Lexer Interface for Text Editor
+ *	Nana C++ Library(http://www.nanapro.org)
+ *	Copyright(C) 2003-2017 Jinhao(cnjinhao@hotmail.com)
+ *
+ *	Distributed under the Boost Software License, Version 1.0.
+ *	(See accompanying file LICENSE_1_0.txt or copy at
+ *	http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *	@file: nana/gui/widgets/skeletons/text_lexer.hpp
+ */
+
+#ifndef NANA_GUI_SKELETONS_TEXT_LEXER_HPP
+#define NANA_GUI_SKELETONS_TEXT_LEXER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace nana{	namespace widgets
+{
+	namespace skeletons
+	{
+		/// A highlighted part of a line which is produced by a lexer.
+		struct lexer_span
+		{
+			std::size_t begin;	///< The position of the first character in the line.
+			std::size_t end;	///< The position after the last character.
+			std::string scheme;	///< The name of a highlight scheme which is set by set_highlight().
+		};
+
+		/// An interface of lexer which tokenizes the text for highlighting.
+		/// The lines are tokenized in order by a worker thread. The state at the end of a line is passed to the next line,
+		/// it allows a lexer to recognize the tokens which span lines, such as block comments and strings.
+		class text_lexer_interface
+		{
+		public:
+			using state_type = std::size_t;
+
+			virtual ~text_lexer_interface() = default;
+
+			/// Tokenizes a line of text. It is invoked by the worker thread, it should not access the widget.
+			/// @param state The state at the beginning of the line, it is 0 for the first line.
+			/// @param line The text of the line.
+			/// @param spans The highlighted parts of the line are appended to it.
+			/// @return The state at the end of the line.
+			virtual state_type tokenize(state_type state, const std::wstring& line, std::vector<lexer_span>& spans) = 0;
+		};
+	}//end namespace skeletons
+}//end namespace widgets
+}//end namespace nana
+#endif	//NANA_GUI_SKELETONS_TEXT_LEXER_HPP
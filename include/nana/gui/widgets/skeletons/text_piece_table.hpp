@@ -0,0 +1,705 @@
+/*
+ *	A piece table for the text of textbase
+ *	Nana C++ Library(http://www.nanapro.org)
+ *	Copyright(C) 2003-2017 Jinhao(cnjinhao@hotmail.com)
+ *
+ *	Distributed under the Boost Software License, Version 1.0.
+ *	(See accompanying file LICENSE_1_0.txt or copy at
+ *	http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *	@file: nana/gui/widgets/skeletons/text_piece_table.hpp
+ *	@description: The default line storage of textbase. The bytes of a loaded file are kept as an original
+ *		buffer which is only indexed by line, a line is decoded into the add buffer when it is accessed
+ *		at the first time. The lines are referred by records which are located through a line index.
+ */
+
+#ifndef NANA_GUI_WIDGET_DETAIL_TEXT_PIECE_TABLE_HPP
+#define NANA_GUI_WIDGET_DETAIL_TEXT_PIECE_TABLE_HPP
+#include <nana/push_ignore_diagnostic>
+
+#include <nana/charset.hpp>
+#include <nana/traits.hpp>
+
+#include <nana/std_thread.hpp>
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+namespace nana
+{
+namespace widgets
+{
+namespace skeletons
+{
+	/// A sequence of records which supports the random access, insertion and erasing in O(log n).
+	/**
+	 * The records are stored in blocks, a Fenwick tree over the sizes of blocks locates the block of
+	 * a specified position.
+	 */
+	class text_line_index
+	{
+		static const std::size_t block_size = 512;
+	public:
+		using size_type = std::size_t;
+		using record_type = std::size_t;
+
+		size_type size() const
+		{
+			return size_;
+		}
+
+		void clear()
+		{
+			blocks_.clear();
+			tree_.clear();
+			top_ = 0;
+			size_ = 0;
+		}
+
+		/// Appends the records of a sequence of first, first + 1, ... last - 1.
+		void append_sequence(record_type first, record_type last)
+		{
+			if (first >= last)
+				return;
+
+			size_ += last - first;
+			while (first < last)
+			{
+				if (blocks_.empty() || blocks_.back().size() >= block_size)
+					blocks_.emplace_back();
+
+				auto & blk = blocks_.back();
+				auto const count = (std::min)(size_type(block_size) - blk.size(), last - first);
+				for (auto end = first + count; first != end; ++first)
+					blk.push_back(first);
+			}
+			_m_rebuild();
+		}
+
+		record_type& operator[](size_type pos)
+		{
+			auto loc = _m_locate(pos);
+			return blocks_[loc.first][loc.second];
+		}
+
+		const record_type& operator[](size_type pos) const
+		{
+			auto loc = _m_locate(pos);
+			return blocks_[loc.first][loc.second];
+		}
+
+		void insert(size_type pos, record_type rec)
+		{
+			std::pair<size_type, size_type> loc;
+			if (blocks_.empty())
+			{
+				blocks_.emplace_back();
+				_m_rebuild();
+				loc.first = loc.second = 0;
+			}
+			else if (pos >= size_)
+			{
+				loc.first = blocks_.size() - 1;
+				loc.second = blocks_.back().size();
+			}
+			else
+				loc = _m_locate(pos);
+
+			auto & blk = blocks_[loc.first];
+			blk.insert(blk.begin() + loc.second, rec);
+			++size_;
+
+			if (blk.size() < 2 * block_size)
+			{
+				_m_update(loc.first, 1);
+				return;
+			}
+
+			//Splits the block into two halves
+			std::vector<record_type> half(blk.begin() + block_size, blk.end());
+			blk.resize(block_size);
+			blocks_.emplace(blocks_.begin() + loc.first + 1, std::move(half));
+			_m_rebuild();
+		}
+
+		void erase(size_type pos, size_type n)
+		{
+			n = (std::min)(n, size_ - (std::min)(pos, size_));
+			while (n)
+			{
+				auto loc = _m_locate(pos);
+				auto & blk = blocks_[loc.first];
+				auto const count = (std::min)(n, blk.size() - loc.second);
+
+				blk.erase(blk.begin() + loc.second, blk.begin() + loc.second + count);
+				size_ -= count;
+				n -= count;
+
+				if (blk.empty())
+				{
+					blocks_.erase(blocks_.begin() + loc.first);
+					_m_rebuild();
+				}
+				else
+					_m_update(loc.first, 0 - count);
+			}
+		}
+	private:
+		//Returns the block and the offset in the block of a specified position
+		std::pair<size_type, size_type> _m_locate(size_type pos) const
+		{
+			size_type blk = 0;
+			for (auto mask = top_; mask; mask >>= 1)
+			{
+				auto next = blk + mask;
+				if (next <= tree_.size() && tree_[next - 1] <= pos)
+				{
+					blk = next;
+					pos -= tree_[next - 1];
+				}
+			}
+			return{ blk, pos };
+		}
+
+		//The delta is added in modular arithmetic, it decreases the size when a negative delta is wrapped.
+		void _m_update(size_type blk, size_type delta)
+		{
+			for (auto i = blk + 1; i <= tree_.size(); i += (i & (0 - i)))
+				tree_[i - 1] += delta;
+		}
+
+		void _m_rebuild()
+		{
+			tree_.resize(blocks_.size());
+			for (size_type i = 0; i < blocks_.size(); ++i)
+				tree_[i] = blocks_[i].size();
+
+			for (size_type i = 1; i <= tree_.size(); ++i)
+			{
+				auto parent = i + (i & (0 - i));
+				if (parent <= tree_.size())
+					tree_[parent - 1] += tree_[i - 1];
+			}
+
+			top_ = 0;
+			if (tree_.size())
+			{
+				top_ = 1;
+				while ((top_ << 1) <= tree_.size())
+					top_ <<= 1;
+			}
+		}
+	private:
+		std::vector<std::vector<record_type>> blocks_;
+		std::vector<size_type> tree_;
+		size_type top_{ 0 };
+		size_type size_{ 0 };
+	};
+
+	/// The offsets of the beginnings of lines.
+	/**
+	 * The offsets are appended by the indexing thread, they are readable by other thread after they are published.
+	 * The offsets are stored in chunks which are never moved, so that the reading doesn't require a lock.
+	 */
+	class text_line_offsets
+	{
+		static const std::size_t chunk_size = 0x1000;
+	public:
+		using size_type = std::size_t;
+
+		/// Prepares for at most capacity offsets.
+		void reset(size_type capacity)
+		{
+			chunks_.reset(new std::unique_ptr<size_type[]>[capacity / chunk_size + 1]);
+			written_ = 0;
+			published_.store(0);
+		}
+
+		void clear()
+		{
+			chunks_.reset();
+			written_ = 0;
+			published_.store(0);
+		}
+
+		void push_back(size_type offset)
+		{
+			auto & chunk = chunks_[written_ / chunk_size];
+			if (!chunk)
+				chunk.reset(new size_type[chunk_size]);
+
+			chunk[written_ % chunk_size] = offset;
+			++written_;
+		}
+
+		void publish()
+		{
+			published_.store(written_, std::memory_order_release);
+		}
+
+		/// Returns the number of published offsets.
+		size_type size() const
+		{
+			return published_.load(std::memory_order_acquire);
+		}
+
+		size_type operator[](size_type pos) const
+		{
+			return chunks_[pos / chunk_size][pos % chunk_size];
+		}
+	private:
+		std::unique_ptr<std::unique_ptr<size_type[]>[]> chunks_;
+		size_type written_{ 0 };
+		std::atomic<size_type> published_{ 0 };
+	};
+
+	/// A read-only view of the bytes of a file.
+	/**
+	 * A large file is mapped into memory if it is possible, otherwise it is read into a buffer. On POSIX, a small file
+	 * or a file which is opened for writing by a process is read into a buffer, because reading a mapped file raises
+	 * SIGBUS after the file is truncated. A mapped file should not be truncated by other processes while it is viewed.
+	 */
+	class text_file_view
+		: public ::nana::noncopyable
+	{
+	public:
+		text_file_view() = default;
+		text_file_view(text_file_view&&);
+		text_file_view& operator=(text_file_view&&);
+		~text_file_view();
+
+		bool open(const char* file_utf8);
+
+		/// Views the bytes of a buffer.
+		void assign(std::string&& bytes);
+		void close();
+
+		/// Determines whether the specified file is the file which is mapped.
+		bool maps(const char* file_utf8) const;
+
+		/// Copies the bytes of the mapped file into the buffer and unmaps the file, so that the file can be overwritten.
+		void detach();
+
+		const char* data() const;
+		std::size_t size() const;
+	private:
+		const char* mapped_{ nullptr };	//The address of the mapped file
+		std::size_t size_{ 0 };
+		std::string bytes_;				//The buffer of content when the file is not mapped.
+		unsigned long long file_id_[2]{};	//The identity of the mapped file, the device/volume and the file index.
+	};
+
+	/// The default storage of textbase.
+	/**
+	 * A line is referred by a record, it is either a line of the original buffer or an index of the add buffer.
+	 * Loading a file only views its bytes and indexes the line breaks, and every line costs an offset and a record
+	 * until it is accessed. A line is decoded into the add buffer when it is accessed or modified, the address
+	 * of an accessed line is kept until the line is erased.
+	 *
+	 * The lines behind the first megabytes of a large file are indexed by a background thread, the indexed lines
+	 * are appended to the storage when the storage is accessed. A modification waits for the end of indexing.
+	 */
+	template<typename CharT>
+	class text_piece_table
+		: public ::nana::noncopyable
+	{
+		using record_type = text_line_index::record_type;
+		static const record_type added_bit = ~((std::numeric_limits<record_type>::max)() >> 1);
+
+		static const std::size_t sync_index_bytes = 0x400000;	//The bytes which are indexed before a load returns.
+		static const std::size_t index_step_bytes = 0x100000;	//The bytes which are indexed between two publishings.
+	public:
+		using char_type = CharT;
+		using string_type = std::basic_string<CharT>;
+		using size_type = std::size_t;
+
+		text_piece_table()
+		{
+			clear();
+		}
+
+		~text_piece_table()
+		{
+			_m_stop_indexing();
+		}
+
+		/// Replaces the lines with the bytes of a text file.
+		/**
+		 * @param view The content of the file. UTF-16/UTF-32 should be in little-endian.
+		 * @param skip The bytes of BOM.
+		 * @param is_unicode Indicates whether the bytes are encoded in the specified encoding, or a multibyte string of current locale.
+		 */
+		void assign(text_file_view&& view, size_type skip, bool is_unicode, nana::unicode encoding)
+		{
+			_m_reset();
+
+			original_.view = std::move(view);
+			original_.data = original_.view.data() + (std::min)(skip, original_.view.size());
+			original_.size = original_.view.size() - (std::min)(skip, original_.view.size());
+			original_.is_unicode = is_unicode;
+			original_.encoding = encoding;
+			original_.unit = 1;
+			if (is_unicode)
+			{
+				if (nana::unicode::utf16 == encoding)
+					original_.unit = 2;
+				else if (nana::unicode::utf32 == encoding)
+					original_.unit = 4;
+			}
+
+			original_.offsets.reset(original_.size / original_.unit + 2);
+			original_.offsets.push_back(0);
+
+			auto & idx = indexer_;
+			idx.last_offset = 0;
+			idx.pushed = 1;
+			idx.longest_units = 0;
+			idx.longest.store(0);
+			idx.cancel = false;
+			idx.done = false;
+
+			auto const sync_bytes = (std::min)(original_.size, size_type(sync_index_bytes));
+			_m_index(0, sync_bytes);
+
+			if (sync_bytes < original_.size)
+			{
+				idx.active = true;
+				idx.thread = std::thread([this, sync_bytes]{
+					_m_index_remains(sync_bytes);
+				});
+			}
+			else
+				_m_index_remains(sync_bytes);
+
+			_m_sync();
+		}
+
+		void assign(std::string&& bytes, bool is_unicode, nana::unicode encoding)
+		{
+			text_file_view view;
+			view.assign(std::move(bytes));
+			assign(std::move(view), 0, is_unicode, encoding);
+		}
+
+		/// Removes all lines, and leaves an empty line.
+		void clear()
+		{
+			_m_reset();
+			records_.insert(0, _m_add(string_type{}));
+		}
+
+		/// Determines whether the lines are being indexed.
+		bool indexing() const
+		{
+			_m_sync();
+			return indexer_.active;
+		}
+
+		/// Waits for the end of indexing.
+		void complete()
+		{
+			if (indexer_.active)
+			{
+				indexer_.thread.join();
+				indexer_.active = false;
+				_m_sync();
+			}
+		}
+
+		/// Returns the longest line of the original buffer that is indexed, it is measured in encoding units.
+		size_type longest() const
+		{
+			auto const line = indexer_.longest.load();
+			return (line < size() ? line : 0);
+		}
+
+		size_type size() const
+		{
+			_m_sync();
+			return records_.size();
+		}
+
+		/// Returns the line, it is decoded and kept in the add buffer if it is not accessed yet.
+		const string_type& at(size_type pos) const
+		{
+			_m_sync();
+			auto & rec = records_[pos];
+			if (0 == (rec & added_bit))
+				rec = _m_add(_m_decode(rec));
+
+			return *added_[rec & ~added_bit];
+		}
+
+		/// Copies the bytes of the original buffer into memory if they are mapped from the specified file, it should be
+		/// called before the file is overwritten, because the lines which are not accessed are still read from the file.
+		void detach(const char* file_utf8)
+		{
+			complete();
+			if (original_.view.maps(file_utf8))
+			{
+				auto const skip = static_cast<size_type>(original_.data - original_.view.data());
+				original_.view.detach();
+				original_.data = original_.view.data() + skip;
+			}
+		}
+
+		string_type& modify(size_type pos)
+		{
+			complete();
+			return const_cast<string_type&>(at(pos));
+		}
+
+		/// Returns the line without keeping it in add buffer if it is not accessed yet, the buf is used for the decoding.
+		const string_type& peek(size_type pos, string_type& buf) const
+		{
+			_m_sync();
+			auto rec = records_[pos];
+			if (rec & added_bit)
+				return *added_[rec & ~added_bit];
+
+			buf = _m_decode(rec);
+			return buf;
+		}
+
+		/// Returns the length of a line. It is the number of encoding units for a line which is not decoded yet.
+		size_type measure(size_type pos) const
+		{
+			_m_sync();
+			auto rec = records_[pos];
+			if (rec & added_bit)
+				return added_[rec & ~added_bit]->size();
+
+			auto range = _m_range(rec);
+			return (range.second - range.first) / original_.unit;
+		}
+
+		void insert(size_type pos, string_type&& str)
+		{
+			complete();
+			records_.insert(pos, _m_add(std::move(str)));
+		}
+
+		void erase(size_type pos, size_type n)
+		{
+			complete();
+			n = (std::min)(n, size() - (std::min)(pos, size()));
+			for (size_type i = pos; i < pos + n; ++i)
+			{
+				auto rec = records_[i];
+				if (rec & added_bit)
+				{
+					added_[rec & ~added_bit].reset();
+					free_.push_back(rec & ~added_bit);
+				}
+			}
+			records_.erase(pos, n);
+		}
+	private:
+		void _m_stop_indexing()
+		{
+			if (indexer_.active)
+			{
+				indexer_.cancel = true;
+				indexer_.thread.join();
+				indexer_.active = false;
+			}
+		}
+
+		void _m_reset()
+		{
+			_m_stop_indexing();
+
+			records_.clear();
+			added_.clear();
+			free_.clear();
+
+			original_.view.close();
+			original_.data = nullptr;
+			original_.size = 0;
+			original_.offsets.clear();
+			indexer_.synced = 0;
+		}
+
+		//Appends the records of the lines which are indexed by the indexing thread.
+		void _m_sync() const
+		{
+			auto & idx = indexer_;
+			bool const done = idx.done.load();
+
+			auto const offsets = original_.offsets.size();
+			if (offsets > idx.synced + 1)
+			{
+				records_.append_sequence(idx.synced, offsets - 1);
+				idx.synced = offsets - 1;
+			}
+
+			if (done && idx.active)
+			{
+				idx.thread.join();
+				idx.active = false;
+			}
+		}
+
+		//Indexes the line breaks in [pos, last), the pos should be aligned to an encoding unit.
+		void _m_index(size_type pos, size_type last)
+		{
+			auto const unit = original_.unit;
+			auto const data = original_.data;
+
+			if (1 == unit)
+			{
+				for (auto p = data + pos, end = data + last; p != end; ++p)
+				{
+					p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+					if (!p)
+						break;
+
+					_m_push_offset(p - data + 1);
+				}
+			}
+			else
+			{
+				for (; pos + unit <= last; pos += unit)
+				{
+					if (_m_unit_is(pos, '\n'))
+						_m_push_offset(pos + unit);
+				}
+			}
+			original_.offsets.publish();
+		}
+
+		//Indexes the lines behind the pos, it is the procedure of the indexing thread.
+		void _m_index_remains(size_type pos)
+		{
+			while (pos < original_.size)
+			{
+				if (indexer_.cancel)
+					return;
+
+				auto const last = (std::min)(original_.size, pos + index_step_bytes);
+				_m_index(pos, last);
+				pos = last;
+			}
+
+			//The end of last line is treated as a line break
+			_m_push_offset(original_.size + original_.unit);
+			original_.offsets.publish();
+			indexer_.done = true;
+		}
+
+		void _m_push_offset(size_type offset)
+		{
+			auto & idx = indexer_;
+
+			//The offset ends the line which begins at the last offset
+			auto const units = (offset - idx.last_offset) / original_.unit;
+			if (units > idx.longest_units)
+			{
+				idx.longest_units = units;
+				idx.longest.store(idx.pushed - 1);
+			}
+
+			original_.offsets.push_back(offset);
+			idx.last_offset = offset;
+			++idx.pushed;
+		}
+
+		record_type _m_add(string_type&& str) const
+		{
+			std::unique_ptr<string_type> ptr{ new string_type(std::move(str)) };
+
+			if (free_.empty())
+			{
+				added_.emplace_back(std::move(ptr));
+				return (added_.size() - 1) | added_bit;
+			}
+
+			auto idx = free_.back();
+			free_.pop_back();
+			added_[idx].swap(ptr);
+			return idx | added_bit;
+		}
+
+		bool _m_unit_is(size_type offset, char ch) const
+		{
+			auto p = original_.data + offset;
+			if (*p != ch)
+				return false;
+
+			//The unit is in little-endian
+			for (unsigned i = 1; i < original_.unit; ++i)
+			{
+				if (p[i])
+					return false;
+			}
+			return true;
+		}
+
+		//Returns the range of bytes of an original line, the line break is excluded.
+		std::pair<size_type, size_type> _m_range(size_type line) const
+		{
+			auto const unit = original_.unit;
+			auto first = original_.offsets[line];
+			auto last = (std::min)(original_.offsets[line + 1] - unit, original_.size);
+
+			//Excludes the CR of CRLF
+			if (last >= first + unit && _m_unit_is(last - unit, '\r'))
+				last -= unit;
+
+			return{ first, (std::max)(first, last) };
+		}
+
+		string_type _m_decode(size_type line) const
+		{
+			auto range = _m_range(line);
+			std::string str(original_.data + range.first, range.second - range.first);
+
+			if (original_.is_unicode)
+				return static_cast<string_type&&>(nana::charset{ std::move(str), original_.encoding });
+
+			return static_cast<string_type&&>(nana::charset{ std::move(str) });
+		}
+	private:
+		struct original_buffer
+		{
+			text_file_view view;
+			const char* data{ nullptr };	//The bytes of text, the BOM is excluded.
+			size_type size{ 0 };
+			text_line_offsets offsets;		//The offsets of beginning of lines, and the end of bytes plus a unit.
+			bool is_unicode{ false };
+			nana::unicode encoding{ nana::unicode::utf8 };
+			unsigned unit{ 1 };				//Bytes of an encoding unit
+		}original_;
+
+		struct indexer_tag
+		{
+			std::thread thread;
+			bool active{ false };			//Indicates whether the thread is not joined.
+			std::atomic<bool> cancel{ false };
+			std::atomic<bool> done{ false };
+			std::atomic<size_type> longest{ 0 };	//The longest line that is indexed
+			size_type synced{ 0 };			//The number of indexed lines that are appended to the records
+
+			//The following members are only accessed by the indexing procedure
+			size_type last_offset{ 0 };
+			size_type longest_units{ 0 };
+			size_type pushed{ 0 };			//The number of offsets
+		};
+
+		mutable indexer_tag indexer_;
+
+		mutable text_line_index records_;
+		mutable std::deque<std::unique_ptr<string_type>> added_;
+		mutable std::vector<record_type> free_;	//The indexes of released strings of the add buffer
+	};
+}//end namespace skeletons
+}//end namespace widgets
+}//end namespace nana
+#include <nana/pop_ignore_diagnostic>
+
+#endif
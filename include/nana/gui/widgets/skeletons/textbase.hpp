@@ -19,10 +19,11 @@
 #include <nana/basic_types.hpp>
 #include <nana/traits.hpp>
 #include "textbase_export_interface.hpp"
+#include "text_piece_table.hpp"
 
 #include <deque>
-#include <memory>
 #include <fstream>
+#include <iterator>
 #include <stdexcept>
 
 namespace nana
@@ -31,7 +32,10 @@ namespace widgets
 {
 namespace skeletons
 {
-	template<typename CharT>
+	/// The Storage is the container of lines, it should provide the following members:
+	/// assign(bytes, is_unicode, encoding), clear(), size(), at(pos), modify(pos), peek(pos, buf),
+	/// measure(pos), insert(pos, str) and erase(pos, n). See text_piece_table for the details.
+	template<typename CharT, typename Storage = text_piece_table<CharT>>
 	class textbase
 		: public ::nana::noncopyable
 	{
@@ -39,12 +43,12 @@ namespace skeletons
 		typedef CharT						char_type;
 		typedef std::basic_string<CharT>	string_type;
 		typedef typename string_type::size_type	size_type;
+		typedef Storage						storage_type;
 
 		textbase()
 		{
+			//The storage contains an empty string for the first line of empty text.
 			attr_max_.reset();
-			//Insert an empty string for the first line of empty text.
-			text_cont_.emplace_back(new string_type);
 		}
 
 		void set_event_agent(textbase_event_agent_interface * evt)
@@ -54,94 +58,54 @@ namespace skeletons
 
 		bool empty() const
 		{
-			return (text_cont_.empty() ||
-					((text_cont_.size() == 1) && (text_cont_.front()->empty())));
+			return (text_cont_.size() == 0 ||
+					((text_cont_.size() == 1) && (0 == text_cont_.measure(0))));
 		}
 
 		bool load(const char* file_utf8)
 		{
-			if (!file_utf8)
+			text_file_view view;
+			if (!view.open(file_utf8))
 				return false;
 
-			std::ifstream ifs(to_osmbstr(file_utf8));
-			if (!ifs)
-				return false;
-
-			ifs.seekg(0, std::ios::end);
-			std::size_t bytes = static_cast<std::size_t>(ifs.tellg());
-			ifs.seekg(0, std::ios::beg);
-
-			if(bytes >= 2)
+			if(view.size() >= 2)
 			{
-				int ch = ifs.get();
-				if(0xEF == ch && bytes >= 3)
+				auto const bom = reinterpret_cast<const unsigned char*>(view.data());
+				if (0xEF == bom[0])
 				{
 					//UTF8
-					ch = ifs.get();
-					if(0xBB == ch && 0xBF == ifs.get())
-					{
-						ifs.close();
-						return load(file_utf8, nana::unicode::utf8);
-					}
+					if (view.size() >= 3 && 0xBB == bom[1] && 0xBF == bom[2])
+						return _m_assign(file_utf8, std::move(view), nana::unicode::utf8);
 				}
-				else if(0xFF == ch)
+				else if (0xFF == bom[0])
 				{
-					if(0xFE == ifs.get())
+					if (0xFE == bom[1])
 					{
 						//UTF16,UTF32
-						if(bytes >= 4)
-						{
-							if(ifs.get() == 0 && ifs.get() == 0)
-							{
-								ifs.close();
-								return load(file_utf8, nana::unicode::utf32);
-							}
-						}
-						ifs.close();
-						return load(file_utf8, nana::unicode::utf16);
+						if (view.size() >= 4 && 0 == bom[2] && 0 == bom[3])
+							return _m_assign(file_utf8, std::move(view), nana::unicode::utf32);
+
+						return _m_assign(file_utf8, std::move(view), nana::unicode::utf16);
 					}
 				}
-				else if(0xFE == ch)
+				else if (0xFE == bom[0])
 				{
-					if(ifs.get() == 0xFF)
-					{
-						//UTF16(big-endian)
-						ifs.close();
-						return load(file_utf8, nana::unicode::utf16);
-					}
+					//UTF16(big-endian)
+					if (0xFF == bom[1])
+						return _m_assign(file_utf8, std::move(view), nana::unicode::utf16);
 				}
-				else if(0 == ch)
+				else if (0 == bom[0])
 				{
-					if(bytes >= 4 && ifs.get() == 0)
-					{
-						ch = ifs.get();
-						if(0xFE == ch && ifs.get() == 0xFF)
-						{
-							//UTF32(big_endian)
-							ifs.close();
-							return load(file_utf8, nana::unicode::utf32);
-						}
-					}
+					//UTF32(big_endian)
+					if (view.size() >= 4 && 0 == bom[1] && 0xFE == bom[2] && 0xFF == bom[3])
+						return _m_assign(file_utf8, std::move(view), nana::unicode::utf32);
 				}
 			}
 
-			ifs.clear();
-			ifs.seekg(0, std::ios::beg);
-
-			text_cont_.clear();		//Clear only if the file can be opened.
-			attr_max_.reset();
-
-			std::string str_mbs;
-			while(ifs.good())
-			{
-				std::getline(ifs, str_mbs);
-				text_cont_.emplace_back(new string_type(static_cast<string_type&&>(nana::charset{ str_mbs })));
-				if(text_cont_.back()->size() > attr_max_.size)
-				{
-					attr_max_.size = text_cont_.back()->size();
-					attr_max_.line = text_cont_.size() - 1;
-				}
-			}
+			//Clear only if the file can be opened.
+			text_cont_.assign(std::move(view), 0, false, nana::unicode::utf8);
+			attr_max_.pending = true;
+			journal_.reset();
 
 			_m_saved(file_utf8);
 			return true;
@@ -177,85 +141,27 @@ namespace skeletons
 
 		bool load(const char* file_utf8, nana::unicode encoding)
 		{
-			if (!file_utf8)
+			text_file_view view;
+			if (!view.open(file_utf8))
 				return false;
 
-			std::ifstream ifs(to_osmbstr(file_utf8));
-
-			if (!ifs)
-				return false;
-
-			std::string str;
-			bool big_endian = true;
-
-			if(ifs.good())
-			{
-				text_cont_.clear();		//Clear only if the file can be opened.
-				attr_max_.reset();
-
-				std::getline(ifs, str);
-
-				std::size_t len_of_BOM = 0;
-				switch(encoding)
-				{
-				case nana::unicode::utf8:
-					len_of_BOM = 3;	break;
-				case nana::unicode::utf16:
-					len_of_BOM = 2;	break;
-				case nana::unicode::utf32:
-					len_of_BOM = 4;	break;
-				default:
-					throw std::runtime_error("Specified a wrong UTF");
-				}
-
-				big_endian = (str[0] == 0x00 || str[0] == char(0xFE));
-				str.erase(0, len_of_BOM);
-				if(big_endian)
-				{
-					if(nana::unicode::utf16 == encoding)
-						byte_order_translate_2bytes(str);
-					else
-						byte_order_translate_4bytes(str);
-				}
-
-				text_cont_.emplace_back(new string_type(static_cast<string_type&&>(nana::charset{ str, encoding })));
-
-				attr_max_.size = text_cont_.back()->size();
-				attr_max_.line = 0;
-			}
-
-			while(ifs.good())
-			{
-				std::getline(ifs, str);
-
-				if(big_endian)
-				{
-					if(nana::unicode::utf16 == encoding)
-						byte_order_translate_2bytes(str);
-					else
-						byte_order_translate_4bytes(str);
-				}
-
-				text_cont_.emplace_back(new string_type(static_cast<string_type&&>(nana::charset{ str, encoding })));
-				if(text_cont_.back()->size() > attr_max_.size)
-				{
-					attr_max_.size = text_cont_.back()->size();
-					attr_max_.line = text_cont_.size() - 1;
-				}
-			}
-
-			_m_saved(file_utf8);
-			return true;
+			return _m_assign(file_utf8, std::move(view), encoding);
 		}
 
-		void store(std::string fs, bool is_unicode, ::nana::unicode encoding) const
+		void store(std::string fs, bool is_unicode, ::nana::unicode encoding)
 		{
+			//The lines which are not indexed yet would be missed. And the lines which are not accessed are read from the
+			//loaded file, they are copied into memory before the file is truncated if it is the file to be written.
+			_m_complete();
+			text_cont_.detach(fs.c_str());
+
 			std::ofstream ofs(to_osmbstr(fs), std::ios::binary);
 			if(ofs && text_cont_.size())
 			{
-				auto i = text_cont_.cbegin();
 				auto const count = text_cont_.size() - 1;
 
+				//The lines which are not accessed are decoded through the buffer, it avoids keeping all lines in the storage.
+				string_type buf;
 				std::string last_mbs;
 
 				if (is_unicode)
@@ -277,23 +183,23 @@ namespace skeletons
 
 					for (std::size_t pos = 0; pos < count; ++pos)
 					{
-						auto mbs = nana::charset(**(i++)).to_bytes(encoding);
+						auto mbs = nana::charset(text_cont_.peek(pos, buf)).to_bytes(encoding);
 						ofs.write(mbs.c_str(), static_cast<std::streamsize>(mbs.size()));
 						ofs.write("\r\n", 2);
 					}
 
-					last_mbs = nana::charset(*text_cont_.back()).to_bytes(encoding);
+					last_mbs = nana::charset(text_cont_.peek(count, buf)).to_bytes(encoding);
 				}
 				else
 				{
 					for (std::size_t pos = 0; pos < count; ++pos)
 					{
-						std::string mbs = nana::charset(**(i++));
+						std::string mbs = nana::charset(text_cont_.peek(pos, buf));
 						ofs.write(mbs.c_str(), mbs.size());
 						ofs.write("\r\n", 2);
 					}
 
-					last_mbs = nana::charset(*text_cont_.back());
+					last_mbs = nana::charset(text_cont_.peek(count, buf));
 				}
 
 				ofs.write(last_mbs.c_str(), static_cast<std::streamsize>(last_mbs.size()));
@@ -309,45 +215,125 @@ namespace skeletons
 		const string_type& getline(size_type pos) const
 		{
 			if (pos < text_cont_.size())
-				return *text_cont_[pos];
+				return text_cont_.at(pos);
 
 			return nullstr_;
 		}
 
+		/// Returns the longest line and its length.
+		/// The length of a line which is not accessed yet is measured in its encoding units before the line is decoded.
 		std::pair<size_t, size_t> max_line() const
 		{
-			return std::make_pair(attr_max_.line, attr_max_.size);
+			if (attr_max_.pending)
+			{
+				//The longest line is provided by the storage until the loaded text is modified.
+				attr_max_.line = text_cont_.longest();
+				attr_max_.size = text_cont_.measure(attr_max_.line);
+				attr_max_.pending = text_cont_.indexing();
+			}
+			return std::make_pair(attr_max_.line, getline(attr_max_.line).size());
+		}
+
+		/// Determines whether the lines of the loaded file are being indexed.
+		/// The lines are appended while they are indexed, and a modification waits for the end of indexing.
+		bool indexing() const
+		{
+			return text_cont_.indexing();
+		}
+
+		/// Waits for the end of indexing. After that, the lines can be read by peek() from multiple threads until the text is modified.
+		void complete()
+		{
+			_m_complete();
+		}
+
+		/// Returns a line without keeping the decoded line, the buf is used for the decoding.
+		const string_type& peek(size_type pos, string_type& buf) const
+		{
+			return text_cont_.peek(pos, buf);
+		}
+
+		/// Returns the version of the text, it is increased by every modification.
+		std::size_t version() const
+		{
+			return journal_.version;
+		}
+
+		/// Replays the changes of lines made after a specified version.
+		/// The fn is invoked as fn(first, removed, inserted) for each change in order, it means the lines [first, first + removed)
+		/// are replaced by the lines [first, first + inserted). Returns false if the changes are no longer recorded, then
+		/// all the lines should be considered changed.
+		template<typename Function>
+		bool changes_since(std::size_t ver, Function fn) const
+		{
+			if (ver > journal_.version || journal_.version - ver > journal_.changes.size())
+				return false;
+
+			for (auto i = journal_.changes.end() - (journal_.version - ver); i != journal_.changes.end(); ++i)
+				fn(i->first, i->removed, i->inserted);
+
+			return true;
 		}
 	public:
 		void replace(size_type pos, string_type && text)
 		{
+			_m_complete();
+
 			if (text_cont_.size() <= pos)
 			{
-				text_cont_.emplace_back(new string_type(std::move(text)));
-				pos = text_cont_.size() - 1;
+				pos = text_cont_.size();
+				text_cont_.insert(pos, std::move(text));
+				_m_changed(pos, 0, 1);
 			}
 			else
-				_m_at(pos).swap(text);
+			{
+				text_cont_.modify(pos).swap(text);
+				_m_changed(pos, 1, 1);
+			}
 
 			_m_make_max(pos);
 			_m_edited();
 		}
 
+		/// Replaces the existing lines in a batch, every pair is the position of a line and its new text.
+		/// The text_changed is emitted once for all of them.
+		void replace(std::vector<std::pair<size_type, string_type>>&& lines)
+		{
+			if (lines.empty())
+				return;
+
+			_m_complete();
+
+			for (auto & ln : lines)
+			{
+				text_cont_.modify(ln.first).swap(ln.second);
+				_m_changed(ln.first, 1, 1);
+				_m_make_max(ln.first);
+			}
+
+			_m_edited();
+		}
+
 		void insert(upoint pos, string_type && str)
 		{
+			_m_complete();
+
 			if(pos.y < text_cont_.size())
 			{
-				string_type& lnstr = _m_at(pos.y);
+				string_type& lnstr = text_cont_.modify(pos.y);
 
 				if(pos.x < lnstr.size())
 					lnstr.insert(pos.x, str);
 				else
 					lnstr += str;
+
+				_m_changed(pos.y, 1, 1);
 			}
 			else
 			{
-				text_cont_.emplace_back(new string_type(std::move(str)));
-				pos.y = static_cast<unsigned>(text_cont_.size() - 1);
+				pos.y = static_cast<unsigned>(text_cont_.size());
+				text_cont_.insert(pos.y, std::move(str));
+				_m_changed(pos.y, 0, 1);
 			}
 
 			_m_make_max(pos.y);
@@ -356,25 +342,58 @@ namespace skeletons
 
 		void insertln(size_type pos, string_type&& str)
 		{
-			if (pos < text_cont_.size())
-				text_cont_.emplace(_m_iat(pos), new string_type(std::move(str)));
-			else
-				text_cont_.emplace_back(new string_type(std::move(str)));
+			_m_complete();
+
+			if (pos > text_cont_.size())
+				pos = text_cont_.size();
+
+			text_cont_.insert(pos, std::move(str));
+			_m_changed(pos, 0, 1);
 
 			_m_make_max(pos);
 			_m_edited();
 		}
 
+		/// Inserts the lines of a range at pos, they are recorded as one change of lines.
+		template<typename Iterator>
+		void insertln(size_type pos, Iterator first, Iterator last)
+		{
+			auto const count = static_cast<size_type>(std::distance(first, last));
+			if (0 == count)
+				return;
+
+			_m_complete();
+
+			if (pos > text_cont_.size())
+				pos = text_cont_.size();
+
+			if (attr_max_.size && (attr_max_.line >= pos))
+				attr_max_.line += count;
+
+			for (size_type i = 0; i < count; ++i, ++first)
+			{
+				text_cont_.insert(pos + i, string_type(*first));
+				_m_make_max(pos + i);
+			}
+
+			_m_changed(pos, 0, count);
+			_m_edited();
+		}
+
 		void erase(size_type line, size_type pos, size_type count)
 		{
+			_m_complete();
+
 			if (line < text_cont_.size())
 			{
-				string_type& lnstr = _m_at(line);
+				string_type& lnstr = text_cont_.modify(line);
 				if ((pos == 0) && (count >= lnstr.size()))
 					lnstr.clear();
 				else
 					lnstr.erase(pos, count);
 
+				_m_changed(line, 1, 1);
+
 				if (attr_max_.line == line)
 					_m_scan_for_max();
 
@@ -384,6 +403,8 @@ namespace skeletons
 
 		bool erase(size_type pos, std::size_t n)
 		{
+			_m_complete();
+
 			//Bounds checking
 			if ((pos >= text_cont_.size()) || (0 == n))
 				return false;
@@ -391,7 +412,8 @@ namespace skeletons
 			if (pos + n > text_cont_.size())
 				n = text_cont_.size() - pos;
 
-			text_cont_.erase(_m_iat(pos), _m_iat(pos + n));
+			text_cont_.erase(pos, n);
+			_m_changed(pos, n, 0);
 
 			if (pos <= attr_max_.line && attr_max_.line < pos + n)
 				_m_scan_for_max();
@@ -404,20 +426,22 @@ namespace skeletons
 
 		void erase_all()
 		{
-			text_cont_.clear();
+			text_cont_.clear();		//The storage leaves an empty line, text_cont_ must not be empty
 			attr_max_.reset();
-			text_cont_.emplace_back(new string_type);	//text_cont_ must not be empty
+			journal_.reset();
 
 			_m_saved(std::string());
 		}
 
 		void merge(size_type pos)
 		{
+			_m_complete();
+
 			if(pos + 1 < text_cont_.size())
 			{
-				auto i = _m_iat(pos + 1);
-				_m_at(pos) += **i;
-				text_cont_.erase(i);
+				text_cont_.modify(pos) += text_cont_.at(pos + 1);
+				text_cont_.erase(pos + 1, 1);
+				_m_changed(pos, 2, 1);
 				_m_make_max(pos);
 
 				//If the maxline is behind the pos line,
@@ -461,39 +485,78 @@ namespace skeletons
 			return edited() || filename_.empty();
 		}
 	private:
-		string_type& _m_at(size_type pos)
+		bool _m_assign(const char* file_utf8, text_file_view&& view, nana::unicode encoding)
 		{
-			return **_m_iat(pos);
+			std::size_t len_of_BOM = 0;
+			switch(encoding)
+			{
+			case nana::unicode::utf8:
+				len_of_BOM = 3;	break;
+			case nana::unicode::utf16:
+				len_of_BOM = 2;	break;
+			case nana::unicode::utf32:
+				len_of_BOM = 4;	break;
+			default:
+				throw std::runtime_error("Specified a wrong UTF");
+			}
+
+			len_of_BOM = (std::min)(len_of_BOM, view.size());
+
+			bool const big_endian = (nana::unicode::utf8 != encoding) && view.size() && (view.data()[0] == 0x00 || view.data()[0] == char(0xFE));
+			if(big_endian)
+			{
+				//The big-endian text is translated into little-endian in a buffer, it is not viewed directly.
+				std::string bytes(view.data() + len_of_BOM, view.size() - len_of_BOM);
+				if(nana::unicode::utf16 == encoding)
+					byte_order_translate_2bytes(bytes);
+				else
+					byte_order_translate_4bytes(bytes);
+
+				view.assign(std::move(bytes));
+				len_of_BOM = 0;
+			}
+
+			//Clear only if the file can be opened.
+			text_cont_.assign(std::move(view), len_of_BOM, true, encoding);
+			attr_max_.pending = true;
+			journal_.reset();
+
+			_m_saved(file_utf8);
+			return true;
 		}
 
-		typename std::deque<std::unique_ptr<string_type>>::iterator _m_iat(size_type pos)
+		//Waits for the end of indexing before a modification, and resolves the longest line of the loaded text.
+		void _m_complete()
 		{
-			return text_cont_.begin() + pos;
+			text_cont_.complete();
+			if (attr_max_.pending)
+				max_line();
 		}
 
 		void _m_make_max(std::size_t pos)
 		{
-			const string_type& str = _m_at(pos);
-			if(str.size() > attr_max_.size)
+			auto const size = text_cont_.measure(pos);
+			if(size > attr_max_.size)
 			{
-				attr_max_.size = str.size();
+				attr_max_.size = size;
 				attr_max_.line = pos;
 			}
 		}
 
 		void _m_scan_for_max()
 		{
-			attr_max_.size = 0;
-			std::size_t n = 0;
-			for(auto & p : text_cont_)
-			{
-				if(p->size() > attr_max_.size)
-				{
-					attr_max_.size = p->size();
-					attr_max_.line = n;
-				}
-				++n;
-			}
+			attr_max_.reset();
+			for(std::size_t n = 0; n < text_cont_.size(); ++n)
+				_m_make_max(n);
+		}
+
+		void _m_changed(size_type first, size_type removed, size_type inserted)
+		{
+			if (journal_.changes.size() == journal_.max_changes)
+				journal_.changes.pop_front();
+
+			journal_.changes.push_back({ first, removed, inserted });
+			++journal_.version;
 		}
 
 		void _m_first_change() const
@@ -527,7 +590,7 @@ namespace skeletons
 				evt_agent_->text_changed();
 		}
 	private:
-		std::deque<std::unique_ptr<string_type>>	text_cont_;
+		storage_type	text_cont_;
 		textbase_event_agent_interface* evt_agent_{ nullptr };
 
 		mutable bool			changed_{ false };
@@ -538,13 +601,39 @@ namespace skeletons
 		{
 			std::size_t line;
 			std::size_t size;
+			bool pending;	//true if the longest line is not scanned since loading.
 
 			void reset()
 			{
 				line = 0;
 				size = 0;
+				pending = false;
+			}
+		};
+
+		mutable attr_max attr_max_;
+
+		//The recent changes of lines, they are replayed by changes_since() for the states which are kept per line.
+		struct journal_rep
+		{
+			struct change
+			{
+				size_type first;
+				size_type removed;
+				size_type inserted;
+			};
+
+			static const std::size_t max_changes = 64;
+
+			std::size_t version{ 0 };
+			std::deque<change> changes;
+
+			void reset()
+			{
+				++version;
+				changes.clear();
 			}
-		}attr_max_;
+		}journal_;
 	};
 
 }//end namespace detail
@@ -16,6 +16,7 @@
 #include <nana/gui/widgets/widget.hpp>
 #include "skeletons/textbase_export_interface.hpp"
 #include "skeletons/text_editor_part.hpp"
+#include "skeletons/text_lexer.hpp"
 
 namespace nana
 {
@@ -70,6 +71,9 @@ namespace nana
 				drawer();
 				text_editor * editor();
 				const text_editor * editor() const;
+
+				/// Returns the queue of the streamed lines, it is kept after the editor is destroyed. It can be invoked from any thread.
+				const std::shared_ptr<widgets::skeletons::line_stream>& stream_queue() const;
 			private:
 				void attached(widget_reference, graph_reference)	override;
 				void detached()	override;
@@ -90,6 +94,7 @@ namespace nana
 			private:
 				widget*	widget_;
 				widgets::skeletons::text_editor * editor_;
+				std::shared_ptr<widgets::skeletons::line_stream> stream_;
 				std::unique_ptr<event_agent>	evt_agent_;
 			};
 		}//end namespace textbox
@@ -105,6 +110,8 @@ namespace nana
 
 		using text_focus_behavior = widgets::skeletons::text_focus_behavior;
 		using text_positions = std::vector<upoint>;
+		using search_options = widgets::skeletons::text_search_options;
+		using text_range = widgets::skeletons::text_range;
 
 		/// The default constructor without creating the widget.
 		textbox();
@@ -133,6 +140,11 @@ namespace nana
 		textbox(window, const rectangle& = rectangle(), bool visible = true);
 
         ///  \brief Loads a text file. When attempt to load a unicode encoded text file, be sure the file have a BOM header.
+        ///  The file is mapped into memory and a line is decoded when it is displayed. The lines of a large file are indexed in background,
+        ///  they are appended while the textbox is displaying, and an edit waits for the end of indexing.
+        ///  A large file which is not being written is mapped, it must not be truncated by other processes until the textbox is closed
+        ///  or another file is loaded, otherwise the process may be terminated by SIGBUS on POSIX. Small files and files opened for
+        ///  writing, such as logs, are read into memory.
 		void load(std::string file);
 		void store(std::string file);
 		void store(std::string file, nana::unicode encoding);
@@ -180,6 +192,18 @@ namespace nana
         /// Appends an string. If `at_caret` is `true`, the string is inserted at the position of caret, otherwise, it is appended at end of the textbox.
 		textbox& append(const std::string& text, bool at_caret);
 
+		/// Enables the lines pushed by push_line() to be appended, they are appended in a batch once per frame.
+		/**
+		 * The view follows the appended lines if it shows the end of the text.
+		 * @param enable Determines whether to append the pushed lines.
+		 * @param max_lines The maximum number of lines that are kept. The oldest lines are discarded when it is exceeded, 0 means unlimited.
+		 */
+		textbox& stream_lines(bool enable, std::size_t max_lines = 0);
+
+		/// Pushes a text to be appended as new lines, a trailing new line doesn't make an empty line. It can be called from any thread without locking the GUI.
+		/// @return false if stream_lines() is not enabled, the text is ignored.
+		bool push_line(const std::string& text_utf8);
+
 		/// Determines whether the text is line wrapped.
 		bool line_wrapped() const;
 		textbox& line_wrapped(bool);
@@ -232,6 +256,31 @@ namespace nana
 		void set_keywords(const std::string& name, bool case_sensitive, bool whole_word_match, std::initializer_list<std::string> kw_list_utf8);
 		void erase_keyword(const std::string& kw);
 
+		/// Sets a lexer for syntax highlighting, nullptr removes the lexer.
+		/**
+		 * The lines are tokenized by the lexer in a worker thread and they are highlighted as the tokenizing
+		 * proceeds, the spans of lexer are drawn with the schemes which are set by set_highlight(). The keywords
+		 * are not highlighted while a lexer is set.
+		 */
+		void set_lexer(std::shared_ptr<widgets::skeletons::text_lexer_interface>);
+
+		/// Searches the whole text for a pattern.
+		/**
+		 * The lines are searched by multiple threads in batches, and the fn is invoked by the calling thread with the
+		 * matches of each batch in the order of lines. The search is stopped if fn returns false.
+		 * @return The number of matches which are passed to fn.
+		 * @exception std::regex_error if the pattern is an invalid regular expression.
+		 */
+		std::size_t find_all(const std::string& pattern_utf8, const search_options&, std::function<bool(const std::vector<text_range>&)> fn);
+
+		/// Replaces all the matches of a pattern, the replacement may refer to the submatches of a regular expression, such as $1.
+		/// A replacement doesn't break a line, the replacement is cut at its first CR or LF.
+		/// @return The number of replaced matches. The replacing is undone as one step, and text_changed is emitted once.
+		std::size_t replace_all(const std::string& pattern_utf8, const std::string& replacement_utf8, const search_options&);
+
+		/// Highlights the matches of a pattern with a scheme which is set by set_highlight(), an empty pattern removes the highlight.
+		void highlight_matches(const std::string& pattern_utf8, const search_options&, const std::string& scheme);
+
 		/// Sets the text alignment
 		textbox& text_align(::nana::align alignment);
 
@@ -258,6 +307,13 @@ namespace nana
 		 */
 		void set_undo_queue_length(std::size_t len);
 
+		/// Sets the maximum bytes of the text which is kept for undo/redo
+		/**
+		 * The oldest steps are dropped when the text of the steps exceeds the limit, the latest step is always kept.
+		 * @param bytes The maximum bytes. If this parameter is zero, the memory is unlimited.
+		 */
+		void set_undo_memory_limit(std::size_t bytes);
+
 		/// Returns the number of lines that text are displayed in the screen.
 		/**
 		 * The number of display lines may be not equal to the number of text lines when the textbox
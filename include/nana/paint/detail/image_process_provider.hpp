@@ -4,6 +4,8 @@
 #include <nana/paint/image_process_interface.hpp>
 #include <string>
 #include <map>
+#include <atomic>
+#include <functional>
 
 namespace nana
 {
@@ -65,6 +67,12 @@ namespace nana
 					table_t	table;
 					interface_t * employee;				
 				}blur_;
+
+				struct concurrency_tag
+				{
+					std::atomic<std::size_t> max_threads{ 0 };		//0 for the number of hardware threads
+					std::atomic<std::size_t> threshold{ 0x40000 };	//The minimum number of pixels which are processed by multiple threads
+				}concurrency_;
 			public:
 
 				static image_process_provider & instance();
@@ -88,6 +96,17 @@ namespace nana
 				blur_tag & ref_blur_tag();
 				paint::image_process::blur_interface * const * blur() const;
 				paint::image_process::blur_interface * ref_blur(const std::string& name) const;
+
+				void concurrency(std::size_t max_threads);
+				void concurrency_threshold(std::size_t pixels);
+
+				//parallel_bands
+				//@brief: Splits the lines into bands and calls fn(begin, end) for each band. The bands are processed by the
+				//		calling thread and the threads of a shared pool if the number of pixels reaches the threshold,
+				//		otherwise fn(0, lines) is called once. The fn should only write the pixels of its own band, so that
+				//		the result is not determined by the number of threads. The first exception thrown by fn is rethrown
+				//		by the calling thread after all the bands are finished, the bands which are not started are skipped.
+				void parallel_bands(std::size_t lines, std::size_t pixels_per_line, const std::function<void(std::size_t begin, std::size_t end)>& fn);
 			public:
 				template<typename Tag>
 				void set(Tag & tag, const std::string& name)
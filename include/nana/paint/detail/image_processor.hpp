@@ -18,6 +18,7 @@
 #include "../image_process_interface.hpp"
 #include <nana/paint/pixel_buffer.hpp>
 #include <nana/paint/detail/native_paint_interface.hpp>
+#include <nana/paint/detail/image_process_provider.hpp>
 #include <algorithm>
 
 namespace nana
@@ -52,45 +53,50 @@ namespace detail
 
 				pixel_argb_t * s_raw_pixbuf = s_pixbuf.raw_ptr(0);
 
-				if(s_pixbuf.alpha_channel())
+				const bool is_alpha_channel = s_pixbuf.alpha_channel();
+
+				image_process_provider::instance().parallel_bands(r_dst.height, r_dst.width, [&](std::size_t begin, std::size_t end)
 				{
-					for(std::size_t row = 0; row < r_dst.height; ++row)
+					if(is_alpha_channel)
 					{
-						const pixel_argb_t * s_line = pixel_at(s_raw_pixbuf, (static_cast<int>(row * rate_y) + r_src.y) * bytes_per_line);
-						pixel_argb_t * i = pixbuf.raw_ptr(r_dst.y + row);
-
-						for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
+						for(std::size_t row = begin; row < end; ++row)
 						{
-							const pixel_argb_t * s = s_line + static_cast<int>(x * rate_x) + r_src.x;
-							if(0 == s->element.alpha_channel)
-								continue;
-							
-							if(s->element.alpha_channel != 255)
-							{
-								i->element.red = unsigned(i->element.red * (255 - s->element.alpha_channel) + s->element.red * s->element.alpha_channel) / 255;
-								i->element.green = unsigned(i->element.green * (255 - s->element.alpha_channel) + s->element.green * s->element.alpha_channel) / 255;
-								i->element.blue = unsigned(i->element.blue * (255 - s->element.alpha_channel) + s->element.blue * s->element.alpha_channel) / 255;
-							}
-							else
+							const pixel_argb_t * s_line = pixel_at(s_raw_pixbuf, (static_cast<int>(row * rate_y) + r_src.y) * bytes_per_line);
+							pixel_argb_t * i = pixbuf.raw_ptr(r_dst.y + row);
+
+							for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
 							{
-								unsigned alpha_chn = i->element.alpha_channel;
-								*i = *s;
-								i->element.alpha_channel = alpha_chn;
+								const pixel_argb_t * s = s_line + static_cast<int>(x * rate_x) + r_src.x;
+								if(0 == s->element.alpha_channel)
+									continue;
+								
+								if(s->element.alpha_channel != 255)
+								{
+									i->element.red = unsigned(i->element.red * (255 - s->element.alpha_channel) + s->element.red * s->element.alpha_channel) / 255;
+									i->element.green = unsigned(i->element.green * (255 - s->element.alpha_channel) + s->element.green * s->element.alpha_channel) / 255;
+									i->element.blue = unsigned(i->element.blue * (255 - s->element.alpha_channel) + s->element.blue * s->element.alpha_channel) / 255;
+								}
+								else
+								{
+									unsigned alpha_chn = i->element.alpha_channel;
+									*i = *s;
+									i->element.alpha_channel = alpha_chn;
+								}
 							}
-						}
-					}				
-				}
-				else
-				{
-					for(std::size_t row = 0; row < r_dst.height; ++row)
+						}				
+					}
+					else
 					{
-						const pixel_argb_t * s_line = pixel_at(s_raw_pixbuf, (static_cast<int>(row * rate_y) + r_src.y) * bytes_per_line);
-						pixel_argb_t * i = pixbuf.raw_ptr(r_dst.y + row);
+						for(std::size_t row = begin; row < end; ++row)
+						{
+							const pixel_argb_t * s_line = pixel_at(s_raw_pixbuf, (static_cast<int>(row * rate_y) + r_src.y) * bytes_per_line);
+							pixel_argb_t * i = pixbuf.raw_ptr(r_dst.y + row);
 
-						for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
-							*i = s_line[static_cast<int>(x * rate_x) + r_src.x];
+							for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
+								*i = s_line[static_cast<int>(x * rate_x) + r_src.x];
+						}
 					}
-				}
+				});
 			}
 		};
 
@@ -145,112 +151,115 @@ namespace detail
 
 				const bool is_alpha_channel = s_pixbuf.alpha_channel();
 				
-				for(std::size_t row = 0; row < r_dst.height; ++row)
+				image_process_provider::instance().parallel_bands(r_dst.height, r_dst.width, [&](std::size_t begin, std::size_t end)
 				{
-					double v = (int(row) + 0.5) * rate_y - 0.5;
-					int sy = r_src.y;
-					if(v < 0)
-					{
-						v = 0;
-					}
-					else
+					for(std::size_t row = begin; row < end; ++row)
 					{
-						int ipart = static_cast<int>(v);
-						sy += ipart;
-						v -= ipart;
-					}
+						double v = (int(row) + 0.5) * rate_y - 0.5;
+						int sy = r_src.y;
+						if(v < 0)
+						{
+							v = 0;
+						}
+						else
+						{
+							int ipart = static_cast<int>(v);
+							sy += ipart;
+							v -= ipart;
+						}
 
-					std::size_t iv = static_cast<size_t>(v * coef);
-					const std::size_t iv_minus_coef = coef - iv;
+						std::size_t iv = static_cast<size_t>(v * coef);
+						const std::size_t iv_minus_coef = coef - iv;
 
-					const nana::pixel_argb_t * s_line = pixel_at(s_raw_pixel_buffer,  sy * s_bytes_per_line);
-					const nana::pixel_argb_t * next_s_line = pixel_at(s_line, (sy < bottom ? s_bytes_per_line : 0));
+						const nana::pixel_argb_t * s_line = pixel_at(s_raw_pixel_buffer,  sy * s_bytes_per_line);
+						const nana::pixel_argb_t * next_s_line = pixel_at(s_line, (sy < bottom ? s_bytes_per_line : 0));
 
-					nana::pixel_argb_t col0;
-					nana::pixel_argb_t col1;
-					nana::pixel_argb_t col2;
-					nana::pixel_argb_t col3;
-					
-					pixel_argb_t * i = pixbuf.raw_ptr(row + r_dst.y) + r_dst.x;
-					
-					if(is_alpha_channel)
-					{
-						for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
-						{
-							x_u_table_tag el = x_u_table[x];
+						nana::pixel_argb_t col0;
+						nana::pixel_argb_t col1;
+						nana::pixel_argb_t col2;
+						nana::pixel_argb_t col3;
 						
-							col0 = s_line[el.x];
-							col1 = next_s_line[el.x];
-
-							if(el.x < right_bound)
-							{
-								col2 = s_line[el.x + 1];
-								col3 = next_s_line[el.x + 1];
-							}
-							else
-							{
-								col2 = col0;
-								col3 = col1;
-							}
+						pixel_argb_t * i = pixbuf.raw_ptr(row + r_dst.y) + r_dst.x;
 						
-							std::size_t coef0 = el.iu_minus_coef * iv_minus_coef;
-							std::size_t coef1 = el.iu_minus_coef * iv;
-							std::size_t coef2 = el.iu * iv_minus_coef;
-							std::size_t coef3 = el.iu * iv;			
-
-							unsigned alpha_chn = static_cast<unsigned>((coef0 * col0.element.alpha_channel + coef1 * col1.element.alpha_channel + (coef2 * col2.element.alpha_channel + coef3 * col3.element.alpha_channel)) >> double_shift_size);
-							unsigned s_red = static_cast<unsigned>((coef0 * col0.element.red + coef1 * col1.element.red + (coef2 * col2.element.red + coef3 * col3.element.red)) >> double_shift_size);
-							unsigned s_green = static_cast<unsigned>((coef0 * col0.element.green + coef1 * col1.element.green + (coef2 * col2.element.green + coef3 * col3.element.green)) >> double_shift_size);
-							unsigned s_blue = static_cast<unsigned>((coef0 * col0.element.blue + coef1 * col1.element.blue + (coef2 * col2.element.blue + coef3 * col3.element.blue)) >> double_shift_size);
-
-							if(alpha_chn)
+						if(is_alpha_channel)
+						{
+							for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
 							{
-								if(alpha_chn != 255)
+								x_u_table_tag el = x_u_table[x];
+							
+								col0 = s_line[el.x];
+								col1 = next_s_line[el.x];
+
+								if(el.x < right_bound)
 								{
-									i->element.red	= unsigned(i->element.red * (255 - alpha_chn) + s_red * alpha_chn) / 255;
-									i->element.green	= unsigned(i->element.green * (255 - alpha_chn) + s_green * alpha_chn) / 255;
-									i->element.blue	= unsigned(i->element.blue * (255 - alpha_chn) + s_blue * alpha_chn) / 255;
+									col2 = s_line[el.x + 1];
+									col3 = next_s_line[el.x + 1];
 								}
 								else
 								{
-									i->element.red = s_red;
-									i->element.green = s_green;
-									i->element.blue = s_blue;
+									col2 = col0;
+									col3 = col1;
 								}
-							}
-						}						
-					}
-					else
-					{
-						for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
-						{
-							x_u_table_tag el = x_u_table[x];
-						
-							col0 = s_line[el.x];
-							col1 = next_s_line[el.x];
+							
+								std::size_t coef0 = el.iu_minus_coef * iv_minus_coef;
+								std::size_t coef1 = el.iu_minus_coef * iv;
+								std::size_t coef2 = el.iu * iv_minus_coef;
+								std::size_t coef3 = el.iu * iv;			
 
-							if(el.x < right_bound)
-							{
-								col2 = s_line[el.x + 1];
-								col3 = next_s_line[el.x + 1];
-							}
-							else
+								unsigned alpha_chn = static_cast<unsigned>((coef0 * col0.element.alpha_channel + coef1 * col1.element.alpha_channel + (coef2 * col2.element.alpha_channel + coef3 * col3.element.alpha_channel)) >> double_shift_size);
+								unsigned s_red = static_cast<unsigned>((coef0 * col0.element.red + coef1 * col1.element.red + (coef2 * col2.element.red + coef3 * col3.element.red)) >> double_shift_size);
+								unsigned s_green = static_cast<unsigned>((coef0 * col0.element.green + coef1 * col1.element.green + (coef2 * col2.element.green + coef3 * col3.element.green)) >> double_shift_size);
+								unsigned s_blue = static_cast<unsigned>((coef0 * col0.element.blue + coef1 * col1.element.blue + (coef2 * col2.element.blue + coef3 * col3.element.blue)) >> double_shift_size);
+
+								if(alpha_chn)
+								{
+									if(alpha_chn != 255)
+									{
+										i->element.red	= unsigned(i->element.red * (255 - alpha_chn) + s_red * alpha_chn) / 255;
+										i->element.green	= unsigned(i->element.green * (255 - alpha_chn) + s_green * alpha_chn) / 255;
+										i->element.blue	= unsigned(i->element.blue * (255 - alpha_chn) + s_blue * alpha_chn) / 255;
+									}
+									else
+									{
+										i->element.red = s_red;
+										i->element.green = s_green;
+										i->element.blue = s_blue;
+									}
+								}
+							}						
+						}
+						else
+						{
+							for(std::size_t x = 0; x < r_dst.width; ++x, ++i)
 							{
-								col2 = col0;
-								col3 = col1;
+								x_u_table_tag el = x_u_table[x];
+							
+								col0 = s_line[el.x];
+								col1 = next_s_line[el.x];
+
+								if(el.x < right_bound)
+								{
+									col2 = s_line[el.x + 1];
+									col3 = next_s_line[el.x + 1];
+								}
+								else
+								{
+									col2 = col0;
+									col3 = col1;
+								}
+							
+								std::size_t coef0 = el.iu_minus_coef * iv_minus_coef;
+								std::size_t coef1 = el.iu_minus_coef * iv;
+								std::size_t coef2 = el.iu * iv_minus_coef;
+								std::size_t coef3 = el.iu * iv;			
+
+								i->element.red = static_cast<unsigned char>((coef0 * col0.element.red + coef1 * col1.element.red + (coef2 * col2.element.red + coef3 * col3.element.red)) >> double_shift_size);
+								i->element.green = static_cast<unsigned char>((coef0 * col0.element.green + coef1 * col1.element.green + (coef2 * col2.element.green + coef3 * col3.element.green)) >> double_shift_size);
+								i->element.blue = static_cast<unsigned char>((coef0 * col0.element.blue + coef1 * col1.element.blue + (coef2 * col2.element.blue + coef3 * col3.element.blue)) >> double_shift_size);
 							}
-						
-							std::size_t coef0 = el.iu_minus_coef * iv_minus_coef;
-							std::size_t coef1 = el.iu_minus_coef * iv;
-							std::size_t coef2 = el.iu * iv_minus_coef;
-							std::size_t coef3 = el.iu * iv;			
-
-							i->element.red = static_cast<unsigned char>((coef0 * col0.element.red + coef1 * col1.element.red + (coef2 * col2.element.red + coef3 * col3.element.red)) >> double_shift_size);
-							i->element.green = static_cast<unsigned char>((coef0 * col0.element.green + coef1 * col1.element.green + (coef2 * col2.element.green + coef3 * col3.element.green)) >> double_shift_size);
-							i->element.blue = static_cast<unsigned char>((coef0 * col0.element.blue + coef1 * col1.element.blue + (coef2 * col2.element.blue + coef3 * col3.element.blue)) >> double_shift_size);
 						}
 					}
-				}
+				});
 				delete [] x_u_table;
 			}
 		};
@@ -262,93 +271,98 @@ namespace detail
 			//process
 			virtual void process(const paint::pixel_buffer& s_pixbuf, const nana::rectangle& s_r, paint::pixel_buffer& d_pixbuf, const nana::point& d_pos) const
 			{
-				auto d_rgb = d_pixbuf.at(d_pos);
-				auto s_rgb = s_pixbuf.raw_ptr(s_r.y) + s_r.x;
-				if(d_rgb && s_rgb)
+				auto d_px = d_pixbuf.at(d_pos);
+				auto s_px = s_pixbuf.raw_ptr(s_r.y) + s_r.x;
+				if(d_px && s_px)
 				{
 					const unsigned rest = s_r.width & 0x3;
 					const unsigned length_align4 = s_r.width - rest;
 
 					std::size_t d_step_bytes = d_pixbuf.bytes_per_line() - (s_r.width - rest) * sizeof(pixel_argb_t);
 					std::size_t s_step_bytes = s_pixbuf.bytes_per_line() - (s_r.width - rest) * sizeof(pixel_argb_t);
-					for(unsigned line = 0; line < s_r.height; ++line)
+					image_process_provider::instance().parallel_bands(s_r.height, s_r.width, [&](std::size_t first_line, std::size_t last_line)
 					{
-						const auto end = d_rgb + length_align4;
-						for(; d_rgb < end; d_rgb += 4, s_rgb += 4)
+						auto d_rgb = pixel_at(d_px, first_line * d_pixbuf.bytes_per_line());
+						auto s_rgb = pixel_at(s_px, first_line * s_pixbuf.bytes_per_line());
+						for(auto line = first_line; line < last_line; ++line)
 						{
-							//0
-							if(s_rgb->element.alpha_channel)
+							const auto end = d_rgb + length_align4;
+							for(; d_rgb < end; d_rgb += 4, s_rgb += 4)
 							{
-								if(s_rgb->element.alpha_channel != 255)
+								//0
+								if(s_rgb->element.alpha_channel)
 								{
-									d_rgb->element.red = unsigned(d_rgb->element.red * (255 - s_rgb[0].element.alpha_channel) + s_rgb[0].element.red * s_rgb[0].element.alpha_channel) / 255;
-									d_rgb->element.green = unsigned(d_rgb->element.green * (255 - s_rgb[0].element.alpha_channel) + s_rgb[0].element.green * s_rgb[0].element.alpha_channel) / 255;
-									d_rgb->element.blue = unsigned(d_rgb->element.blue * (255 - s_rgb[0].element.alpha_channel) + s_rgb[0].element.blue * s_rgb[0].element.alpha_channel) / 255;
+									if(s_rgb->element.alpha_channel != 255)
+									{
+										d_rgb->element.red = unsigned(d_rgb->element.red * (255 - s_rgb[0].element.alpha_channel) + s_rgb[0].element.red * s_rgb[0].element.alpha_channel) / 255;
+										d_rgb->element.green = unsigned(d_rgb->element.green * (255 - s_rgb[0].element.alpha_channel) + s_rgb[0].element.green * s_rgb[0].element.alpha_channel) / 255;
+										d_rgb->element.blue = unsigned(d_rgb->element.blue * (255 - s_rgb[0].element.alpha_channel) + s_rgb[0].element.blue * s_rgb[0].element.alpha_channel) / 255;
+									}
+									else
+										*d_rgb = *s_rgb;
 								}
-								else
-									*d_rgb = *s_rgb;
-							}
 
-							//1
-							if(s_rgb[1].element.alpha_channel)
-							{
-								if(s_rgb[1].element.alpha_channel != 255)
+								//1
+								if(s_rgb[1].element.alpha_channel)
 								{
-									d_rgb[1].element.red = unsigned(d_rgb[1].element.red * (255 - s_rgb[1].element.alpha_channel) + s_rgb[1].element.red * s_rgb[1].element.alpha_channel) / 255;
-									d_rgb[1].element.green = unsigned(d_rgb[1].element.green * (255 - s_rgb[1].element.alpha_channel) + s_rgb[1].element.green * s_rgb[1].element.alpha_channel) / 255;
-									d_rgb[1].element.blue = unsigned(d_rgb[1].element.blue * (255 - s_rgb[1].element.alpha_channel) + s_rgb[1].element.blue * s_rgb[1].element.alpha_channel) / 255;
+									if(s_rgb[1].element.alpha_channel != 255)
+									{
+										d_rgb[1].element.red = unsigned(d_rgb[1].element.red * (255 - s_rgb[1].element.alpha_channel) + s_rgb[1].element.red * s_rgb[1].element.alpha_channel) / 255;
+										d_rgb[1].element.green = unsigned(d_rgb[1].element.green * (255 - s_rgb[1].element.alpha_channel) + s_rgb[1].element.green * s_rgb[1].element.alpha_channel) / 255;
+										d_rgb[1].element.blue = unsigned(d_rgb[1].element.blue * (255 - s_rgb[1].element.alpha_channel) + s_rgb[1].element.blue * s_rgb[1].element.alpha_channel) / 255;
+									}
+									else
+										d_rgb[1] = s_rgb[1];
 								}
-								else
-									d_rgb[1] = s_rgb[1];
-							}
 
-							//2
-							if(s_rgb[2].element.alpha_channel)
-							{
-								if(s_rgb[2].element.alpha_channel != 255)
+								//2
+								if(s_rgb[2].element.alpha_channel)
 								{
-									d_rgb[2].element.red = unsigned(d_rgb[2].element.red * (255 - s_rgb[2].element.alpha_channel) + s_rgb[2].element.red * s_rgb[2].element.alpha_channel) / 255;
-									d_rgb[2].element.green = unsigned(d_rgb[2].element.green * (255 - s_rgb[2].element.alpha_channel) + s_rgb[2].element.green * s_rgb[2].element.alpha_channel) / 255;
-									d_rgb[2].element.blue = unsigned(d_rgb[2].element.blue * (255 - s_rgb[2].element.alpha_channel) + s_rgb[2].element.blue * s_rgb[2].element.alpha_channel) / 255;
+									if(s_rgb[2].element.alpha_channel != 255)
+									{
+										d_rgb[2].element.red = unsigned(d_rgb[2].element.red * (255 - s_rgb[2].element.alpha_channel) + s_rgb[2].element.red * s_rgb[2].element.alpha_channel) / 255;
+										d_rgb[2].element.green = unsigned(d_rgb[2].element.green * (255 - s_rgb[2].element.alpha_channel) + s_rgb[2].element.green * s_rgb[2].element.alpha_channel) / 255;
+										d_rgb[2].element.blue = unsigned(d_rgb[2].element.blue * (255 - s_rgb[2].element.alpha_channel) + s_rgb[2].element.blue * s_rgb[2].element.alpha_channel) / 255;
+									}
+									else
+										d_rgb[2] = s_rgb[2];
 								}
-								else
-									d_rgb[2] = s_rgb[2];
-							}
 
-							//3
-							if(s_rgb[3].element.alpha_channel)
-							{
-								if(s_rgb[3].element.alpha_channel != 255)
+								//3
+								if(s_rgb[3].element.alpha_channel)
 								{
-									d_rgb[3].element.red = unsigned(d_rgb[3].element.red * (255 - s_rgb[3].element.alpha_channel) + s_rgb[3].element.red * s_rgb[3].element.alpha_channel) / 255;
-									d_rgb[3].element.green = unsigned(d_rgb[3].element.green * (255 - s_rgb[3].element.alpha_channel) + s_rgb[3].element.green * s_rgb[3].element.alpha_channel) / 255;
-									d_rgb[3].element.blue = unsigned(d_rgb[3].element.blue * (255 - s_rgb[3].element.alpha_channel) + s_rgb[3].element.blue * s_rgb[3].element.alpha_channel) / 255;
+									if(s_rgb[3].element.alpha_channel != 255)
+									{
+										d_rgb[3].element.red = unsigned(d_rgb[3].element.red * (255 - s_rgb[3].element.alpha_channel) + s_rgb[3].element.red * s_rgb[3].element.alpha_channel) / 255;
+										d_rgb[3].element.green = unsigned(d_rgb[3].element.green * (255 - s_rgb[3].element.alpha_channel) + s_rgb[3].element.green * s_rgb[3].element.alpha_channel) / 255;
+										d_rgb[3].element.blue = unsigned(d_rgb[3].element.blue * (255 - s_rgb[3].element.alpha_channel) + s_rgb[3].element.blue * s_rgb[3].element.alpha_channel) / 255;
+									}
+									else
+										d_rgb[3] = s_rgb[3];
 								}
-								else
-									d_rgb[3] = s_rgb[3];
 							}
-						}
 
-						const pixel_argb_t * s_end = s_rgb + rest;
-						auto rest_d_rgb = d_rgb;
-						for(auto i = s_rgb; i != s_end; ++i)
-						{
-							if(i->element.alpha_channel)
+							const pixel_argb_t * s_end = s_rgb + rest;
+							auto rest_d_rgb = d_rgb;
+							for(auto i = s_rgb; i != s_end; ++i)
 							{
-								if(i->element.alpha_channel != 255)
+								if(i->element.alpha_channel)
 								{
-									rest_d_rgb->element.red = unsigned(rest_d_rgb->element.red * (255 - i->element.alpha_channel) + i->element.red * i->element.alpha_channel) / 255;
-									rest_d_rgb->element.green = unsigned(rest_d_rgb->element.green * (255 - i->element.alpha_channel) + i->element.green * i->element.alpha_channel) / 255;
-									rest_d_rgb->element.blue = unsigned(rest_d_rgb->element.blue * (255 - i->element.alpha_channel) + i->element.blue * i->element.alpha_channel) / 255;
+									if(i->element.alpha_channel != 255)
+									{
+										rest_d_rgb->element.red = unsigned(rest_d_rgb->element.red * (255 - i->element.alpha_channel) + i->element.red * i->element.alpha_channel) / 255;
+										rest_d_rgb->element.green = unsigned(rest_d_rgb->element.green * (255 - i->element.alpha_channel) + i->element.green * i->element.alpha_channel) / 255;
+										rest_d_rgb->element.blue = unsigned(rest_d_rgb->element.blue * (255 - i->element.alpha_channel) + i->element.blue * i->element.alpha_channel) / 255;
+									}
+									else
+										*rest_d_rgb = *i;
 								}
-								else
-									*rest_d_rgb = *i;
+								++rest_d_rgb;
 							}
-							++rest_d_rgb;
+							d_rgb = pixel_at(d_rgb, d_step_bytes);
+							s_rgb = pixel_at(s_rgb, s_step_bytes);
 						}
-						d_rgb = pixel_at(d_rgb, d_step_bytes);
-						s_rgb = pixel_at(s_rgb, s_step_bytes);
-					}
+					});
 				}
 			}
 		
@@ -361,10 +375,10 @@ namespace detail
 			//process
 			virtual void process(const paint::pixel_buffer& s_pixbuf, const nana::rectangle& s_r, paint::pixel_buffer& d_pixbuf, const nana::point& d_pos, double fade_rate) const
 			{
-				auto d_rgb = d_pixbuf.raw_ptr(d_pos.y) + d_pos.x;
-				auto s_rgb = s_pixbuf.raw_ptr(s_r.y) + s_r.x;
+				auto d_px = d_pixbuf.raw_ptr(d_pos.y) + d_pos.x;
+				auto s_px = s_pixbuf.raw_ptr(s_r.y) + s_r.x;
 
-				if(d_rgb && s_rgb)
+				if(d_px && s_px)
 				{
 					auto ptr = detail::alloc_fade_table(fade_rate);//new unsigned char[0x100 * 2];
 
@@ -376,41 +390,46 @@ namespace detail
 
 					std::size_t d_step_bytes = d_pixbuf.bytes_per_line() - (s_r.width - rest) * sizeof(pixel_argb_t);
 					std::size_t s_step_bytes = s_pixbuf.bytes_per_line() - (s_r.width - rest) * sizeof(pixel_argb_t);
-					for(unsigned line = 0; line < s_r.height; ++line)
+					image_process_provider::instance().parallel_bands(s_r.height, s_r.width, [&](std::size_t first_line, std::size_t last_line)
 					{
-						const auto end = d_rgb + length_align4;
-						for(; d_rgb < end; d_rgb += 4, s_rgb += 4)
+						auto d_rgb = pixel_at(d_px, first_line * d_pixbuf.bytes_per_line());
+						auto s_rgb = pixel_at(s_px, first_line * s_pixbuf.bytes_per_line());
+						for(auto line = first_line; line < last_line; ++line)
 						{
-							//0
-							d_rgb[0].element.red = unsigned(d_table[d_rgb[0].element.red] + s_table[s_rgb[0].element.red]);
-							d_rgb[0].element.green = unsigned(d_table[d_rgb[0].element.green] + s_table[s_rgb[0].element.green]);
-							d_rgb[0].element.blue = unsigned(d_table[d_rgb[0].element.blue] + s_table[s_rgb[0].element.blue]);
-
-							//1
-							d_rgb[1].element.red = unsigned(d_table[d_rgb[1].element.red] + s_table[s_rgb[1].element.red]);
-							d_rgb[1].element.green = unsigned(d_table[d_rgb[1].element.green] + s_table[s_rgb[1].element.green]);
-							d_rgb[1].element.blue = unsigned(d_table[d_rgb[1].element.blue] + s_table[s_rgb[1].element.blue]);
-
-							//2
-							d_rgb[2].element.red = unsigned(d_table[d_rgb[2].element.red] + s_table[s_rgb[2].element.red]);
-							d_rgb[2].element.green = unsigned(d_table[d_rgb[2].element.green] + s_table[s_rgb[2].element.green]);
-							d_rgb[2].element.blue = unsigned(d_table[d_rgb[2].element.blue] + s_table[s_rgb[2].element.blue]);
-
-							//3
-							d_rgb[3].element.red = unsigned(d_table[d_rgb[3].element.red] + s_table[s_rgb[3].element.red]);
-							d_rgb[3].element.green = unsigned(d_table[d_rgb[3].element.green] + s_table[s_rgb[3].element.green]);
-							d_rgb[3].element.blue = unsigned(d_table[d_rgb[3].element.blue] + s_table[s_rgb[3].element.blue]);
-						}
+							const auto end = d_rgb + length_align4;
+							for(; d_rgb < end; d_rgb += 4, s_rgb += 4)
+							{
+								//0
+								d_rgb[0].element.red = unsigned(d_table[d_rgb[0].element.red] + s_table[s_rgb[0].element.red]);
+								d_rgb[0].element.green = unsigned(d_table[d_rgb[0].element.green] + s_table[s_rgb[0].element.green]);
+								d_rgb[0].element.blue = unsigned(d_table[d_rgb[0].element.blue] + s_table[s_rgb[0].element.blue]);
+
+								//1
+								d_rgb[1].element.red = unsigned(d_table[d_rgb[1].element.red] + s_table[s_rgb[1].element.red]);
+								d_rgb[1].element.green = unsigned(d_table[d_rgb[1].element.green] + s_table[s_rgb[1].element.green]);
+								d_rgb[1].element.blue = unsigned(d_table[d_rgb[1].element.blue] + s_table[s_rgb[1].element.blue]);
+
+								//2
+								d_rgb[2].element.red = unsigned(d_table[d_rgb[2].element.red] + s_table[s_rgb[2].element.red]);
+								d_rgb[2].element.green = unsigned(d_table[d_rgb[2].element.green] + s_table[s_rgb[2].element.green]);
+								d_rgb[2].element.blue = unsigned(d_table[d_rgb[2].element.blue] + s_table[s_rgb[2].element.blue]);
+
+								//3
+								d_rgb[3].element.red = unsigned(d_table[d_rgb[3].element.red] + s_table[s_rgb[3].element.red]);
+								d_rgb[3].element.green = unsigned(d_table[d_rgb[3].element.green] + s_table[s_rgb[3].element.green]);
+								d_rgb[3].element.blue = unsigned(d_table[d_rgb[3].element.blue] + s_table[s_rgb[3].element.blue]);
+							}
 
-						for(unsigned i = 0; i < rest; ++i)
-						{
-							d_rgb[i].element.red = unsigned(d_table[d_rgb[i].element.red] + s_table[s_rgb[i].element.red]);
-							d_rgb[i].element.green = unsigned(d_table[d_rgb[i].element.green] + s_table[s_rgb[i].element.green]);
-							d_rgb[i].element.blue = unsigned(d_table[d_rgb[i].element.blue] + s_table[s_rgb[i].element.blue]);
+							for(unsigned i = 0; i < rest; ++i)
+							{
+								d_rgb[i].element.red = unsigned(d_table[d_rgb[i].element.red] + s_table[s_rgb[i].element.red]);
+								d_rgb[i].element.green = unsigned(d_table[d_rgb[i].element.green] + s_table[s_rgb[i].element.green]);
+								d_rgb[i].element.blue = unsigned(d_table[d_rgb[i].element.blue] + s_table[s_rgb[i].element.blue]);
+							}
+							d_rgb = pixel_at(d_rgb, d_step_bytes);
+							s_rgb = pixel_at(s_rgb, s_step_bytes);
 						}
-						d_rgb = pixel_at(d_rgb, d_step_bytes);
-						s_rgb = pixel_at(s_rgb, s_step_bytes);
-					}
+					});
 				}
 			}
 		};
@@ -559,20 +578,23 @@ namespace detail
 				int wh = w * h;
 				int div = (radius << 1) + 1;
 
-				int large_edge = (w > h ? w : h);
 				const int div_256 = div * 256;
 
-				std::unique_ptr<int[]> all_table(new int[(wh << 1) + wh + (large_edge << 1) + div_256]);
+				std::unique_ptr<int[]> all_table(new int[(wh << 1) + wh + (w << 1) + (h << 1) + div_256]);
 
 
 				int * r = all_table.get();
 				int * g = r + wh;
 				int * b = g + wh;
 
-				int * vmin = b + wh;
-				int * vmax = vmin + large_edge;
+				//The bounds of the horizontal and vertical windows, they are computed before the passes
+				//because the lines are processed in bands.
+				int * vmin_x = b + wh;
+				int * vmax_x = vmin_x + w;
+				int * vmin_y = vmax_x + w;
+				int * vmax_y = vmin_y + h;
 
-				int * dv = vmax + large_edge;
+				int * dv = vmax_y + h;
 				int end_div = div - 1;
 				for(int i = 0, *dv_block = dv; i < 256; ++i)
 				{
@@ -585,103 +607,114 @@ namespace detail
 					dv_block += div;
 				}
 
-				auto linepix = pixbuf.raw_ptr(area.y) + area.x;
+				for(int x = 0; x < w; ++x)
+				{
+					vmin_x[x] = std::min(x + radius + 1, wm);
+					vmax_x[x] = std::max(x - radius, 0);
+				}
 
-				int yi = 0;
 				for(int y = 0; y < h; ++y)
 				{
-					int sum_r = 0, sum_g = 0, sum_b = 0;
-					if(radius <= wm)
+					vmin_y[y] = std::min(y + radius + 1, hm) * w;
+					vmax_y[y] = std::max(y - radius, 0) * w;
+				}
+
+				auto & provider = image_process_provider::instance();
+
+				//The horizontal pass, the line y is computed from the pixels of line y - 1 except the first line.
+				provider.parallel_bands(h, w, [&](std::size_t begin, std::size_t end)
+				{
+					for(int y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
 					{
-						for(int i = - radius; i <= radius; ++i)
+						auto linepix = pixbuf.raw_ptr(area.y + (y > 0 ? y - 1 : 0)) + area.x;
+
+						int sum_r = 0, sum_g = 0, sum_b = 0;
+						if(radius <= wm)
 						{
-							auto px = linepix[(i > 0 ? i : 0)];
-							sum_r += px.element.red;
-							sum_g += px.element.green;
-							sum_b += px.element.blue;
-						}					
-					}
-					else
-					{
-						for(int i = - radius; i <= radius; ++i)
+							for(int i = - radius; i <= radius; ++i)
+							{
+								auto px = linepix[(i > 0 ? i : 0)];
+								sum_r += px.element.red;
+								sum_g += px.element.green;
+								sum_b += px.element.blue;
+							}
+						}
+						else
 						{
-							auto px = linepix[std::min(wm, (i > 0 ? i : 0))];
-							sum_r += px.element.red;
-							sum_g += px.element.green;
-							sum_b += px.element.blue;
+							for(int i = - radius; i <= radius; ++i)
+							{
+								auto px = linepix[std::min(wm, (i > 0 ? i : 0))];
+								sum_r += px.element.red;
+								sum_g += px.element.green;
+								sum_b += px.element.blue;
+							}
 						}
-					}
-
-					for(int x = 0; x < w; ++x)
-					{
-						r[yi] = dv[sum_r];
-						g[yi] = dv[sum_g];
-						b[yi] = dv[sum_b];
 
-						if(0 == y)
+						int yi = y * w;
+						for(int x = 0; x < w; ++x)
 						{
-							vmin[x] = std::min(x + radius + 1, wm);
-							vmax[x] = std::max(x - radius, 0);
-						}
+							r[yi] = dv[sum_r];
+							g[yi] = dv[sum_g];
+							b[yi] = dv[sum_b];
 
-						auto p1 = linepix[vmin[x]];
-						auto p2 = linepix[vmax[x]];
+							auto p1 = linepix[vmin_x[x]];
+							auto p2 = linepix[vmax_x[x]];
 
-						sum_r += p1.element.red - p2.element.red;
-						sum_g += p1.element.green - p2.element.green;
-						sum_b += p1.element.blue - p2.element.blue;
-						++yi;
+							sum_r += p1.element.red - p2.element.red;
+							sum_g += p1.element.green - p2.element.green;
+							sum_b += p1.element.blue - p2.element.blue;
+							++yi;
+						}
 					}
-					linepix = pixbuf.raw_ptr(area.y + y) + area.x;
-				}
+				});
 
 				const int yp_init = -radius * w;
 
 				const std::size_t bytes_pl = pixbuf.bytes_per_line();
-				for(int x = 0; x < w; ++x)
-				{
-					int sum_r = 0, sum_g = 0, sum_b = 0;
 
-					int yp = yp_init;
-					for(int i = -radius; i <= radius; ++i)
+				//The vertical pass, the columns are processed in bands.
+				provider.parallel_bands(w, h, [&](std::size_t begin, std::size_t end)
+				{
+					for(int x = static_cast<int>(begin); x < static_cast<int>(end); ++x)
 					{
-						if(yp < 1)
-						{
-							sum_r += r[x];
-							sum_g += g[x];
-							sum_b += b[x];
-						}
-						else
+						int sum_r = 0, sum_g = 0, sum_b = 0;
+
+						int yp = yp_init;
+						for(int i = -radius; i <= radius; ++i)
 						{
-							int yi = yp + x;
-							sum_r += r[yi];
-							sum_g += g[yi];
-							sum_b += b[yi];
+							if(yp < 1)
+							{
+								sum_r += r[x];
+								sum_g += g[x];
+								sum_b += b[x];
+							}
+							else
+							{
+								int yi = yp + x;
+								sum_r += r[yi];
+								sum_g += g[yi];
+								sum_b += b[yi];
+							}
+							yp += w;
 						}
-						yp += w;
-					}
 
-					linepix = pixbuf.raw_ptr(area.y) + x;
+						auto linepix = pixbuf.raw_ptr(area.y) + x;
 
-					for(int y = 0; y < h; ++y)
-					{
-						linepix->value = 0xFF000000 | (dv[sum_r] << 16) | (dv[sum_g] << 8) | dv[sum_b];
-						if(x == 0)
+						for(int y = 0; y < h; ++y)
 						{
-							vmin[y] = std::min(y + radius + 1, hm) * w;
-							vmax[y] = std::max(y - radius, 0) * w;
-						}
+							linepix->value = 0xFF000000 | (dv[sum_r] << 16) | (dv[sum_g] << 8) | dv[sum_b];
 
-						int pt1 = x + vmin[y];
-						int pt2 = x + vmax[y];
+							int pt1 = x + vmin_y[y];
+							int pt2 = x + vmax_y[y];
 
-						sum_r += r[pt1] - r[pt2];
-						sum_g += g[pt1] - g[pt2];
-						sum_b += b[pt1] - b[pt2];
+							sum_r += r[pt1] - r[pt2];
+							sum_g += g[pt1] - g[pt2];
+							sum_b += b[pt1] - b[pt2];
 
-						linepix = pixel_at(linepix, bytes_pl);
+							linepix = pixel_at(linepix, bytes_pl);
+						}
 					}
-				}
+				});
 			}
 		};//end class superfast_blur
 	}
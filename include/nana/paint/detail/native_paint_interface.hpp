@@ -35,6 +35,10 @@ namespace detail
 	nana::size raw_text_extent_size(drawable_type, const wchar_t*, std::size_t len);
 	nana::size text_extent_size(drawable_type, const wchar_t*, std::size_t len);
 	void draw_string(drawable_type, const nana::point&, const wchar_t *, std::size_t len);
+
+	//Renders the glyphs which are deferred by graphics::glyph_run_begin(), it should be called before
+	//the pixels of drawable are accessed by an operation other than text drawing.
+	void flush_glyph_run(drawable_type);
 }//end namespace detail
 }//end namespace paint
 }//end namespace nana
@@ -14,6 +14,7 @@
 #define NANA_PAINT_GRAPHICS_HPP
 
 #include <memory>
+#include <vector>
 
 #include "../basic_types.hpp"
 #include "../gui/basis.hpp"
@@ -125,6 +126,10 @@ namespace nana
 			void paste(graphics& dst, int x, int y) const;    ///< Paste the graphics object into the dest at (x, y)
 			void paste(native_window_type dst, const ::nana::rectangle&, int sx, int sy) const;  ///< Paste the graphics object into a platform-dependent window at (x, y)
 			void paste(native_window_type dst, int dx, int dy, unsigned width, unsigned height, int sx, int sy) const;
+
+			/// Pastes the areas of the graphics object into a platform-dependent window at the same positions, the window is
+			/// updated once for all of the areas.
+			void paste(native_window_type dst, const std::vector<::nana::rectangle>& areas) const;
 			void paste(drawable_type dst, int x, int y) const;
 			void paste(const ::nana::rectangle& r_src, graphics& dst, int x, int y) const;
 			void rgb_to_wb();   ///< Transform a color graphics into black&white.
@@ -134,6 +139,15 @@ namespace nana
 
 			void flush();
 
+			/// Defers the text rendering of the graphics.
+			/**
+			 * The glyphs drawn by string() are accumulated and rendered with one request per text color when
+			 * glyph_run_end() is called, or before the graphics is painted by an operation that may cover them.
+			 * The calls can be nested. It takes effect under X11 with Xft.
+			 */
+			void glyph_run_begin();
+			void glyph_run_end();
+
 			unsigned width() const;		///< Returns the width of the off-screen buffer.
 			unsigned height() const;	///< Returns the height of the off-screen buffer.
 			::nana::size size() const;
@@ -63,6 +63,13 @@ namespace nana
 					detail::image_process_provider & p = detail::image_process_provider::instance();
 					p.add<ImageProcessor>(p.ref_blur_tag(), name);
 				}
+
+				/// Sets the maximum number of threads that process a large image, 0 means the number of hardware threads and 1 disables the multithreading.
+				/*! The image is split into bands of lines and the result is same with any number of threads.
+				 */
+				void concurrency(std::size_t max_threads);
+				/// Sets the minimum number of pixels of an image that is processed by multiple threads.
+				void concurrency_threshold(std::size_t pixels);
 			};
 		}
 	}
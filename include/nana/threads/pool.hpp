@@ -123,6 +123,10 @@ namespace threads
 		return pool_pusher<std::function<void()> >(pobj, std::bind(mf, &obj));
 	}
 
+	/// Returns the pool which is shared by the parallel algorithms of the library, it has a thread less than the hardware threads.
+	/// The pool is created when it is used at first time.
+	pool& shared_pool();
+
 }//end namespace threads
 }//end namespace nana
 #endif
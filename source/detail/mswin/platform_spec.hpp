@@ -76,6 +76,7 @@ namespace detail
 			async_activate,
 			async_set_focus,
 			remote_flush_surface,
+			flush_frame,	//Flushes the pending frame of the root window
 			remote_thread_destroy_window,
 			remote_thread_move_window,
 			operate_caret,	//wParam: 1=Destroy, 2=SetPos
@@ -144,6 +144,9 @@ IsWindowsServer()
 #		include <X11/Xft/Xft.h>
 #		include <iconv.h>
 #		include <fstream>
+#		include <atomic>
+#		include <mutex>
+#		include <unordered_map>
 #	endif
 #endif
 
@@ -162,7 +165,12 @@ namespace nana
 			size_(font_size),
 			style_(fs),
 			native_handle_(native_font)
-		{}
+		{
+#ifdef NANA_USE_XFT
+			for (std::size_t i = 0; i < glyph_cache::dense_size; ++i)
+				glyph_cache_.dense[i].store(glyph_cache::unknown, std::memory_order_relaxed);
+#endif
+		}
 
 		~internal_font()
 		{
@@ -199,12 +207,103 @@ namespace nana
 		{
 			return native_handle_;
 		}
+
+#ifdef NANA_USE_XFT
+		unsigned glyph_advances(const wchar_t* str, std::size_t len, unsigned* advances) const override
+		{
+			std::size_t misses = 0;
+			unsigned sum = 0;
+
+			//The sparse table is locked on demand, a text in the dense range never takes the lock.
+			std::unique_lock<std::mutex> sparse_lock{ glyph_cache_.sparse_mutex, std::defer_lock };
+
+			for (auto end = str + len; str != end; ++str)
+			{
+				auto const code = static_cast<std::size_t>(*str);
+
+				unsigned px;
+				if (code < glyph_cache::dense_size)
+				{
+					auto & slot = glyph_cache_.dense[code];
+					px = slot.load(std::memory_order_relaxed);
+					if (glyph_cache::unknown == px)
+					{
+						px = _m_measure(*str);
+						slot.store(px, std::memory_order_relaxed);
+						++misses;
+					}
+				}
+				else
+				{
+					if (!sparse_lock.owns_lock())
+						sparse_lock.lock();
+
+					auto i = glyph_cache_.sparse.find(*str);
+					if (i == glyph_cache_.sparse.end())
+					{
+						px = _m_measure(*str);
+						glyph_cache_.sparse[*str] = px;
+						++misses;
+					}
+					else
+						px = i->second;
+				}
+
+				if (advances)
+					*(advances++) = px;
+
+				sum += px;
+			}
+
+			if (misses)
+				glyph_cache_.misses.fetch_add(misses, std::memory_order_relaxed);
+
+			glyph_cache_.hits.fetch_add(len - misses, std::memory_order_relaxed);
+			return sum;
+		}
+
+		glyph_statistics glyph_cache_statistics() const override
+		{
+			return{ glyph_cache_.hits.load(), glyph_cache_.misses.load() };
+		}
+	private:
+		unsigned _m_measure(wchar_t ch) const
+		{
+			auto disp = ::nana::detail::platform_spec::instance().open_display();
+			auto xft = reinterpret_cast<XftFont*>(native_handle_);
+
+			XGlyphInfo extents;
+			FT_UInt glyph = ::XftCharIndex(disp, xft, ch);
+			::XftGlyphExtents(disp, xft, &glyph, 1, &extents);
+			return static_cast<unsigned>(extents.xOff);
+		}
+#endif
 	private:
 		path_type	const ttf_;
 		std::string	const family_;
 		double		const size_;
 		font_style	const style_;
 		native_font_type const native_handle_;
+
+#ifdef NANA_USE_XFT
+		//The advances of characters below dense_size are stored in a table indexed by the character,
+		//others are stored in a hash table.
+		struct glyph_cache
+		{
+			static const std::size_t dense_size = 0x800;
+			static const unsigned unknown = 0xFFFFFFFF;
+
+			std::atomic<unsigned> dense[dense_size];
+
+			std::mutex sparse_mutex;
+			std::unordered_map<wchar_t, unsigned> sparse;
+
+			std::atomic<std::size_t> hits{ 0 };
+			std::atomic<std::size_t> misses{ 0 };
+		};
+
+		mutable glyph_cache glyph_cache_;
+#endif
 	};
 
 	struct platform_runtime
@@ -4,6 +4,7 @@
 #include <nana/paint/detail/ptdefs.hpp>
 
 #include <string>
+#include <cstddef>
 
 #ifdef NANA_X11
 #	define NANA_USE_XFT
@@ -17,12 +18,31 @@ namespace nana
 		using font_style = detail::font_style;
 		using native_font_type = paint::native_font_type;
 
+#ifdef NANA_USE_XFT
+		/// The hits and misses of the glyph advance cache
+		struct glyph_statistics
+		{
+			std::size_t hits;
+			std::size_t misses;
+		};
+#endif
+
 		virtual ~font_interface() = default;
 
 		virtual const std::string& family() const = 0;
 		virtual double size() const = 0;
 		virtual const font_style & style() const = 0;
 		virtual native_font_type native_handle() const = 0;
+
+#ifdef NANA_USE_XFT
+		/// Retrieves the advances of glyphs from the cache of the font, the glyphs which are not cached are measured by Xft.
+		/**
+		 * @param advances A buffer for the advance of each character, it can be nullptr if only the sum is required.
+		 * @return The sum of the advances in pixels.
+		 */
+		virtual unsigned glyph_advances(const wchar_t* str, std::size_t len, unsigned* advances) const = 0;
+		virtual glyph_statistics glyph_cache_statistics() const = 0;
+#endif
 	};
 }
 
@@ -25,6 +25,7 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <limits>
 #include <nana/paint/graphics.hpp>
 #include <nana/gui/detail/bedrock.hpp>
 #include <nana/gui/detail/basic_window.hpp>
@@ -241,14 +242,15 @@ namespace detail
 			: is_proc_handling_(false)
 		{}
 
-		void set(std::size_t id, std::size_t interval, timer_proc_t proc)
+		//Returns the thread which owns the timer.
+		unsigned set(std::size_t id, std::size_t interval, timer_proc_t proc)
 		{
 			auto i = holder_.find(id);
 			if(i != holder_.end())
 			{
 				i->second.interval = interval;
 				i->second.proc = proc;
-				return;
+				return i->second.tid;
 			}
 			unsigned tid = nana::system::this_thread_id();
 			threadmap_[tid].timers.insert(id);
@@ -259,6 +261,7 @@ namespace detail
 			tag.interval = interval;
 			tag.timestamp = 0;
 			tag.proc = proc;
+			return tid;
 		}
 
 		bool is_proc_handling() const
@@ -295,8 +298,14 @@ namespace detail
 			return (holder_.empty());
 		}
 
-		void timer_proc(unsigned tid)
+		//timer_proc
+		//@brief: Runs the due timers of the specified thread.
+		//@return: the number of milliseconds before the next timer of the thread is due, or
+		//	the max value of std::size_t if the thread doesn't own a timer.
+		std::size_t timer_proc(unsigned tid)
 		{
+			std::size_t next_due = (std::numeric_limits<std::size_t>::max)();
+
 			is_proc_handling_ = true;
 			auto i = threadmap_.find(tid);
 			if(i != threadmap_.end())
@@ -306,26 +315,36 @@ namespace detail
 				unsigned ticks = nana::system::timestamp();
 				for(auto timer_id : group.timers)
 				{
-					auto & tag = holder_[timer_id];
-					if(tag.timestamp)
+					//The timer may be killed by a timer handler.
+					auto u = holder_.find(timer_id);
+					if(u == holder_.end())
+						continue;
+
+					auto & tag = u->second;
+					if(0 == tag.timestamp)
+						tag.timestamp = ticks;
+
+					if(ticks >= tag.timestamp + tag.interval)
 					{
-						if(ticks >= tag.timestamp + tag.interval)
+						//The remaining time is measured before calling the handler, the tag is
+						//invalid if the timer is killed by the handler.
+						tag.timestamp = ticks;
+						next_due = (std::min)(next_due, (std::max)(tag.interval, std::size_t(1)));
+						try
 						{
-							tag.timestamp = ticks;
-							try
-							{
-								tag.proc(tag.id);
-							}catch(...){}	//nothrow
-						}
+							tag.proc(tag.id);
+						}catch(...){}	//nothrow
 					}
 					else
-						tag.timestamp = ticks;
+						next_due = (std::min)(next_due, std::size_t(tag.timestamp + tag.interval - ticks));
 				}
 				group.proc_entered = false;
 				for(auto tmr: group.delay_deleted)
 					group.timers.erase(tmr);
+				group.delay_deleted.clear();
 			}
 			is_proc_handling_ = false;
+			return next_due;
 		}
 	private:
 		bool is_proc_handling_;
@@ -351,6 +370,26 @@ namespace detail
 #endif
 	}
 
+#if defined(NANA_USE_XFT)
+	void drawable_impl_type::flush_glyph_run()
+	{
+		if (!glyph_run.pending)
+			return;
+
+		glyph_run.pending = false;
+		for (std::size_t i = 0; i < glyph_run.used; ++i)
+		{
+			auto & grp = glyph_run.groups[i];
+			if (grp.glyphs.empty())
+				continue;
+
+			::XftDrawGlyphFontSpec(xftdraw, &grp.color, grp.glyphs.data(), static_cast<int>(grp.glyphs.size()));
+			grp.glyphs.clear();
+		}
+		glyph_run.used = 0;
+	}
+#endif
+
 	unsigned drawable_impl_type::get_color() const
 	{
 		return color_;
@@ -374,6 +413,11 @@ namespace detail
 
 	void drawable_impl_type::update_color()
 	{
+#if defined(NANA_USE_XFT)
+		//The primitive which is going to be drawn may cover the deferred glyphs.
+		if (glyph_run.pending)
+			flush_glyph_run();
+#endif
 		if (color_ != current_color_)
 		{
 			auto & spec = nana::detail::platform_spec::instance();
@@ -449,7 +493,7 @@ namespace detail
 	{}
 
 	platform_spec::platform_spec()
-		:display_(0), colormap_(0), def_X11_error_handler_(0), grab_(0)
+		:display_(0), colormap_(0), def_X11_error_handler_(0), grab_(0), msg_dispatcher_(nullptr)
 	{
 		::XInitThreads();
 		const char * langstr = getenv("LC_CTYPE");
@@ -553,6 +597,11 @@ namespace detail
 
 	void platform_spec::unlock_xlib()
 	{
+		//Xlib reads events into its queue while a thread is waiting for a reply, the msg driver
+		//blocks on the X connection and never sees them unless it is woken up.
+		if(msg_dispatcher_ && XQLength(display_))
+			msg_dispatcher_->wakeup();
+
 		xlib_locker_.unlock();
 	}
 
@@ -928,11 +977,18 @@ namespace detail
 
 	void platform_spec::set_timer(std::size_t id, std::size_t interval, void (*timer_proc)(std::size_t))
 	{
-		std::lock_guard<decltype(timer_.mutex)> lock(timer_.mutex);
-		if(0 == timer_.runner)
-			timer_.runner = new timer_runner;
-		timer_.runner->set(id, interval, timer_proc);
-		timer_.delete_declared = false;
+		unsigned tid;
+		{
+			std::lock_guard<decltype(timer_.mutex)> lock(timer_.mutex);
+			if(0 == timer_.runner)
+				timer_.runner = new timer_runner;
+			tid = timer_.runner->set(id, interval, timer_proc);
+			timer_.delete_declared = false;
+		}
+
+		//The thread may be sleeping until a later due time, it is woken up to recalculate the timeout.
+		if(msg_dispatcher_)
+			msg_dispatcher_->timers_changed(tid);
 	}
 
 	void platform_spec::kill_timer(std::size_t id)
@@ -953,12 +1009,14 @@ namespace detail
 		}
 	}
 
-	void platform_spec::timer_proc(unsigned tid)
+	std::size_t platform_spec::timer_proc(unsigned tid)
 	{
+		std::size_t next_due = (std::numeric_limits<std::size_t>::max)();
+
 		std::lock_guard<decltype(timer_.mutex)> lock(timer_.mutex);
 		if(timer_.runner)
 		{
-			timer_.runner->timer_proc(tid);
+			next_due = timer_.runner->timer_proc(tid);
 			if(timer_.delete_declared)
 			{
 				delete timer_.runner;
@@ -966,6 +1024,7 @@ namespace detail
 				timer_.delete_declared = false;
 			}
 		}
+		return next_due;
 	}
 
 	void platform_spec::msg_insert(native_window_type wd)
@@ -973,6 +1032,11 @@ namespace detail
 		msg_dispatcher_->insert(reinterpret_cast<Window>(wd));
 	}
 
+	void platform_spec::msg_post(const msg_packet_tag& msg)
+	{
+		msg_dispatcher_->post(msg);
+	}
+
 	void platform_spec::msg_set(timer_proc_type tp, event_proc_type ep)
 	{
 		msg_dispatcher_->set(tp, ep, &platform_spec::_m_msg_filter);
@@ -983,6 +1047,16 @@ namespace detail
 		msg_dispatcher_->dispatch(reinterpret_cast<Window>(modal));
 	}
 
+	std::size_t platform_spec::msg_coalesced_motions() const
+	{
+		return msg_dispatcher_->coalesced().motion;
+	}
+
+	std::size_t platform_spec::msg_coalesced_exposes() const
+	{
+		return msg_dispatcher_->coalesced().expose;
+	}
+
 	void* platform_spec::request_selection(native_window_type requestor, Atom type, size_t& size)
 	{
 		if(requestor)
@@ -13,19 +13,42 @@
  *	This class msg_dispatcher provides a simulation of Windows-like message
  *	dispatcher. Every event is dispatched into its own message queue for
  *	corresponding thread.
+ *
+ *	The msg driver blocks on the X connection and an internal wakeup descriptor
+ *	(epoll and eventfd under Linux, poll and a pipe elsewhere), and the threads
+ *	of windows block on their queues until a msg arrives or a timer is due.
+ *	None of them wakes up periodically.
+ *
+ *	Each thread owns a ring buffer of msgs guarded by its own mutex, and the
+ *	window-to-thread table is published as an immutable snapshot, so threads of
+ *	windows never contend on a global lock and queuing a msg doesn't allocate.
  */
 
 #ifndef NANA_DETAIL_MSG_DISPATCHER_HPP
 #define NANA_DETAIL_MSG_DISPATCHER_HPP
 #include "msg_packet.hpp"
 #include <nana/system/platform.hpp>
-#include <list>
+#include <vector>
 #include <set>
 #include <map>
+#include <algorithm>
 #include <mutex>
 #include <condition_variable>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <unistd.h>
+
+#if defined(NANA_LINUX)
+#	include <sys/epoll.h>
+#	include <sys/eventfd.h>
+#else
+#	include <poll.h>
+#	include <fcntl.h>
+#endif
 
 namespace nana
 {
@@ -33,22 +56,121 @@ namespace detail
 {
 	class msg_dispatcher
 	{
+		//msg_ring
+		//A FIFO of msgs stored in a power-of-two ring buffer. The storage is only reallocated
+		//when the ring is full, so a steady stream of msgs doesn't allocate.
+		class msg_ring
+		{
+		public:
+			msg_ring()
+				: buf_(initial_capacity)
+			{}
+
+			bool empty() const
+			{
+				return (head_ == tail_);
+			}
+
+			std::size_t size() const
+			{
+				return (tail_ - head_);
+			}
+
+			//Access the msg at the specified position, 0 is the front.
+			msg_packet_tag& operator[](std::size_t pos)
+			{
+				return buf_[(head_ + pos) & (buf_.size() - 1)];
+			}
+
+			msg_packet_tag& back()
+			{
+				return (*this)[size() - 1];
+			}
+
+			void push_back(const msg_packet_tag& msg)
+			{
+				if(size() == buf_.size())
+					_m_grow();
+
+				buf_[tail_++ & (buf_.size() - 1)] = msg;
+			}
+
+			void pop_front(msg_packet_tag& msg)
+			{
+				msg = buf_[head_++ & (buf_.size() - 1)];
+			}
+
+			//Removes the msgs which satisfy the predicate, the order of remaining msgs is kept.
+			template<typename Predicate>
+			void remove_if(Predicate pred)
+			{
+				std::size_t kept = 0;
+				const auto count = size();
+				for(std::size_t i = 0; i < count; ++i)
+				{
+					auto & msg = (*this)[i];
+					if(!pred(msg))
+						(*this)[kept++] = msg;
+				}
+				tail_ = head_ + kept;
+			}
+		private:
+			void _m_grow()
+			{
+				std::vector<msg_packet_tag> buf(buf_.size() * 2);
+				const auto count = size();
+				for(std::size_t i = 0; i < count; ++i)
+					buf[i] = (*this)[i];
+
+				buf_.swap(buf);
+				head_ = 0;
+				tail_ = count;
+			}
+		private:
+			static const std::size_t initial_capacity = 128;
+
+			std::vector<msg_packet_tag> buf_;
+			std::size_t head_{ 0 };	//The counters keep increasing, they are masked when the buffer is accessed.
+			std::size_t tail_{ 0 };
+		};
+
 		struct thread_binder
 		{
 			unsigned tid;
-			std::mutex	mutex;
+			std::mutex	mutex;	//It guards the msg_queue and the window set.
 			std::condition_variable	cond;
-			std::list<msg_packet_tag>	msg_queue;
+			msg_ring	msg_queue;
 			std::set<Window> window;
+			bool timers_changed{ false };	//The timeout of the thread is out of date.
+		};
+
+		//The window and thread tables are never modified after they are published. A modification
+		//copies the current tables, and the readers keep using the snapshot they loaded.
+		struct lookup_table
+		{
+			std::map<unsigned, std::shared_ptr<thread_binder>> thr_table;
+			std::map<Window, std::shared_ptr<thread_binder>> wnd_table;
 		};
 
 	public:
 		typedef msg_packet_tag	msg_packet;
-		typedef void (*timer_proc_type)(unsigned tid);
+
+		/// The timer_proc runs the due timers of the thread and returns the number of milliseconds
+		/// before the next timer is due, or no_timer if the thread doesn't own a timer.
+		typedef std::size_t (*timer_proc_type)(unsigned tid);
 		typedef void (*event_proc_type)(Display*, msg_packet_tag&);
 		typedef int (*event_filter_type)(XEvent&, msg_packet_tag&);
 
-		typedef std::list<msg_packet_tag> msg_queue_type;
+		typedef msg_ring msg_queue_type;
+
+		/// The number of events that are folded into a pending event instead of being queued
+		struct coalescing_stats
+		{
+			std::atomic<std::size_t> motion{ 0 };
+			std::atomic<std::size_t> expose{ 0 };
+		};
+
+		static constexpr std::size_t no_timer = (std::numeric_limits<std::size_t>::max)();
 
 		msg_dispatcher(Display* disp)
 			: display_(disp)
@@ -56,15 +178,42 @@ namespace detail
 			proc_.event_proc = 0;
 			proc_.timer_proc = 0;
 			proc_.filter_proc = 0;
+
+#if defined(NANA_LINUX)
+			driver_.wakeup_fd[0] = driver_.wakeup_fd[1] = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			driver_.epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+
+			struct epoll_event ev;
+			ev.events = EPOLLIN;
+			ev.data.fd = ConnectionNumber(display_);
+			::epoll_ctl(driver_.epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+
+			ev.data.fd = driver_.wakeup_fd[0];
+			::epoll_ctl(driver_.epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+#else
+			if(0 == ::pipe(driver_.wakeup_fd))
+			{
+				for(auto fd : driver_.wakeup_fd)
+				{
+					::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+					::fcntl(fd, F_SETFD, FD_CLOEXEC);
+				}
+			}
+#endif
 		}
 
 		~msg_dispatcher()
 		{
 			if(thrd_ && thrd_->joinable())
-			{
-				is_work_ = false;
-				thrd_->join();
-			}
+				_m_stop_driver();
+
+#if defined(NANA_LINUX)
+			::close(driver_.epoll_fd);
+			::close(driver_.wakeup_fd[0]);
+#else
+			::close(driver_.wakeup_fd[0]);
+			::close(driver_.wakeup_fd[1]);
+#endif
 		}
 
 		void set(timer_proc_type timer_proc, event_proc_type event_proc, event_filter_type filter)
@@ -82,36 +231,32 @@ namespace detail
 
 			{
 				std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
+				auto table = std::make_shared<lookup_table>(*_m_table());
 
 				//No thread is running, so msg dispatcher should start the msg driver.
-				start_driver = (0 == table_.thr_table.size());
-				thread_binder * thr;
+				start_driver = (0 == table->thr_table.size());
 
-				std::map<unsigned, thread_binder*>::iterator i = table_.thr_table.find(tid);
-				if(i == table_.thr_table.end())
+				auto & thr = table->thr_table[tid];
+				if(!thr)
 				{
-					thr = new thread_binder;
+					thr = std::make_shared<thread_binder>();
 					thr->tid = tid;
-					table_.thr_table.insert(std::make_pair(tid, thr));
 				}
-				else
-					thr = i->second;
 
 				thr->mutex.lock();
 				thr->window.insert(wd);
 				thr->mutex.unlock();
 			
-				table_.wnd_table[wd] = thr;
+				table->wnd_table[wd] = thr;
+				_m_publish(std::move(table));
 			}
 
 			if(start_driver && proc_.event_proc && proc_.timer_proc)
 			{
 				//It should start the msg driver, before starting it, the msg driver must be inactive.
 				if(thrd_)
-				{
-					is_work_ = false;
-					thrd_->join();
-				}
+					_m_stop_driver();
+
 				is_work_ = true;
 				thrd_ = std::unique_ptr<std::thread>(new std::thread([this](){ this->_m_msg_driver(); }));
 			}
@@ -121,20 +266,23 @@ namespace detail
 		{
 			std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
 			
-			auto i = table_.wnd_table.find(wd);
-			if(i != table_.wnd_table.end())
+			auto current = _m_table();
+			auto i = current->wnd_table.find(wd);
+			if(i != current->wnd_table.end())
 			{
-				thread_binder * const thr = i->second;
+				auto thr = i->second;
+
+				auto table = std::make_shared<lookup_table>(*current);
+				table->wnd_table.erase(wd);
+				_m_publish(std::move(table));
+
+				//The driver may still find the window in an old snapshot, it checks the window
+				//set of the thread before queuing a msg.
 				std::lock_guard<decltype(thr->mutex)> lock(thr->mutex);
-				for(auto li = thr->msg_queue.begin(); li != thr->msg_queue.end();)
-				{
-					if(wd == _m_window(*li))
-						li = thr->msg_queue.erase(li);
-					else
-						++li;
-				}
+				thr->msg_queue.remove_if([wd](const msg_packet_tag& msg){
+					return (wd == _m_window(msg));
+				});
 
-				table_.wnd_table.erase(i);
 				thr->window.erase(wd);
 				
 				//There still is at least one window alive.
@@ -146,24 +294,100 @@ namespace detail
 					msg.u.packet_window = wd;
 					thr->msg_queue.push_back(msg);
 				}
+
+				//Wake the thread up, it exits the queue if the last window is closed.
+				thr->cond.notify_one();
 			}
 		}
 
+		//wakeup
+		//@brief: Wakes the msg driver up. It is called when Xlib has read events into its queue
+		//	on behalf of another thread, these events are never reported by the X connection.
+		void wakeup()
+		{
+			if(_m_is_driver() || !is_work_)
+				return;
+
+			//Only the first call after the driver went to sleep is required to signal it.
+			if(!driver_.signaled.exchange(true))
+				_m_signal_driver();
+		}
+
+		//timers_changed
+		//@brief: Wakes the thread up to recalculate its timeout. It is called when a timer of the thread is
+		//	set, because the thread may be sleeping until a later due time.
+		void timers_changed(unsigned tid)
+		{
+			std::shared_ptr<thread_binder> thr;
+			{
+				std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
+				auto & table = _m_table();
+				auto i = table->thr_table.find(tid);
+				if(i == table->thr_table.end())
+					return;
+
+				thr = i->second;
+			}
+
+			std::lock_guard<decltype(thr->mutex)> lock(thr->mutex);
+			thr->timers_changed = true;
+			thr->cond.notify_one();
+		}
+
+		//post
+		//@brief: Queues a msg packet for the thread of its window and wakes the thread up, the packet is dropped if
+		//	the window is not registered. It is called by the threads other than the driver.
+		void post(const msg_packet_tag& msg)
+		{
+			std::shared_ptr<thread_binder> thr;
+			{
+				std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
+				auto & table = _m_table();
+				auto i = table->wnd_table.find(_m_window(msg));
+				if(i == table->wnd_table.end())
+					return;
+
+				thr = i->second;
+			}
+
+			std::lock_guard<decltype(thr->mutex)> lock(thr->mutex);
+			if(0 == thr->window.count(_m_window(msg)))
+				return;
+
+			thr->msg_queue.push_back(msg);
+			thr->cond.notify_one();
+		}
+
+		const coalescing_stats& coalesced() const
+		{
+			return stats_;
+		}
+
 		void dispatch(Window modal)
 		{
 			unsigned tid = nana::system::this_thread_id();
 			msg_packet_tag msg;
 			int qstate;
+
+			//Test whether the thread is registered for window
+			std::shared_ptr<thread_binder> thr;
+			{
+				std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
+				auto & table = _m_table();
+				auto i = table->thr_table.find(tid);
+				if(i == table->thr_table.end())
+					return;
+
+
+				thr = i->second;
+			}
 			
-			//Test whether the thread is registered for window, and retrieve the queue state for event
-			while((qstate = _m_read_queue(tid, msg, modal)))
+			//Retrieve the queue state for event
+			while((qstate = _m_read_queue(*thr, msg, modal)))
 			{
-				//the queue is empty
+				//the queue is empty, run the due timers and sleep until the next timer is due
 				if(-1 == qstate)
-				{
-					if(false == _m_wait_for_queue(tid))
-						proc_.timer_proc(tid);
-				}
+					_m_wait_for_queue(*thr, proc_.timer_proc(tid));
 				else
 				{
 					proc_.event_proc(display_, msg);
@@ -173,7 +397,7 @@ namespace detail
 	private:
 		void _m_msg_driver()
 		{
-			const int fd_X11 = ConnectionNumber(display_);
+			_m_is_driver() = true;
 
 			msg_packet_tag msg_pack;
 			XEvent event;
@@ -204,16 +428,7 @@ namespace detail
 				}
 
 				if(0 == pending)
-				{
-					fd_set fdset;
-					FD_ZERO(&fdset);
-					FD_SET(fd_X11, &fdset);
-
-					struct timeval tv;
-					tv.tv_usec = 10000;
-					tv.tv_sec = 0;
-					::select(fd_X11 + 1, &fdset, 0, 0, &tv);
-				}
+					_m_wait_for_driver();
 				else
 				{
 					switch(proc_.filter_proc(event, msg_pack))
@@ -227,6 +442,63 @@ namespace detail
 				}
 			}
 		}
+
+		//_m_wait_for_driver
+		//@brief: Blocks the msg driver until the X connection is readable or the driver is signaled. The events which
+		//	are already read into the queue of Xlib don't make the connection readable, so the queue is checked right
+		//	before blocking, and the wait is bounded in case Xlib reads the events without the lock of platform_spec.
+		void _m_wait_for_driver()
+		{
+			{
+				nana::detail::platform_scope_guard lock;
+				if(::XQLength(display_))
+					return;
+			}
+
+			const int timeout_ms = 100;
+#if defined(NANA_LINUX)
+			struct epoll_event events[2];
+			::epoll_wait(driver_.epoll_fd, events, 2, timeout_ms);
+#else
+			struct pollfd fds[2];
+			fds[0].fd = ConnectionNumber(display_);
+			fds[1].fd = driver_.wakeup_fd[0];
+			fds[0].events = fds[1].events = POLLIN;
+			::poll(fds, 2, timeout_ms);
+#endif
+			//Drains the wakeup descriptor before clearing the flag, a wakeup() after clearing
+			//the flag signals the descriptor again.
+			char buf[sizeof(std::uint64_t) * 8];
+			while(::read(driver_.wakeup_fd[0], buf, sizeof buf) > 0);
+
+			driver_.signaled = false;
+		}
+
+		void _m_signal_driver()
+		{
+#if defined(NANA_LINUX)
+			std::uint64_t count = 1;
+			auto bytes = ::write(driver_.wakeup_fd[1], &count, sizeof count);
+#else
+			char count = 1;
+			auto bytes = ::write(driver_.wakeup_fd[1], &count, sizeof count);
+#endif
+			static_cast<void>(bytes);	//The descriptor is already readable if it fails.
+		}
+
+		void _m_stop_driver()
+		{
+			is_work_ = false;
+			_m_signal_driver();
+			thrd_->join();
+			driver_.signaled = false;
+		}
+
+		static bool& _m_is_driver()
+		{
+			static thread_local bool in_driver_thread = false;
+			return in_driver_thread;
+		}
 	private:
 		static Window _m_event_window(const XEvent& event)
 		{
@@ -247,105 +519,206 @@ namespace detail
 				return _m_event_window(pack.u.xevent);
 			case msg_packet_tag::kind_mouse_drop:
 				return pack.u.mouse_drop.window;
+			case msg_packet_tag::kind_flush_frame:
+				return pack.u.packet_window;
 			default:
 				break;
 			}
 			return 0;
 		}
 
+		const std::shared_ptr<const lookup_table>& _m_table() const
+		{
+			return table_.snapshot;
+		}
+
+		//_m_publish
+		//@brief: Replaces the tables, it must be called with table_.mutex locked.
+		void _m_publish(std::shared_ptr<lookup_table> table)
+		{
+			std::atomic_store(&table_.snapshot, std::shared_ptr<const lookup_table>(std::move(table)));
+			table_.version.fetch_add(1, std::memory_order_release);
+		}
+
 		void _m_msg_dispatch(const msg_packet_tag &msg)
 		{
-			std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
-			auto i = table_.wnd_table.find(_m_window(msg));
-			if(i != table_.wnd_table.end())
+			//The driver keeps a snapshot of the tables and reloads it only when they are modified,
+			//finding the thread of a window takes no lock.
+			auto version = table_.version.load(std::memory_order_acquire);
+			if((!driver_.table) || (version != driver_.version))
+			{
+				driver_.table = std::atomic_load(&table_.snapshot);
+				driver_.version = version;
+			}
+
+			const auto wd = _m_window(msg);
+			auto i = driver_.table->wnd_table.find(wd);
+			if(i != driver_.table->wnd_table.end())
 			{
-				thread_binder * const thr = i->second;
+				auto & thr = i->second;
 				
 				std::lock_guard<decltype(thr->mutex)> lock(thr->mutex);
-				thr->msg_queue.push_back(msg);
+
+				//The window may be erased after the snapshot is loaded.
+				if(0 == thr->window.count(wd))
+					return;
+
+				if(!_m_coalesce(thr->msg_queue, msg))
+					thr->msg_queue.push_back(msg);
 				thr->cond.notify_one();
 			}
 		}
 
+		//_m_coalesce
+		//@brief: Folds the msg into a msg which is still waiting in the queue. A MotionNotify replaces
+		//	the last msg if it is a MotionNotify of the same window and button state, and an Expose is
+		//	united into the pending Expose of the same window if no other event of the window is queued
+		//	behind that Expose, so a burst of these events is processed with one layout and one paint.
+		//@return: true if the msg is folded, it should not be pushed into the queue.
+		bool _m_coalesce(msg_queue_type& queue, const msg_packet_tag& msg)
+		{
+			if(queue.empty() || (msg.kind != msg.kind_xevent))
+				return false;
+
+			auto & evt = msg.u.xevent;
+			if(MotionNotify == evt.type)
+			{
+				auto & last = queue.back();
+				if((last.kind == last.kind_xevent) && (MotionNotify == last.u.xevent.type) &&
+					(last.u.xevent.xmotion.window == evt.xmotion.window) &&
+					(last.u.xevent.xmotion.state == evt.xmotion.state))
+				{
+					last.u.xevent = evt;
+					++stats_.motion;
+					return true;
+				}
+			}
+			else if(Expose == evt.type)
+			{
+				for(auto pos = queue.size(); pos != 0; --pos)
+				{
+					auto & queued = queue[pos - 1];
+					auto const queued_window = (queued.kind == queued.kind_xevent ? queued.u.xevent.xany.window : queued.u.packet_window);
+					if(queued_window != evt.xexpose.window)
+						continue;
+
+					//The Expose can't be moved across another event of the window, such as a ConfigureNotify,
+					//otherwise it would be painted against a stale geometry.
+					if((queued.kind != queued.kind_xevent) || (Expose != queued.u.xevent.type))
+						break;
+
+					auto & pending = queued.u.xevent.xexpose;
+					int right = (std::max)(pending.x + pending.width, evt.xexpose.x + evt.xexpose.width);
+					int bottom = (std::max)(pending.y + pending.height, evt.xexpose.y + evt.xexpose.height);
+					pending.x = (std::min)(pending.x, evt.xexpose.x);
+					pending.y = (std::min)(pending.y, evt.xexpose.y);
+					pending.width = right - pending.x;
+					pending.height = bottom - pending.y;
+					pending.count = evt.xexpose.count;
+					++stats_.expose;
+					return true;
+				}
+			}
+			return false;
+		}
+
 		//_m_read_queue
 		//@brief:Read the event from a specified thread queue.
 		//@return: 0 = exit the queue, 1 = fetch the msg, -1 = no msg
-		int _m_read_queue(unsigned tid, msg_packet_tag& msg, Window modal)
+		int _m_read_queue(thread_binder& thr, msg_packet_tag& msg, Window modal)
 		{
-			bool stop_driver = false;
-
 			{
-				std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
-				//Find the thread whether it is registered for the window.
-				auto i = table_.thr_table.find(tid);
-				if(i != table_.thr_table.end())
+				std::lock_guard<decltype(thr.mutex)> lock(thr.mutex);
+				if(thr.window.size())
 				{
-					if(i->second->window.size())
-					{
-						msg_queue_type & queue = i->second->msg_queue;
-						if(queue.size())
-						{
-							msg = queue.front();
-							queue.pop_front();
+					if(thr.msg_queue.empty())
+						return -1;
 
-							//Check whether the event dispatcher is used for the modal window
-							//and when the modal window is closing, the event dispatcher would
-							//stop event pumping.
-							if((modal == msg.u.packet_window) && (msg.kind == msg.kind_cleanup))
-								return 0;
+					thr.msg_queue.pop_front(msg);
 
-							return 1;
-						}
-						else
-							return -1;
-					}
+					//Check whether the event dispatcher is used for the modal window
+					//and when the modal window is closing, the event dispatcher would
+					//stop event pumping.
+					if((modal == msg.u.packet_window) && (msg.kind == msg.kind_cleanup))
+						return 0;
+
+					return 1;
+				}
+			}
 
-					delete i->second;
-					table_.thr_table.erase(i);
-					stop_driver = (table_.thr_table.size() == 0);
+			//All windows of the thread are closed, unregister the thread.
+			bool stop_driver = false;
+			{
+				std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
+				auto & current = _m_table();
+				auto i = current->thr_table.find(thr.tid);
+				if((i != current->thr_table.end()) && (i->second.get() == &thr))
+				{
+					auto table = std::make_shared<lookup_table>(*current);
+					table->thr_table.erase(thr.tid);
+					stop_driver = table->thr_table.empty();
+					_m_publish(std::move(table));
 				}
 			}
-			if(stop_driver)
+			if(stop_driver && thrd_)
 			{
-				is_work_ = false;
-				thrd_->join();
+				_m_stop_driver();
 				thrd_.reset();
 			}
 			return 0;
 		}
 
 		//_m_wait_for_queue
-		//	wait for the insertion of queue.
-		//return@ it returns true if the queue is not empty, otherwise the wait is timeout.
-		bool _m_wait_for_queue(unsigned tid)
+		//	wait for the insertion of queue, or the closing of the last window of the thread.
+		//@param timeout: the number of milliseconds to wait, no_timer waits without a timeout.
+		void _m_wait_for_queue(thread_binder& thr, std::size_t timeout)
 		{
-			thread_binder * thr = nullptr;
+			//Sends the buffered requests before sleeping, nobody flushes them periodically.
 			{
-				std::lock_guard<decltype(table_.mutex)> lock(table_.mutex);
-				auto i = table_.thr_table.find(tid);
-				if(i != table_.thr_table.end())
-				{
-					if(i->second->msg_queue.size())
-						return true;
-					thr = i->second;
-				}
+				nana::detail::platform_scope_guard lock;
+				::XFlush(display_);
 			}
-			
-			//Waits for notifying the condition variable, it indicates a new msg is pushing into the queue.
-			std::unique_lock<decltype(thr->mutex)> lock(thr->mutex);
-			return (thr->cond.wait_for(lock, std::chrono::milliseconds(10)) != std::cv_status::timeout);
+
+			//The queue and the window set are checked with thr->mutex locked, the writers lock
+			//it as well, so a notification can't be missed between the check and the wait.
+			auto ready = [&thr]{
+				return (!thr.msg_queue.empty()) || thr.window.empty() || thr.timers_changed;
+			};
+
+			std::unique_lock<decltype(thr.mutex)> lock(thr.mutex);
+			if(no_timer == timeout)
+				thr.cond.wait(lock, ready);
+			else
+				thr.cond.wait_for(lock, std::chrono::milliseconds(timeout), ready);
+
+			//The timers are run again before next waiting, they return the new timeout.
+			thr.timers_changed = false;
 		}
 		
 	private:
 		Display * display_;
-		volatile bool is_work_{ false };
+		std::atomic<bool> is_work_{ false };
 		std::unique_ptr<std::thread> thrd_;
+		coalescing_stats stats_;
+
+		struct driver_tag
+		{
+			int wakeup_fd[2]{ -1, -1 };	//[0] for read, [1] for write. They are same eventfd under Linux
+#if defined(NANA_LINUX)
+			int epoll_fd{ -1 };
+#endif
+			std::atomic<bool> signaled{ false };
+
+			//The snapshot of tables used by the driver thread
+			std::shared_ptr<const lookup_table> table;
+			unsigned version{ 0 };
+		}driver_;
 
 		struct table_tag
 		{
-			std::recursive_mutex mutex;
-			std::map<unsigned, thread_binder*> thr_table;
-			std::map<Window, thread_binder*> wnd_table;
+			std::recursive_mutex mutex;	//It serializes the modifications of the tables.
+			std::shared_ptr<const lookup_table> snapshot{ std::make_shared<lookup_table>() };
+			std::atomic<unsigned> version{ 0 };
 		}table_;
 
 		struct proc_tag
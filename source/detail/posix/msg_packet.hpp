@@ -10,7 +10,7 @@ namespace detail
 {
 	struct msg_packet_tag
 	{
-		enum kind_t{kind_xevent, kind_mouse_drop, kind_cleanup};
+		enum kind_t{kind_xevent, kind_mouse_drop, kind_cleanup, kind_flush_frame};
 		kind_t kind;
 		union
 		{
@@ -97,6 +97,26 @@ namespace detail
 		XftDraw * xftdraw{nullptr};
 		XftColor	xft_fgcolor;
 		const std::string charset(const std::wstring& str, const std::string& strcode);
+
+		//The glyphs which are drawn between graphics::glyph_run_begin() and glyph_run_end(). The consecutive
+		//glyphs in a color make a group, and the groups are rendered in the drawing order with a request per
+		//group when the run ends, the font is changed or the drawable is painted by another operation.
+		struct glyph_run_tag
+		{
+			struct group
+			{
+				XftColor color;
+				std::vector<XftGlyphFontSpec> glyphs;
+			};
+
+			unsigned depth{ 0 };	//The nesting count of glyph_run_begin()
+			bool pending{ false };
+			std::vector<group> groups;	//The groups are kept after flushing, for reusing their buffers.
+			std::size_t used{ 0 };		//The number of groups in use.
+			std::vector<unsigned> advances;
+		}glyph_run;
+
+		void flush_glyph_run();
 #endif
 		drawable_impl_type();
 		~drawable_impl_type();
@@ -186,7 +206,7 @@ namespace detail
 	public:
 		int error_code;
 	public:
-		typedef void (*timer_proc_type)(unsigned tid);
+		typedef std::size_t (*timer_proc_type)(unsigned tid);
 		typedef void (*event_proc_type)(Display*, msg_packet_tag&);
 		typedef ::nana::event_code		event_code;
 		typedef ::nana::native_window_type	native_window_type;
@@ -235,13 +255,20 @@ namespace detail
 		Window grab(Window);
 		void set_timer(std::size_t id, std::size_t interval, void (*timer_proc)(std::size_t id));
 		void kill_timer(std::size_t id);
-		void timer_proc(unsigned tid);
+		std::size_t timer_proc(unsigned tid);	//returns the milliseconds before the next timer is due
 
 		//Message dispatcher
 		void msg_insert(native_window_type);
+
+		/// Queues a msg packet for the thread of the packet window, it can be called by any thread.
+		void msg_post(const msg_packet_tag&);
 		void msg_set(timer_proc_type, event_proc_type);
 		void msg_dispatch(native_window_type modal);
 
+		//Returns the number of MotionNotify and Expose events that are folded by the msg dispatcher
+		std::size_t msg_coalesced_motions() const;
+		std::size_t msg_coalesced_exposes() const;
+
 		//X Selections
 		void* request_selection(native_window_type requester, Atom type, size_t & bufsize);
 		void write_selection(native_window_type owner, Atom type, const void* buf, size_t bufsize);
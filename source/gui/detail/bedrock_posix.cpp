@@ -19,6 +19,7 @@
 #include <nana/gui/detail/native_window_interface.hpp>
 #include <nana/gui/layout_utility.hpp>
 #include <nana/gui/detail/element_store.hpp>
+#include <nana/gui/detail/damage_region.hpp>
 #include <errno.h>
 #include <algorithm>
 
@@ -99,7 +100,7 @@ namespace detail
 		}cache;
 	};
 
-	void timer_proc(unsigned);
+	std::size_t timer_proc(unsigned);
 	void window_proc_dispatcher(Display*, nana::detail::msg_packet_tag&);
 	void window_proc_for_packet(Display *, nana::detail::msg_packet_tag&);
 	void window_proc_for_xevent(Display*, XEvent&);
@@ -132,9 +133,17 @@ namespace detail
 		delete impl_;
 	}
 
-	void bedrock::flush_surface(core_window_t* wd, bool forced, const rectangle* update_area)
+	void bedrock::flush_surface(core_window_t* wd, bool forced, const damage_region* damage)
 	{
-		wd->drawer.map(reinterpret_cast<window>(wd), forced, update_area);
+		wd->drawer.map(reinterpret_cast<window>(wd), forced, damage);
+	}
+
+	void bedrock::post_frame(core_window_t* root_wd)
+	{
+		nana::detail::msg_packet_tag msg;
+		msg.kind = msg.kind_flush_frame;
+		msg.u.packet_window = reinterpret_cast<Window>(root_wd->root);
+		nana::detail::platform_spec::instance().msg_post(msg);
 	}
 
 	//inc_window
@@ -343,9 +352,9 @@ namespace detail
 		
 	}
 
-	void timer_proc(unsigned tid)
+	std::size_t timer_proc(unsigned tid)
 	{
-		nana::detail::platform_spec::instance().timer_proc(tid);
+		return nana::detail::platform_spec::instance().timer_proc(tid);
 	}
 
 	void window_proc_dispatcher(Display* display, nana::detail::msg_packet_tag& msg)
@@ -358,6 +367,14 @@ namespace detail
 		case nana::detail::msg_packet_tag::kind_mouse_drop:
 			window_proc_for_packet(display, msg);
 			break;
+		case nana::detail::msg_packet_tag::kind_flush_frame:
+			{
+				auto & wd_manager = detail::bedrock::instance().wd_manager();
+				auto root_wd = wd_manager.root(reinterpret_cast<native_window_type>(msg.u.packet_window));
+				if (root_wd)
+					wd_manager.flush_frame(root_wd);
+			}
+			break;
 		default: break;
 		}
 	}
@@ -824,7 +841,10 @@ namespace detail
 					//Don't copy root_graph to the window directly, otherwise the edge nimbus effect will be missed.
 					::nana::rectangle update_area(xevent.xexpose.x, xevent.xexpose.y, xevent.xexpose.width, xevent.xexpose.height);
 					if (!update_area.empty())
-						msgwnd->drawer.map(reinterpret_cast<window>(msgwnd), true, &update_area);
+					{
+						damage_region damage{ update_area };
+						msgwnd->drawer.map(reinterpret_cast<window>(msgwnd), true, &damage);
+					}
 				}
 				break;
 			case KeyPress:
@@ -25,6 +25,7 @@
 #include <nana/gui/layout_utility.hpp>
 #include <nana/gui/detail/element_store.hpp>
 #include <nana/gui/detail/color_schemes.hpp>
+#include <nana/gui/detail/damage_region.hpp>
 
 #include <iostream>	//use std::cerr
 
@@ -309,28 +310,45 @@ namespace detail
 		return bedrock_object;
 	}
 
-	void bedrock::flush_surface(core_window_t* wd, bool forced, const rectangle* update_area)
+	void bedrock::post_frame(core_window_t* root_wd)
+	{
+		::PostMessage(reinterpret_cast<HWND>(root_wd->root), nana::detail::messages::flush_frame, 0, 0);
+	}
+
+	void bedrock::flush_surface(core_window_t* wd, bool forced, const damage_region* damage)
 	{
 		if (nana::system::this_thread_id() != wd->thread_id)
 		{
-			auto stru = reinterpret_cast<detail::messages::map_thread*>(::HeapAlloc(::GetProcessHeap(), 0, sizeof(detail::messages::map_thread)));
-			if (stru)
+			auto post = [wd, forced](const rectangle* update_area)
 			{
-				stru->forced = forced;
-				stru->ignore_update_area = true;
-
-				if (update_area)
+				auto stru = reinterpret_cast<detail::messages::map_thread*>(::HeapAlloc(::GetProcessHeap(), 0, sizeof(detail::messages::map_thread)));
+				if (stru)
 				{
-					stru->ignore_update_area = false;
-					stru->update_area = *update_area;
+					stru->forced = forced;
+					stru->ignore_update_area = true;
+
+					if (update_area)
+					{
+						stru->ignore_update_area = false;
+						stru->update_area = *update_area;
+					}
+
+					if (FALSE == ::PostMessage(reinterpret_cast<HWND>(wd->root), nana::detail::messages::remote_flush_surface, reinterpret_cast<WPARAM>(wd), reinterpret_cast<LPARAM>(stru)))
+						::HeapFree(::GetProcessHeap(), 0, stru);
 				}
+			};
 
-				if (FALSE == ::PostMessage(reinterpret_cast<HWND>(wd->root), nana::detail::messages::remote_flush_surface, reinterpret_cast<WPARAM>(wd), reinterpret_cast<LPARAM>(stru)))
-					::HeapFree(::GetProcessHeap(), 0, stru);
+			//A message carries a rectangle, the damaged rectangles are posted separately.
+			if (damage)
+			{
+				for (auto & r : damage->rectangles())
+					post(&r);
 			}
+			else
+				post(nullptr);
 		}
 		else
-			wd->drawer.map(reinterpret_cast<window>(wd), forced, update_area);
+			wd->drawer.map(reinterpret_cast<window>(wd), forced, damage);
 	}
 
 	void interior_helper_for_menu(MSG& msg, native_window_type menu_window)
@@ -601,6 +619,13 @@ namespace detail
 				::HeapFree(::GetProcessHeap(), 0, stru);
 			}
 			return true;
+		case nana::detail::messages::flush_frame:
+			{
+				auto root_wd = bedrock.wd_manager().root(reinterpret_cast<native_window_type>(wd));
+				if (root_wd)
+					bedrock.wd_manager().flush_frame(root_wd);
+			}
+			return true;
 		case nana::detail::messages::remote_thread_move_window:
 			{
 				auto * mw = reinterpret_cast<nana::detail::messages::move_window*>(wParam);
@@ -1307,7 +1332,10 @@ namespace detail
 						//Don't copy root_graph to the window directly, otherwise the edge nimbus effect will be missed.
 						::nana::rectangle update_area(ps.rcPaint.left, ps.rcPaint.top, ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top);
 						if (!update_area.empty())
-							msgwnd->drawer.map(reinterpret_cast<window>(msgwnd), true, &update_area);
+						{
+							damage_region damage{ update_area };
+							msgwnd->drawer.map(reinterpret_cast<window>(msgwnd), true, &damage);
+						}
 					}
 					::EndPaint(root_window, &ps);
 			    }
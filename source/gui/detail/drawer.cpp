@@ -259,7 +259,7 @@ namespace nana
 			_m_emit(event_code::shortkey, arg, &drawer_trigger::shortkey);
 		}
 
-		void drawer::map(window wd, bool forced, const rectangle* update_area)	//Copy the root buffer to screen
+		void drawer::map(window wd, bool forced, const damage_region* damage)	//Copy the root buffer to screen
 		{
 			if(wd)
 			{
@@ -279,7 +279,7 @@ namespace nana
 #endif
 				}
 
-				edge_nimbus_renderer_t::instance().render(iwd, forced, update_area);
+				edge_nimbus_renderer_t::instance().render(iwd, forced, damage);
 
 				if(owns_caret)
 				{
@@ -297,9 +297,17 @@ namespace nana
 			if (data_impl_->realizer && !data_impl_->refreshing)
 			{
 				data_impl_->refreshing = true;
-				data_impl_->realizer->refresh(graphics);
-				_m_effect_bground_subsequent();
-				graphics.flush();
+				try
+				{
+					data_impl_->realizer->refresh(graphics);
+					_m_effect_bground_subsequent();
+					graphics.flush();
+				}
+				catch (...)
+				{
+					data_impl_->refreshing = false;
+					throw;
+				}
 				data_impl_->refreshing = false;
 			}
 		}
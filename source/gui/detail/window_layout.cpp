@@ -14,6 +14,7 @@
 #include <nana/gui/detail/window_layout.hpp>
 #include <nana/gui/detail/basic_window.hpp>
 #include <nana/gui/detail/native_window_interface.hpp>
+#include <nana/gui/detail/damage_region.hpp>
 #include <nana/gui/layout_utility.hpp>
 #include <algorithm>
 
@@ -22,7 +23,7 @@ namespace nana
 	namespace detail
 	{
 		//class window_layout
-			void window_layout::paint(core_window_t* wd, paint_operation operation, bool req_refresh_children)
+			void window_layout::paint(core_window_t* wd, paint_operation operation, bool req_refresh_children, const damage_region* damage)
 			{
 				if (wd->flags.refreshing && (paint_operation::try_refresh == operation))
 					return;
@@ -31,17 +32,15 @@ namespace nana
 				{
 					if ((paint_operation::try_refresh == operation) && (!wd->drawer.graphics.empty()))
 					{
-						wd->flags.refreshing = true;
-						wd->drawer.refresh();
-						wd->flags.refreshing = false;
+						_m_refresh(wd);
 					}
-					maproot(wd, (paint_operation::none != operation), req_refresh_children);
+					maproot(wd, (paint_operation::none != operation), req_refresh_children, damage);
 				}
 				else
 					_m_paint_glass_window(wd, (paint_operation::try_refresh == operation), req_refresh_children, false, true);
 			}
 
-			bool window_layout::maproot(core_window_t* wd, bool have_refreshed, bool req_refresh_children)
+			bool window_layout::maproot(core_window_t* wd, bool have_refreshed, bool req_refresh_children, const damage_region* damage)
 			{
 				auto check_opaque = wd->seek_non_lite_widget_ancestor();
 				if (check_opaque && check_opaque->flags.refreshing)
@@ -50,50 +49,40 @@ namespace nana
 				nana::rectangle vr;
 				if (read_visual_rectangle(wd, vr))
 				{
-					//get the root graphics
-					auto& graph = *(wd->root_graph);
-
-					if (category::flags::lite_widget != wd->other.category)
-						graph.bitblt(vr, wd->drawer.graphics, nana::point(vr.x - wd->pos_root.x, vr.y - wd->pos_root.y));
-
-					_m_paste_children(wd, have_refreshed, req_refresh_children, vr, graph, nana::point());
-
-					if (wd->parent)
+					//The children would be refreshed for each damaged rectangle, so the region is ignored if they are requested to be refreshed.
+					if (damage && !req_refresh_children)
 					{
-						std::vector<wd_rectangle>	blocks;
-						if (read_overlaps(wd, vr, blocks))
+						nana::rectangle r;
+						for (auto & dr : damage->rectangles())
 						{
-							nana::point p_src;
-							for (auto & el : blocks)
-							{
-#ifndef WIDGET_FRAME_DEPRECATED
-								if (category::flags::frame == el.window->other.category)
-								{
-									native_window_type container = el.window->other.attribute.frame->container;
-									native_interface::refresh_window(container);
-									graph.bitblt(el.r, container);
-								}
-								else
-#endif
-								{
-									p_src.x = el.r.x - el.window->pos_root.x;
-									p_src.y = el.r.y - el.window->pos_root.y;
-									graph.bitblt(el.r, (el.window->drawer.graphics), p_src);
-								}
-
-								_m_paste_children(el.window, false, req_refresh_children, el.r, graph, nana::point{});
-							}
+							if (overlap(dr, vr, r))
+								_m_maproot(wd, have_refreshed, false, r);
 						}
 					}
+					else
+						_m_maproot(wd, have_refreshed, req_refresh_children, vr);
+
 					_m_notify_glasses(wd);
 					return true;
 				}
 				return false;
 			}
 
-			void window_layout::paste_children_to_graphics(core_window_t* wd, nana::paint::graphics& graph)
+			void window_layout::paste_children_to_graphics(core_window_t* wd, nana::paint::graphics& graph, const damage_region* damage)
 			{
-				_m_paste_children(wd, false, false, rectangle{ wd->pos_root, wd->dimension }, graph, wd->pos_root);
+				const rectangle r_of_wd{ wd->pos_root, wd->dimension };
+				if (nullptr == damage)
+				{
+					_m_paste_children(wd, false, false, r_of_wd, graph, wd->pos_root);
+					return;
+				}
+
+				nana::rectangle r;
+				for (auto & dr : damage->rectangles())
+				{
+					if (overlap(dr, r_of_wd, r))
+						_m_paste_children(wd, false, false, r, graph, wd->pos_root);
+				}
 			}
 
 			//read_visual_rectangle
@@ -266,6 +255,61 @@ namespace nana
 					wd->effect.bground->take_effect(reinterpret_cast<window>(wd), glass_buffer);
 			}
 
+			void window_layout::_m_refresh(core_window_t* wd)
+			{
+				//The flag is cleared even if the drawer throws, otherwise the window would never be refreshed again.
+				wd->flags.refreshing = true;
+				try
+				{
+					wd->drawer.refresh();
+				}
+				catch (...)
+				{
+					wd->flags.refreshing = false;
+					throw;
+				}
+				wd->flags.refreshing = false;
+			}
+
+			void window_layout::_m_maproot(core_window_t* wd, bool have_refreshed, bool req_refresh_children, const nana::rectangle& vr)
+			{
+				//get the root graphics
+				auto& graph = *(wd->root_graph);
+
+				if (category::flags::lite_widget != wd->other.category)
+					graph.bitblt(vr, wd->drawer.graphics, nana::point(vr.x - wd->pos_root.x, vr.y - wd->pos_root.y));
+
+				_m_paste_children(wd, have_refreshed, req_refresh_children, vr, graph, nana::point());
+
+				if (wd->parent)
+				{
+					std::vector<wd_rectangle>	blocks;
+					if (read_overlaps(wd, vr, blocks))
+					{
+						nana::point p_src;
+						for (auto & el : blocks)
+						{
+#ifndef WIDGET_FRAME_DEPRECATED
+							if (category::flags::frame == el.window->other.category)
+							{
+								native_window_type container = el.window->other.attribute.frame->container;
+								native_interface::refresh_window(container);
+								graph.bitblt(el.r, container);
+							}
+							else
+#endif
+							{
+								p_src.x = el.r.x - el.window->pos_root.x;
+								p_src.y = el.r.y - el.window->pos_root.y;
+								graph.bitblt(el.r, (el.window->drawer.graphics), p_src);
+							}
+
+							_m_paste_children(el.window, false, req_refresh_children, el.r, graph, nana::point{});
+						}
+					}
+				}
+			}
+
 			//_m_paste_children
 			//@brief:paste children window to the root graphics directly. just paste the visual rectangle
 			void window_layout::_m_paste_children(core_window_t* wd, bool have_refreshed, bool req_refresh_children, const nana::rectangle& parent_rect, nana::paint::graphics& graph, const nana::point& graph_rpos)
@@ -293,9 +337,7 @@ namespace nana
 								if (req_refresh_children && (false == child->flags.refreshing))
 								{
 									have_child_refreshed = true;
-									child->flags.refreshing = true;
-									child->drawer.refresh();
-									child->flags.refreshing = false;
+									_m_refresh(child);
 								}
 
 								graph.bitblt(nana::rectangle(rect.x - graph_rpos.x, rect.y - graph_rpos.y, rect.width, rect.height),
@@ -333,9 +375,7 @@ namespace nana
 							wd->flags.make_bground_declared = false;
 						}
 
-						wd->flags.refreshing = true;
-						wd->drawer.refresh();
-						wd->flags.refreshing = false;
+						_m_refresh(wd);
 					}
 
 					auto & root_graph = *(wd->root_graph);
@@ -21,15 +21,22 @@
 #include <nana/gui/detail/inner_fwd_implement.hpp>
 #include <nana/gui/layout_utility.hpp>
 #include <nana/gui/detail/effects_renderer.hpp>
+#include <nana/gui/detail/damage_region.hpp>
 
 #include <stdexcept>
 #include <algorithm>
 #include <iterator>
+#include <chrono>
+#include <map>
 
 #if defined(STD_THREAD_NOT_SUPPORTED)
 #include <nana/std_mutex.hpp>
+#include <nana/std_thread.hpp>
+#include <nana/std_condition_variable.hpp>
 #else
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 #endif
 
 namespace nana
@@ -267,6 +274,43 @@ namespace detail
 				}
 			};
 			
+			//struct refresh_scheduler
+			//The refreshes which are requested out of the event procedures are coalesced into frames, a root window
+			//is mapped at most once in a frame interval. The pending windows are guarded by the mutex of window_manager,
+			//and the deadline for the frame thread is guarded by the mutex of scheduler. The frame thread doesn't paint,
+			//it asks the thread of a root window to flush the frame when the frame is due.
+			struct refresh_scheduler
+			{
+				using clock = std::chrono::steady_clock;
+
+				struct damage
+				{
+					bool redraw{ false };
+					bool whole{ false };	//The whole visual rectangle of the window is damaged.
+					damage_region area;		//The damaged area in the root coordinate if it is not whole.
+				};
+
+				struct frame
+				{
+					clock::time_point next;	//The earliest time of next frame.
+					bool posted{ false };	//The thread of the root window is asked to flush the frame.
+					std::map<basic_window*, damage> windows;
+				};
+
+				clock::duration interval{ std::chrono::microseconds(1000000 / 60) };
+				std::map<basic_window*, frame> roots;
+
+				std::size_t frames{ 0 };
+				std::size_t skipped{ 0 };
+
+				std::mutex mutex;
+				std::condition_variable cond;
+				clock::time_point deadline{ clock::time_point::max() };
+				bool stop{ false };
+				std::thread thread;
+			};
+			//end struct refresh_scheduler
+
 			//struct wdm_private_impl
 			struct window_manager::wdm_private_impl
 			{
@@ -277,6 +321,8 @@ namespace detail
 				paint::image default_icon_small;
 
 				lite_map<core_window_t*, std::vector<std::function<void()>>> safe_place;
+
+				refresh_scheduler scheduler;
 			};
 		//end struct wdm_private_impl
 
@@ -446,6 +492,16 @@ namespace detail
 
 		window_manager::~window_manager()
 		{
+			auto & sch = impl_->scheduler;
+			{
+				std::lock_guard<std::mutex> lock(sch.mutex);
+				sch.stop = true;
+				sch.cond.notify_one();
+			}
+
+			if (sch.thread.joinable())
+				sch.thread.join();
+
 			delete impl_;
 		}
 
@@ -1051,26 +1107,23 @@ namespace detail
 		//Copy the root buffer that wnd specified into DeviceContext
 		void window_manager::map(core_window_t* wd, bool forced, const rectangle* update_area)
 		{
-			//Thread-Safe Required!
-			std::lock_guard<mutex_type> lock(mutex_);
-			if (impl_->wd_register.available(wd) && !wd->is_draw_through())
-			{
-				auto parent = wd->parent;
-				while (parent)
-				{
-					if (parent->flags.refreshing)
-						return;
-					parent = parent->parent;
-				}
+			if (update_area)
+				this->map(wd, forced, damage_region{ *update_area });
+			else
+				_m_map(wd, forced, nullptr);
+		}
 
-				bedrock::instance().flush_surface(wd, forced, update_area);
-			}
+		//Copy the damaged rectangles of the root buffer into DeviceContext
+		void window_manager::map(core_window_t* wd, bool forced, const damage_region& damage)
+		{
+			_m_map(wd, forced, &damage);
 		}
 
 		//update
 		//@brief:	update is used for displaying the screen-off buffer.
 		//			Because of a good efficiency, if it is called in an event procedure and the event procedure window is the
-		//			same as update's, update would not map the screen-off buffer and just set the window for lazy refresh
+		//			same as update's, update would not map the screen-off buffer and just set the window for lazy refresh.
+		//			If it is not forced, the refreshes are coalesced and displayed at most once in a frame interval
 		bool window_manager::update(core_window_t* wd, bool redraw, bool forced, const rectangle* update_area)
 		{
 			//Thread-Safe Required!
@@ -1085,8 +1138,20 @@ namespace detail
 				{
 					if (!wd->flags.refreshing)
 					{
-						window_layer::paint(wd, (redraw ? paint_operation::try_refresh : paint_operation::none), false);
-						this->map(wd, forced, update_area);
+						if ((!forced) && _m_defer(wd, redraw, update_area))
+							return true;
+
+						if (update_area)
+						{
+							damage_region damage{ *update_area };
+							window_layer::paint(wd, (redraw ? paint_operation::try_refresh : paint_operation::none), false, &damage);
+							this->map(wd, forced, damage);
+						}
+						else
+						{
+							window_layer::paint(wd, (redraw ? paint_operation::try_refresh : paint_operation::none), false);
+							this->map(wd, forced);
+						}
 						return true;
 					}
 					else if (forced)
@@ -1151,6 +1216,77 @@ namespace detail
 			return;
 		}
 
+		//frame_rate
+		//@brief: Sets the maximum number of frames per second for the coalesced refreshes, 0 disables the coalescence and
+		//	the pending refreshes are displayed immediately. A rate above a frame per microsecond is treated as 0.
+		void window_manager::frame_rate(unsigned fps)
+		{
+			//Thread-Safe Required!
+			std::lock_guard<mutex_type> lock(mutex_);
+
+			auto & sch = impl_->scheduler;
+			auto const us = (fps ? 1000000 / fps : 0);
+			if (us)
+			{
+				sch.interval = std::chrono::duration_cast<refresh_scheduler::clock::duration>(std::chrono::microseconds(us));
+				return;
+			}
+
+			sch.interval = refresh_scheduler::clock::duration::zero();
+			_m_flush_frames();
+		}
+
+		unsigned window_manager::frame_rate() const
+		{
+			//Thread-Safe Required!
+			std::lock_guard<mutex_type> lock(mutex_);
+
+			auto const us = std::chrono::duration_cast<std::chrono::microseconds>(impl_->scheduler.interval).count();
+			return (us ? static_cast<unsigned>(1000000 / us) : 0);
+		}
+
+		//flush_refresh
+		//@brief: Displays the pending refreshes immediately, regardless of the frame rate.
+		void window_manager::flush_refresh()
+		{
+			//Thread-Safe Required!
+			std::lock_guard<mutex_type> lock(mutex_);
+			_m_flush_frames();
+		}
+
+		//flush_frame
+		//@brief: Displays the pending refreshes of a root window if its frame is due. It is called by the thread of the
+		//	root window when the frame thread asks it to flush the frame.
+		void window_manager::flush_frame(core_window_t* root_wd)
+		{
+			//Thread-Safe Required!
+			std::lock_guard<mutex_type> lock(mutex_);
+
+			auto & roots = impl_->scheduler.roots;
+			auto i = roots.find(root_wd);
+			if (i == roots.end())
+				return;
+
+			i->second.posted = false;
+			if (i->second.windows.empty())
+				return;
+
+			//The frame may be flushed by another refresh after it was posted.
+			if (refresh_scheduler::clock::now() >= i->second.next)
+				_m_flush_frame(root_wd);
+			else
+				_m_schedule(i->second.next);
+		}
+
+		window_manager::refresh_statistics window_manager::refresh_stats() const
+		{
+			//Thread-Safe Required!
+			std::lock_guard<mutex_type> lock(mutex_);
+
+			auto & sch = impl_->scheduler;
+			return{ sch.frames, sch.skipped };
+		}
+
 		//get_graphics
 		//@brief: Get a copy of the graphics object of a window.
 		//	the copy of the graphics object has a same buf handle with the graphics object's, they are count-refered
@@ -1849,6 +1985,17 @@ namespace detail
 			}
 #endif
 
+			//Removes the pending refreshes of the window
+			auto & roots = impl_->scheduler.roots;
+			if (wd->root_widget == wd)
+				roots.erase(wd);
+			else
+			{
+				auto i = roots.find(wd->root_widget);
+				if (i != roots.end())
+					i->second.windows.erase(wd);
+			}
+
 			if(wd->other.category != category::flags::root)	//Not a root window
 				impl_->wd_register.remove(wd);
 		}
@@ -1916,6 +2063,234 @@ namespace detail
 			if(wd == nullptr || false == wd->visible)	return false;
 			return rectangle{ wd->pos_root, wd->dimension }.is_hit(root_pos);
 		}
+
+		void window_manager::_m_map(core_window_t* wd, bool forced, const damage_region* damage)
+		{
+			//Thread-Safe Required!
+			std::lock_guard<mutex_type> lock(mutex_);
+			if (impl_->wd_register.available(wd) && !wd->is_draw_through())
+			{
+				auto parent = wd->parent;
+				while (parent)
+				{
+					if (parent->flags.refreshing)
+						return;
+					parent = parent->parent;
+				}
+
+				bedrock::instance().flush_surface(wd, forced, damage);
+			}
+		}
+
+		//_m_defer
+		//@brief: Puts the window into the pending refreshes of its root. The pending refreshes are displayed immediately
+		//	if the frame of the root is due, otherwise they are displayed by the thread of the root when the frame
+		//	thread posts the frame. Returns false if the refresh can't be deferred.
+		bool window_manager::_m_defer(core_window_t* wd, bool redraw, const rectangle* update_area)
+		{
+			auto & sch = impl_->scheduler;
+			if ((refresh_scheduler::clock::duration::zero() == sch.interval) || wd->is_draw_through())
+				return false;
+
+			auto & frm = sch.roots[wd->root_widget];
+
+			auto i = frm.windows.find(wd);
+			if (i == frm.windows.end())
+			{
+				i = frm.windows.emplace(wd, refresh_scheduler::damage{}).first;
+				i->second.whole = (nullptr == update_area);
+				if (update_area)
+					i->second.area.add(*update_area);
+			}
+			else
+			{
+				++sch.skipped;
+
+				if (!update_area)
+				{
+					i->second.whole = true;
+					i->second.area.clear();
+				}
+				else if (!i->second.whole)
+					i->second.area.add(*update_area);
+			}
+			i->second.redraw |= redraw;
+
+			if (refresh_scheduler::clock::now() >= frm.next)
+			{
+				_m_flush_frame(wd->root_widget);
+				return true;
+			}
+
+			if (!frm.posted)
+				_m_schedule(frm.next);
+			return true;
+		}
+
+		//_m_schedule
+		//@brief: Wakes the frame thread up at the specified time, the frame thread is started at first time.
+		void window_manager::_m_schedule(std::chrono::steady_clock::time_point due)
+		{
+			auto & sch = impl_->scheduler;
+
+			std::lock_guard<std::mutex> lock(sch.mutex);
+			if (!sch.thread.joinable())
+				sch.thread = std::thread([this]{ _m_frame_proc(); });
+
+			if (due < sch.deadline)
+			{
+				sch.deadline = due;
+				sch.cond.notify_one();
+			}
+		}
+
+		//_m_flush_frame
+		//@brief: Paints the pending windows of a root, only the damaged areas are recomposed, and the damage region
+		//	of the root is mapped at once.
+		void window_manager::_m_flush_frame(core_window_t* root_wd)
+		{
+			using paint_operation = window_layer::paint_operation;
+
+			auto & frm = impl_->scheduler.roots[root_wd];
+
+			std::map<core_window_t*, refresh_scheduler::damage> windows;
+			windows.swap(frm.windows);
+
+			frm.next = refresh_scheduler::clock::now() + impl_->scheduler.interval;
+			++impl_->scheduler.frames;
+
+			damage_region damage;
+			for (auto & pending : windows)
+			{
+				auto wd = pending.first;
+				if (!(impl_->wd_register.available(wd) && wd->displayed()))
+					continue;
+
+				if (wd->flags.refreshing)
+				{
+					if (wd->other.upd_state == core_window_t::update_state::lazy)
+						wd->other.upd_state = core_window_t::update_state::refreshed;
+					continue;
+				}
+
+				auto const area = (pending.second.whole ? nullptr : &pending.second.area);
+
+				window_layer::paint(wd, (pending.second.redraw ? paint_operation::try_refresh : paint_operation::none), false, area);
+
+				//The edge nimbus is rendered on the screen, it would be erased by a damaged rectangle which covers it.
+				//And the window may be moved to another root since it was deferred.
+				if ((effects::edge_nimbus::none != wd->effect.edge_nimbus) || (wd->root_widget != root_wd))
+				{
+					if (area)
+						this->map(wd, false, *area);
+					else
+						this->map(wd, false);
+					continue;
+				}
+
+				rectangle r;
+				if (!window_layer::read_visual_rectangle(wd, r))
+					continue;
+
+				if (area)
+				{
+					damage_region clipped{ *area };
+					clipped.clip(r);
+					damage.add(clipped);
+				}
+				else
+					damage.add(r);
+			}
+
+			if (!damage.empty())
+				this->map(root_wd, false, damage);
+		}
+
+		//_m_flush_frames
+		//@brief: Flushes all of the pending frames by the calling thread.
+		void window_manager::_m_flush_frames()
+		{
+			for (auto i = impl_->scheduler.roots.begin(); i != impl_->scheduler.roots.end(); ++i)
+			{
+				if (!i->second.windows.empty())
+					_m_flush_frame(i->first);
+			}
+		}
+
+		//_m_post_frames
+		//@brief: Asks the threads of the root windows to flush their frames which are due, it is called by the frame
+		//	thread. Returns the earliest time of the frames which are not due.
+		std::chrono::steady_clock::time_point window_manager::_m_post_frames()
+		{
+			auto earliest = refresh_scheduler::clock::time_point::max();
+			auto const now = refresh_scheduler::clock::now();
+
+			for (auto i = impl_->scheduler.roots.begin(); i != impl_->scheduler.roots.end();)
+			{
+				auto & frm = i->second;
+				if (frm.windows.empty())
+				{
+					//The frame is removed when it is not going to limit the next refresh.
+					if (frm.next <= now)
+					{
+						i = impl_->scheduler.roots.erase(i);
+						continue;
+					}
+				}
+				else if (frm.next <= now)
+				{
+					if (!frm.posted)
+					{
+						frm.posted = true;
+						bedrock::instance().post_frame(i->first);
+					}
+				}
+				else if (!frm.posted)
+					earliest = (std::min)(earliest, frm.next);
+				++i;
+			}
+			return earliest;
+		}
+
+		//_m_frame_proc
+		//@brief: The procedure of frame thread, it asks the threads of the root windows to display the deferred refreshes
+		//	when their frames are due. The refreshes are displayed by the threads of root windows, because the drawers and
+		//	the native windows are only accessed by their own threads.
+		void window_manager::_m_frame_proc()
+		{
+			auto & sch = impl_->scheduler;
+
+			std::unique_lock<std::mutex> lock(sch.mutex);
+			while (!sch.stop)
+			{
+				if (refresh_scheduler::clock::time_point::max() == sch.deadline)
+				{
+					sch.cond.wait(lock);
+					continue;
+				}
+
+				if (refresh_scheduler::clock::now() < sch.deadline)
+				{
+					sch.cond.wait_until(lock, sch.deadline);
+					continue;
+				}
+
+				sch.deadline = refresh_scheduler::clock::time_point::max();
+
+				//The mutex of window_manager is locked before the mutex of scheduler, as same as _m_defer().
+				lock.unlock();
+				{
+					std::lock_guard<mutex_type> wdm_lock(mutex_);
+
+					auto const earliest = _m_post_frames();
+
+					lock.lock();
+					sch.deadline = (std::min)(sch.deadline, earliest);
+					lock.unlock();
+				}
+				lock.lock();
+			}
+		}
 	//end class window_manager
 }//end namespace detail
 }//end namespace nana
@@ -867,6 +867,19 @@ namespace API
 		restrict::wd_manager().update(reinterpret_cast<basic_window*>(wd), true, false);
 	}
 
+	void refresh_window(window wd, const rectangle& area)
+	{
+		auto iwd = reinterpret_cast<basic_window*>(wd);
+		internal_scope_guard lock;
+		if (restrict::wd_manager().available(iwd))
+		{
+			//The update area is in the root coordinate.
+			rectangle update_area{ area };
+			update_area.position(area.position() + iwd->pos_root);
+			restrict::wd_manager().update(iwd, true, false, &update_area);
+		}
+	}
+
 	void refresh_window_tree(window wd)
 	{
 		restrict::wd_manager().refresh_tree(reinterpret_cast<basic_window*>(wd));
@@ -879,6 +892,27 @@ namespace API
 		restrict::wd_manager().update(reinterpret_cast<basic_window*>(wd), false, true);
 	}
 
+	void refresh_rate(unsigned fps)
+	{
+		restrict::wd_manager().frame_rate(fps);
+	}
+
+	unsigned refresh_rate()
+	{
+		return restrict::wd_manager().frame_rate();
+	}
+
+	void flush_refresh()
+	{
+		restrict::wd_manager().flush_refresh();
+	}
+
+	refresh_statistics refresh_stats()
+	{
+		auto const stats = restrict::wd_manager().refresh_stats();
+		return{ stats.frames, stats.skipped };
+	}
+
 
 	void window_caption(window wd, const std::string& title_utf8)
 	{
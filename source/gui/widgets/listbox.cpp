@@ -20,6 +20,7 @@
 
 #include <nana/gui/widgets/listbox.hpp>
 #include <nana/gui/widgets/panel.hpp>	//for inline widget
+#include <nana/gui/widgets/skeletons/text_piece_table.hpp>	//for text_file_view
 
 #include <nana/gui/layout_utility.hpp>
 #include <nana/gui/element.hpp>
@@ -27,12 +28,22 @@
 #include <nana/system/dataexch.hpp>
 #include <nana/system/platform.hpp>
 #include "skeletons/content_view.hpp"
+#include "skeletons/parallel_sort.hpp"
+#include "skeletons/delimited_text.hpp"
 
 #include <algorithm>
 #include <list>
 #include <deque>
 #include <stdexcept>
 #include <map>
+#include <unordered_map>
+#include <locale>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <cstdint>
+#include <limits>
 
 namespace nana
 {
@@ -134,6 +145,7 @@ namespace nana
 
 					std::function<bool(const std::string&, nana::any*, const std::string&, nana::any*, bool reverse)> weak_ordering;
 
+					::nana::drawerbase::listbox::sort_key sort_key{ ::nana::drawerbase::listbox::sort_key::text };
 
 					column() = default;
 					
@@ -150,6 +162,7 @@ namespace nana
 							index = other.index;
 							alignment = other.alignment;
 							weak_ordering = other.weak_ordering;
+							sort_key = other.sort_key;
 						}
 						return *this;
 					
@@ -163,6 +176,7 @@ namespace nana
 						index(other.index),
 						alignment(other.alignment),
 						weak_ordering(std::move(other.weak_ordering)),
+						sort_key(other.sort_key),
 						ess_(other.ess_)
 					{
 					}
@@ -262,19 +276,19 @@ namespace nana
 					return idx;
 				}
 
-				std::string to_string(const export_options& exp_opt) const
+				void export_to(const export_options& exp_opt, widgets::skeletons::delimited_writer& writer) const
 				{
-					std::string head_str;
 					bool first{true};
 					for( size_type idx{}; idx<exp_opt.columns_order.size(); ++idx)
 					{
 						if(first)
 							first=false;
 						else
-							head_str += exp_opt.sep;
-						head_str += this->at(exp_opt.columns_order[idx]).text();
+							writer.write(exp_opt.sep);
+
+						auto const text = this->at(exp_opt.columns_order[idx]).text();
+						writer.field(text.data(), text.size());
 					}
-					return head_str;
 				}
 
 				bool visible() const noexcept
@@ -565,100 +579,766 @@ namespace nana
 			};
 
 
-			struct item_data
+			//The texts of cells are stored by columns. A column keeps the texts in an arena and an item locates its text by
+			//a span, so an item doesn't allocate memory for its cells. A modified text which is longer than the old one is
+			//appended to the arena, and the arena is compacted when the most part of it is replaced texts.
+			class cell_store
 			{
-				using container = std::vector<cell>;
+				struct span
+				{
+					std::size_t offset;		//It is npos if the item doesn't have the cell.
+					std::size_t length;
+				};
 
-				std::unique_ptr<container> cells;
-				nana::color bgcolor;
-				nana::color fgcolor;
-				paint::image img;
-				nana::size img_show_size;
+				struct column
+				{
+					std::string arena;
+					std::vector<span> spans;
+					std::size_t garbage{ 0 };	//The bytes of the texts which are replaced or erased.
+				};
+			public:
+				std::size_t size() const noexcept
+				{
+					return size_;
+				}
 
-				struct inner_flags
+				/// Returns the number of cells of an item, the cells of an item are contiguous from the first column.
+				std::size_t cells(std::size_t pos) const noexcept
 				{
-					bool selected	:1;
-					bool checked	:1;
-				}flags;
+					std::size_t n = 0;
+					while ((n < columns_.size()) && (npos != columns_[n].spans[pos].offset))
+						++n;
+					return n;
+				}
 
-				mutable std::unique_ptr<nana::any> anyobj;
+				/// Returns the text of a cell, the text is empty if the cell doesn't exist.
+				std::string text(std::size_t pos, std::size_t col) const
+				{
+					std::size_t len;
+					auto p = data(pos, col, len);
+					return (p ? std::string(p, len) : std::string{});
+				}
 
-				item_data() noexcept
+				const char* data(std::size_t pos, std::size_t col, std::size_t& len) const noexcept
 				{
-					flags.selected = flags.checked = false;
+					len = 0;
+					if (col >= columns_.size())
+						return nullptr;
+
+					auto & c = columns_[col];
+					auto & sp = c.spans[pos];
+					if (npos == sp.offset)
+						return nullptr;
+
+					len = sp.length;
+					return c.arena.data() + sp.offset;
 				}
 
-				item_data(const item_data& r)
-					:	cells(r.cells ? std::make_unique<container>(*r.cells) : nullptr),
-						bgcolor(r.bgcolor),
-						fgcolor(r.fgcolor),
-						img(r.img),
-						flags(r.flags),
-						anyobj(r.anyobj ? new nana::any(*r.anyobj) : nullptr)
-				{}
+				/// Compares the texts of two items in a column, a cell which doesn't exist is treated as an empty text.
+				int compare(std::size_t x, std::size_t y, std::size_t col) const noexcept
+				{
+					std::size_t lx, ly;
+					auto px = data(x, col, lx);
+					auto py = data(y, col, ly);
+
+					auto r = std::char_traits<char>::compare(px, py, (std::min)(lx, ly));
+					if (r)
+						return r;
+					return (lx < ly ? -1 : (lx > ly ? 1 : 0));
+				}
+
+				/// Inserts items without cells.
+				void insert(std::size_t pos, std::size_t n)
+				{
+					for (auto & c : columns_)
+						c.spans.insert(c.spans.begin() + pos, n, span{ npos, 0 });
+					size_ += n;
+				}
+
+				void erase(std::size_t pos)
+				{
+					for (auto & c : columns_)
+					{
+						if (npos != c.spans[pos].offset)
+							c.garbage += c.spans[pos].length;
+						c.spans.erase(c.spans.begin() + pos);
+						_m_compact(c);
+					}
+					--size_;
+				}
+
+				void clear() noexcept
+				{
+					columns_.clear();
+					size_ = 0;
+				}
+
+				/// Assigns the text of a cell, the missing cells before it are assigned with empty texts.
+				void assign(std::size_t pos, std::size_t col, const std::string& text)
+				{
+					while (columns_.size() <= col)
+					{
+						columns_.emplace_back();
+						columns_.back().spans.resize(size_, span{ npos, 0 });
+					}
+
+					for (std::size_t i = 0; i < col; ++i)
+					{
+						auto & sp = columns_[i].spans[pos];
+						if (npos == sp.offset)
+							sp = span{ columns_[i].arena.size(), 0 };
+					}
+
+					auto & c = columns_[col];
+					auto & sp = c.spans[pos];
+					if (npos != sp.offset)
+					{
+						if (text.size() <= sp.length)
+						{
+							c.garbage += sp.length - text.size();
+							std::char_traits<char>::copy(&c.arena[sp.offset], text.data(), text.size());
+							sp.length = text.size();
+							return;
+						}
+						c.garbage += sp.length;
+					}
+
+					sp = span{ c.arena.size(), text.size() };
+					c.arena += text;
+					_m_compact(c);
+				}
+
+				/// Appends items, the texts of an item are specified in the order of columns and the texts beyond the
+				/// max_columns are ignored. The arenas are reserved at once, the texts are copied without allocations.
+				void append(const std::vector<std::vector<std::string>>& rows, std::size_t max_columns)
+				{
+					std::size_t columns = 0;
+					for (auto & row : rows)
+						columns = (std::max)(columns, (std::min)(row.size(), max_columns));
+
+					while (columns_.size() < columns)
+					{
+						columns_.emplace_back();
+						columns_.back().spans.resize(size_, span{ npos, 0 });
+					}
+
+					for (std::size_t i = 0; i < columns_.size(); ++i)
+					{
+						auto & c = columns_[i];
+
+						std::size_t bytes = 0;
+						for (auto & row : rows)
+						{
+							if (i < (std::min)(row.size(), max_columns))
+								bytes += row[i].size();
+						}
+
+						c.arena.reserve(c.arena.size() + bytes);
+						c.spans.reserve(size_ + rows.size());
+
+						for (auto & row : rows)
+						{
+							if (i < (std::min)(row.size(), max_columns))
+							{
+								c.spans.push_back(span{ c.arena.size(), row[i].size() });
+								c.arena.append(row[i]);
+							}
+							else
+								c.spans.push_back(span{ npos, 0 });
+						}
+					}
+					size_ += rows.size();
+				}
+
+				/// Appends items which are parsed from delimited text, the fields beyond the max_columns are ignored. The text
+				/// is parsed by chunks in parallel twice, the first pass measures the fields, and the second pass unescapes
+				/// the fields into the arenas which are resized at once. Returns the number of appended items.
+				std::size_t import(const char* begin, const char* end, const widgets::skeletons::delimited_format& fmt, std::size_t max_columns)
+				{
+					namespace skeletons = widgets::skeletons;
+					static const std::size_t chunk_bytes = 0x100000;
+
+					auto const hardware_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+					auto const bounds = skeletons::split_rows(begin, end, fmt, (std::min)(std::size_t(hardware_threads) * 4, static_cast<std::size_t>(end - begin) / chunk_bytes + 1));
+					auto const chunks = bounds.size() - 1;
+
+					struct chunk_info
+					{
+						std::size_t rows;
+						std::vector<std::size_t> bytes;	//The bytes of each column, they are replaced with the offsets in the arenas.
+					};
+
+					std::vector<chunk_info> infos(chunks);
+					skeletons::parallel_for(chunks, [&](std::size_t i)
+					{
+						auto & info = infos[i];
+						info.rows = skeletons::parse_rows(bounds[i], bounds[i + 1], fmt, [&info, max_columns](std::size_t, std::size_t col, const char* text, std::size_t len, bool escaped)
+						{
+							if (col >= max_columns)
+								return;
+
+							if (col >= info.bytes.size())
+								info.bytes.resize(col + 1);
+							info.bytes[col] += skeletons::unescape(text, len, escaped, nullptr);
+						});
+					});
+
+					std::size_t rows = 0;
+					std::size_t columns = 0;
+					for (auto & info : infos)
+					{
+						rows += info.rows;
+						columns = (std::max)(columns, info.bytes.size());
+					}
+
+					while (columns_.size() < columns)
+					{
+						columns_.emplace_back();
+						columns_.back().spans.resize(size_, span{ npos, 0 });
+					}
+
+					std::vector<std::size_t> offsets;
+					for (auto & c : columns_)
+						offsets.push_back(c.arena.size());
+
+					for (auto & info : infos)
+					{
+						for (std::size_t col = 0; col < info.bytes.size(); ++col)
+						{
+							auto const bytes = info.bytes[col];
+							info.bytes[col] = offsets[col];
+							offsets[col] += bytes;
+						}
+					}
+
+					std::vector<char*> arenas;
+					for (std::size_t col = 0; col < columns_.size(); ++col)
+					{
+						auto & c = columns_[col];
+						c.arena.resize(offsets[col]);
+						c.spans.resize(size_ + rows, span{ npos, 0 });
+						arenas.push_back(c.arena.empty() ? nullptr : &c.arena[0]);
+					}
+
+					std::vector<std::size_t> first_rows;
+					for (std::size_t i = 0, first = size_; i < chunks; ++i)
+					{
+						first_rows.push_back(first);
+						first += infos[i].rows;
+					}
+
+					skeletons::parallel_for(chunks, [&](std::size_t i)
+					{
+						auto & offs = infos[i].bytes;
+						auto const first_row = first_rows[i];
+						skeletons::parse_rows(bounds[i], bounds[i + 1], fmt, [this, &offs, &arenas, first_row, max_columns](std::size_t row, std::size_t col, const char* text, std::size_t len, bool escaped)
+						{
+							if (col >= max_columns)
+								return;
+
+							auto const n = skeletons::unescape(text, len, escaped, arenas[col] + offs[col]);
+							columns_[col].spans[first_row + row] = span{ offs[col], n };
+							offs[col] += n;
+						});
+					});
+
+					size_ += rows;
+					return rows;
+				}
+			private:
+				static void _m_compact(column& c)
+				{
+					if ((c.garbage < 4096) || (c.garbage < c.arena.size() / 2))
+						return;
+
+					std::string arena;
+					arena.reserve(c.arena.size() - c.garbage);
+					for (auto & sp : c.spans)
+					{
+						if (npos != sp.offset)
+						{
+							auto const offset = arena.size();
+							arena.append(c.arena, sp.offset, sp.length);
+							sp.offset = offset;
+						}
+					}
+					c.arena.swap(arena);
+					c.garbage = 0;
+				}
+			private:
+				std::vector<column> columns_;
+				std::size_t size_{ 0 };
+			};
+
+			//The selected or checked states of the items of a category. The states are kept as the bits of words, and the
+			//number of the set bits is counted. The bits behind the words are unset, so an appended item doesn't need a bit.
+			class item_states
+			{
+				using word = std::uint64_t;
+				static const std::size_t word_bits = 64;
+			public:
+				std::size_t count() const noexcept
+				{
+					return count_;
+				}
+
+				bool test(std::size_t pos) const noexcept
+				{
+					auto const i = pos / word_bits;
+					return ((i < words_.size()) && ((words_[i] >> (pos % word_bits)) & 1));
+				}
+
+				/// Sets the state of an item, returns true if it is changed.
+				bool set(std::size_t pos, bool value)
+				{
+					if (test(pos) == value)
+						return false;
+
+					auto const i = pos / word_bits;
+					if (i >= words_.size())
+						words_.resize(i + 1);
+
+					words_[i] ^= (word(1) << (pos % word_bits));
+					if (value)
+						++count_;
+					else
+						--count_;
+					return true;
+				}
+
+				/// Sets the states of the items in [0, n), the bits of the positions which are not less than n must be unset.
+				void set_all(std::size_t n, bool value)
+				{
+					words_.clear();
+					count_ = 0;
+					if (value)
+					{
+						words_.assign(n / word_bits, ~word(0));
+						if (n % word_bits)
+							words_.push_back((word(1) << (n % word_bits)) - 1);
+						count_ = n;
+					}
+				}
+
+				/// Inverts the states of the items in [0, n), the bits of the positions which are not less than n must be unset.
+				void flip_all(std::size_t n)
+				{
+					words_.resize((n + word_bits - 1) / word_bits);
+					for (auto & w : words_)
+						w = ~w;
+
+					if (n % word_bits)
+						words_.back() &= ((word(1) << (n % word_bits)) - 1);
+
+					count_ = n - count_;
+				}
+
+				/// Inserts an unset state at the position, the states behind it are moved backward.
+				void insert(std::size_t pos)
+				{
+					auto i = pos / word_bits;
+					if (i >= words_.size())
+						return;
+
+					if (words_.back() >> (word_bits - 1))
+						words_.push_back(0);
+
+					auto const low = (word(1) << (pos % word_bits)) - 1;
+					auto carry = words_[i] >> (word_bits - 1);
+					words_[i] = (words_[i] & low) | ((words_[i] & ~low) << 1);
+
+					while (++i < words_.size())
+					{
+						auto const next = words_[i] >> (word_bits - 1);
+						words_[i] = (words_[i] << 1) | carry;
+						carry = next;
+					}
+				}
+
+				/// Erases the state at the position, the states behind it are moved forward.
+				void erase(std::size_t pos)
+				{
+					auto i = pos / word_bits;
+					if (i >= words_.size())
+						return;
+
+					if (test(pos))
+						--count_;
+
+					auto const low = (word(1) << (pos % word_bits)) - 1;
+					words_[i] = (words_[i] & low) | ((words_[i] >> 1) & ~low);
 
-				item_data(container&& cont)
-					: cells(std::make_unique<container>(std::move(cont)))
+					while (++i < words_.size())
+					{
+						words_[i - 1] |= (words_[i] << (word_bits - 1));
+						words_[i] >>= 1;
+					}
+				}
+
+				/// Unsets the states of the items whose positions are not less than n.
+				void truncate(std::size_t n)
+				{
+					std::size_t removed = 0;
+					for_each([&removed, n](std::size_t pos)
+					{
+						if (pos >= n)
+							++removed;
+					}, n / word_bits);
+
+					words_.resize((std::min)(words_.size(), (n + word_bits - 1) / word_bits));
+					if ((n % word_bits) && (words_.size() * word_bits > n))
+						words_.back() &= ((word(1) << (n % word_bits)) - 1);
+
+					count_ -= removed;
+				}
+
+				void clear() noexcept
 				{
-					flags.selected = flags.checked = false;
+					words_.clear();
+					count_ = 0;
 				}
 
-				item_data(std::string&& s)
-					: cells(std::make_unique<container>())
+				/// Returns the position of the first state which is not less than pos and equals to the value. It returns npos if
+				/// a set state is not found, and an unset state is always found because the states behind the words are unset.
+				std::size_t find(std::size_t pos, bool value = true) const noexcept
 				{
-					flags.selected = flags.checked = false;
-					cells->emplace_back(std::move(s));
+					for (auto i = pos / word_bits; i < words_.size(); ++i)
+					{
+						auto w = (value ? words_[i] : ~words_[i]);
+						if (i == pos / word_bits)
+							w &= ~((word(1) << (pos % word_bits)) - 1);
+
+						if (w)
+							return i * word_bits + _m_lowest(w);
+					}
+					return (value ? npos : (std::max)(pos, words_.size() * word_bits));
 				}
 
+				/// Calls fn(pos) for each set state in ascending order, the words before the first_word are skipped.
+				template<typename Function>
+				void for_each(Function fn, std::size_t first_word = 0) const
+				{
+					for (auto i = first_word; i < words_.size(); ++i)
+					{
+						for (auto w = words_[i]; w; w &= w - 1)
+							fn(i * word_bits + _m_lowest(w));
+					}
+				}
+			private:
+				//Returns the index of the lowest set bit.
+				static std::size_t _m_lowest(word w) noexcept
+				{
+					static const unsigned char debruijn_index[64] = {
+						0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+						62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+						63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+						46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+					};
+					return debruijn_index[((w & (~w + 1)) * 0x03f79d71b4cb0a89ULL) >> 58];
+				}
+			private:
+				std::vector<word> words_;
+				std::size_t count_{ 0 };
+			};
+
+			//The cells of an item are stored by the cell_store of its category, the rarely used attributes are
+			//allocated when one of them is set.
+			struct item_data
+			{
+				struct attributes
+				{
+					nana::color bgcolor;
+					nana::color fgcolor;
+					paint::image img;
+					nana::size img_show_size;
+					std::unique_ptr<nana::any> anyobj;
+					std::vector<std::pair<std::size_t, cell::format>> formats;	//The custom formats of cells.
+
+					attributes() = default;
+
+					attributes(const attributes& r)
+						:	bgcolor(r.bgcolor),
+							fgcolor(r.fgcolor),
+							img(r.img),
+							img_show_size(r.img_show_size),
+							anyobj(r.anyobj ? new nana::any(*r.anyobj) : nullptr),
+							formats(r.formats)
+					{}
+				};
+
+				mutable std::unique_ptr<attributes> attrs;
+
+				item_data() noexcept = default;
+
+				item_data(const item_data& r)
+					:	attrs(r.attrs ? new attributes(*r.attrs) : nullptr)
+				{}
+
+				item_data(item_data&&) = default;
+
 				item_data& operator=(const item_data& r)
 				{
 					if (this != &r)
 					{
-						if (r.cells)
-							cells = std::make_unique<container>(*r.cells);
-
-						flags = r.flags;
-						anyobj.reset(r.anyobj ? new nana::any(*r.anyobj) : nullptr);
-						bgcolor = r.bgcolor;
-						fgcolor = r.fgcolor;
-						img = r.img;
+						attrs.reset(r.attrs ? new attributes(*r.attrs) : nullptr);
 					}
 					return *this;
 				}
 
-				std::string to_string(const export_options& exp_opt, const std::vector<cell>* model_cells) const
+				item_data& operator=(item_data&&) = default;
+
+				/// Returns the attributes, they are allocated if the item doesn't have them.
+				attributes& attr() const
+				{
+					if (!attrs)
+						attrs.reset(new attributes);
+					return *attrs;
+				}
+
+				nana::color bgcolor() const
 				{
-					std::string item_str;
+					return (attrs ? attrs->bgcolor : nana::color{});
+				}
+
+				nana::color fgcolor() const
+				{
+					return (attrs ? attrs->fgcolor : nana::color{});
+				}
+
+				nana::any* anyobj() const noexcept
+				{
+					return (attrs ? attrs->anyobj.get() : nullptr);
+				}
+
+				/// Determines whether the item has the attributes of a new item, such item of a virtual category is not kept.
+				bool is_default() const noexcept
+				{
+					return !(attrs && (attrs->anyobj || !attrs->img.empty() || !attrs->bgcolor.invisible() || !attrs->fgcolor.invisible() || !attrs->formats.empty()));
+				}
+
+				/// Sets the custom format of a cell, the format is removed if fmt is null.
+				void format(std::size_t col, const cell::format* fmt)
+				{
+					if (!fmt && !attrs)
+						return;
+
+					auto & formats = attr().formats;
+					for (auto i = formats.begin(); i != formats.end(); ++i)
+					{
+						if (i->first == col)
+						{
+							if (fmt)
+								i->second = *fmt;
+							else
+								formats.erase(i);
+							return;
+						}
+					}
+
+					if (fmt)
+						formats.emplace_back(col, *fmt);
+				}
+			};
 
-					bool ignore_first = true;
+			class inline_indicator;
+
+			//The container of a virtual category. The cells of an item are requested from the source when they are
+			//accessed, and the recently requested items are cached in LRU order.
+			class virtual_container
+				: public container_interface
+			{
+				static const std::size_t cache_size = 256;
+
+				using cache_list = std::list<std::pair<std::size_t, std::vector<cell>>>;
+			public:
+				using source_type = std::function<std::vector<cell>(std::size_t)>;
+
+				virtual_container(std::size_t size, source_type source)
+					: size_(size), source_(std::move(source))
+				{}
 
-					for (auto col : exp_opt.columns_order)
+				void resize(std::size_t size)
+				{
+					size_ = size;
+					for (auto i = cache_.begin(); i != cache_.end();)
 					{
-						if (ignore_first)
-							ignore_first = false;
+						if (i->first >= size)
+						{
+							index_.erase(i->first);
+							i = cache_.erase(i);
+						}
 						else
-							item_str += exp_opt.sep;
+							++i;
+					}
+				}
 
-						//Use the model cells instead if model cells is avaiable
-						item_str += (model_cells ? model_cells : cells.get())->operator[](col).text;
+				void invalidate() noexcept
+				{
+					index_.clear();
+					cache_.clear();
+				}
+
+				/// Returns the cells of an item, the reference is valid until the next item is requested.
+				const std::vector<cell>& cells(std::size_t pos) const
+				{
+					auto i = index_.find(pos);
+					if (i != index_.end())
+					{
+						cache_.splice(cache_.begin(), cache_, i->second);
+						return i->second->second;
+					}
+
+					if (cache_.size() >= cache_size)
+					{
+						index_.erase(cache_.back().first);
+						cache_.pop_back();
 					}
 
-                    return item_str;
+					cache_.emplace_front(pos, (source_ ? source_(pos) : std::vector<cell>{}));
+					index_[pos] = cache_.begin();
+					return cache_.front().second;
+				}
+
+				/// Calls fn with the cells of each cached item.
+				template<typename Function>
+				void for_each_cached(Function fn) const
+				{
+					for (auto & m : cache_)
+						fn(m.second);
+				}
+
+				std::size_t size() const override
+				{
+					return size_;
+				}
+			private:
+				//The items are provided by the source, they are only changed by resize().
+				void clear() override
+				{
+					resize(0);
+				}
+
+				void erase(std::size_t) override
+				{
+					throw std::runtime_error("nana::listbox disallow to erase an item of a virtual category");
+				}
+
+				bool immutable() const override
+				{
+					return true;
+				}
+
+				void emplace(std::size_t) override
+				{
+					throw std::runtime_error("nana::listbox disallow to insert an item into a virtual category");
 				}
+
+				void emplace_back() override
+				{
+					throw std::runtime_error("nana::listbox disallow to insert an item into a virtual category");
+				}
+
+				void assign(std::size_t, const std::vector<cell>&) override
+				{
+					throw std::runtime_error("nana::listbox disallow to modify an item of a virtual category");
+				}
+
+				std::vector<cell> to_cells(std::size_t pos) const override
+				{
+					return cells(pos);
+				}
+
+				bool push_back(const const_virtual_pointer&) override
+				{
+					return false;
+				}
+
+				void * pointer() override
+				{
+					return nullptr;
+				}
+
+				const void* pointer() const override
+				{
+					return nullptr;
+				}
+			private:
+				std::size_t size_;
+				source_type source_;
+				mutable cache_list cache_;
+				mutable std::unordered_map<std::size_t, cache_list::iterator> index_;
 			};
 
-			class inline_indicator;
+			class virtual_model
+				: public model_interface
+			{
+			public:
+				virtual_model(std::size_t size, virtual_container::source_type source)
+					: container_(size, std::move(source))
+				{}
+
+				virtual_container& items() noexcept
+				{
+					return container_;
+				}
+			private:
+				//The source is only invoked by the thread of the listbox, it doesn't need a lock.
+				void lock() override {}
+				void unlock() override {}
+
+				container_interface* container() noexcept override
+				{
+					return &container_;
+				}
+
+				const container_interface* container() const noexcept override
+				{
+					return &container_;
+				}
+			private:
+				virtual_container container_;
+			};
+
+			struct category_t;
+
+			//A filter of items, the items which are not accepted are not displayed.
+			class item_filter
+			{
+			public:
+				virtual ~item_filter() = default;
+
+				/// Determines whether an item is accepted, it is invoked by threads concurrently if concurrent() returns true.
+				virtual bool accept(const category_t&, std::size_t pos) const = 0;
+
+				/// Determines whether the items of a category can be tested by threads.
+				virtual bool concurrent(const category_t&) const = 0;
+			};
 
 			struct category_t
 			{
 				using container = std::deque<item_data>;
 
 				native_string_type text;
-				std::vector<std::size_t> sorted;
+				std::vector<std::size_t> sorted;	//It is empty if the category is virtual, because the items are not sorted.
 				container items;
+				cell_store store;	//The cells of items, it is not used if the category has a model.
+
+				item_states selection;	//The selected states of items, they are kept for the items of a virtual category too.
+				item_states checks;		//The checked states of items.
 
 				std::unique_ptr<model_interface> model_ptr;
 
+				//The items of a virtual category are not stored, only the items which are not in default state are kept.
+				virtual_container* virtual_ptr{ nullptr };	//The container of model_ptr if the category is virtual.
+				std::map<std::size_t, item_data> virtual_items;
+				std::size_t virtual_compact_size{ 1024 };	//The kept items are compacted when the number of them reaches it.
+
+				//The filter is not applied to a virtual category.
+				std::shared_ptr<item_filter> filter;
+				std::vector<char> accepted;		//The test results of items, indexed by absolute positions.
+				std::vector<std::size_t> shown;	//The display order of the accepted items, it is a subsequence of sorted.
+				bool filter_dirty{ false };		//Indicates whether some inserted items are not tested.
+
 				bool expand{true};
 
 				//A cat may have a key object to identify the category
@@ -673,28 +1353,444 @@ namespace nana
 
 				bool selected() const noexcept
 				{
-					for (auto & m : items)
-					{
-						if (false == m.flags.selected)
-							return false;
-					}
-					return !items.empty();
+					return (selection.count() && (selection.count() == size()));
+				}
+
+				item_states& states(bool for_selection) noexcept
+				{
+					return (for_selection ? selection : checks);
+				}
+
+				const item_states& states(bool for_selection) const noexcept
+				{
+					return (for_selection ? selection : checks);
 				}
 
 				void make_sort_order()
 				{
 					sorted.clear();
+					if (virtual_ptr)
+						return;
+
 					for (std::size_t i = 0; i < items.size(); ++i)
 						sorted.push_back(i);
+
+					filter_sync();
+				}
+				
+				std::vector<cell> cells(size_type pos) const
+				{
+					if (model_ptr)
+						return model_ptr->container()->to_cells(pos);
+
+					check_range(pos, items.size());
+
+					std::vector<cell> result(store.cells(pos));
+					for (std::size_t col = 0; col < result.size(); ++col)
+					{
+						std::size_t len;
+						auto p = store.data(pos, col, len);
+						result[col].text.assign(p, len);
+					}
+
+					auto & m = items[pos];
+					if (m.attrs)
+					{
+						for (auto & fmt : m.attrs->formats)
+						{
+							if (fmt.first < result.size())
+								result[fmt.first].custom_format.reset(new cell::format(fmt.second));
+						}
+					}
+					return result;
+				}
+
+				/// Inserts an item with its cells, the category must not have a model.
+				void insert(std::size_t pos, std::vector<cell>&& cells)
+				{
+					items.emplace(items.begin() + pos);
+					store.insert(pos, 1);
+					selection.insert(pos);
+					checks.insert(pos);
+					filter_insert(pos);
+
+					for (std::size_t col = 0; col < cells.size(); ++col)
+						assign(pos, col, std::move(cells[col]));
+				}
+
+				/// Appends items in a batch, the category must not have a model.
+				void append(const std::vector<std::vector<std::string>>& rows, std::size_t max_columns)
+				{
+					items.resize(items.size() + rows.size());
+					store.append(rows, max_columns);
+				}
+
+				/// Appends items which are parsed from delimited text, the category must not have a model.
+				std::size_t import(const char* begin, const char* end, const widgets::skeletons::delimited_format& fmt, std::size_t max_columns)
+				{
+					auto const rows = store.import(begin, end, fmt, max_columns);
+					items.resize(items.size() + rows);
+					return rows;
+				}
+
+				/// Assigns a cell of an item, the category must not have a model.
+				void assign(std::size_t pos, std::size_t col, cell&& cl)
+				{
+					store.assign(pos, col, cl.text);
+					items[pos].format(col, cl.custom_format.get());
+				}
+
+				void erase(std::size_t pos)
+				{
+					items.erase(items.begin() + pos);
+					if (!model_ptr)
+						store.erase(pos);
+
+					selection.erase(pos);
+					checks.erase(pos);
+
+					if (pos < accepted.size())
+						accepted.erase(accepted.begin() + pos);
+				}
+
+				void clear()
+				{
+					items.clear();
+					store.clear();
+					selection.clear();
+					checks.clear();
+					virtual_items.clear();
+					sorted.clear();
+					accepted.clear();
+					shown.clear();
+					filter_dirty = false;
+				}
+
+				std::size_t size() const noexcept
+				{
+					return (virtual_ptr ? virtual_ptr->size() : items.size());
+				}
+
+				/// Returns the item at an absolute position, the item of a virtual category is kept when it is accessed.
+				item_data& at(std::size_t pos)
+				{
+					if (virtual_ptr)
+					{
+						check_range(pos, virtual_ptr->size());
+						return virtual_items[pos];
+					}
+					return items.at(pos);
+				}
+
+				const item_data& at(std::size_t pos) const
+				{
+					if (virtual_ptr)
+					{
+						check_range(pos, virtual_ptr->size());
+
+						auto i = virtual_items.find(pos);
+						if (i != virtual_items.end())
+							return i->second;
+
+						static const item_data default_item;
+						return default_item;
+					}
+					return items.at(pos);
+				}
+
+				/// Calls fn(item, pos) for each item in the order of absolute positions.
+				/// Only the items which are not in default state are visited if the category is virtual.
+				template<typename Function>
+				void for_each(Function fn)
+				{
+					if (virtual_ptr)
+					{
+						for (auto & m : virtual_items)
+							fn(m.second, m.first);
+						return;
+					}
+
+					std::size_t pos = 0;
+					for (auto & m : items)
+						fn(m, pos++);
+				}
+
+				template<typename Function>
+				void for_each(Function fn) const
+				{
+					if (virtual_ptr)
+					{
+						for (auto & m : virtual_items)
+							fn(m.second, m.first);
+						return;
+					}
+
+					std::size_t pos = 0;
+					for (auto & m : items)
+						fn(m, pos++);
+				}
+
+				/// Converts a display position to an absolute position.
+				std::size_t absolute(std::size_t display_pos) const
+				{
+					if (virtual_ptr)
+						return display_pos;
+
+					return (filter ? shown : sorted)[display_pos];
+				}
+
+				/// Returns the display order of the items, the category must not be virtual.
+				const std::vector<std::size_t>& display_order() const noexcept
+				{
+					return (filter ? shown : sorted);
+				}
+
+				/// Returns the number of the displayed items.
+				std::size_t display_size() const noexcept
+				{
+					return ((filter && !virtual_ptr) ? shown.size() : size());
+				}
+
+				/// Applies a filter to the items, the filter is removed if f is null. If narrowing is true, the filter
+				/// accepts a subset of the items accepted by the current filter, and only the shown items are tested.
+				void apply_filter(std::shared_ptr<item_filter> f, bool narrowing)
+				{
+					narrowing = (narrowing && filter && !filter_dirty && (accepted.size() == size()));
+
+					filter = std::move(f);
+					if (!filter || virtual_ptr)
+					{
+						accepted.clear();
+						shown.clear();
+						filter_dirty = false;
+						return;
+					}
+
+					//The candidates are tested in the display order, so the accepted items are in the display order.
+					std::vector<std::size_t> candidates(narrowing ? shown : sorted);
+					std::vector<char> results(candidates.size());
+
+					static const std::size_t chunk_size = 16384;
+					auto test = [this, &candidates, &results](std::size_t chunk)
+					{
+						for (auto i = chunk * chunk_size, end = (std::min)(i + chunk_size, candidates.size()); i < end; ++i)
+							results[i] = (filter->accept(*this, candidates[i]) ? 1 : 0);
+					};
+
+					auto const chunks = (candidates.size() + chunk_size - 1) / chunk_size;
+					if (filter->concurrent(*this))
+						widgets::skeletons::parallel_for(chunks, test);
+					else
+					{
+						for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+							test(chunk);
+					}
+
+					if (!narrowing)
+						accepted.assign(size(), 0);
+
+					shown.clear();
+					for (std::size_t i = 0; i < candidates.size(); ++i)
+					{
+						accepted[candidates[i]] = results[i];
+						if (results[i])
+							shown.push_back(candidates[i]);
+					}
+					filter_dirty = false;
+				}
+
+				/// Marks an inserted item as untested, the item is tested by filter_sync().
+				void filter_insert(std::size_t pos)
+				{
+					if (pos < accepted.size())
+					{
+						accepted.insert(accepted.begin() + pos, 0);
+						filter_dirty = true;
+					}
+				}
+
+				/// Tests an item again after it is modified.
+				void filter_retest(std::size_t pos)
+				{
+					if (filter && !virtual_ptr && (pos < accepted.size()))
+					{
+						auto const result = static_cast<char>(filter->accept(*this, pos) ? 1 : 0);
+						if (result != accepted[pos])
+						{
+							//The display order is rebuilt with the new result.
+							accepted[pos] = result;
+							filter_sync();
+						}
+					}
+				}
+
+				/// Synchronizes the filter with the items after they are appended, inserted, erased or sorted.
+				void filter_sync()
+				{
+					if (!filter || virtual_ptr)
+						return;
+
+					//The inserted items are not tracked, the whole items are tested again.
+					if (filter_dirty || (accepted.size() > size()))
+					{
+						apply_filter(filter, false);
+						return;
+					}
+
+					auto const tested = accepted.size();
+					accepted.resize(size(), 0);
+
+					for (auto pos = tested; pos < size(); ++pos)
+						accepted[pos] = (filter->accept(*this, pos) ? 1 : 0);
+
+					//The appended items are usually at the end of the display order, they are appended to the shown.
+					if ((tested < size()) && (sorted.size() == size()))
+					{
+						auto const first = sorted.size() - (size() - tested);
+						if (std::all_of(sorted.begin() + first, sorted.end(), [tested](std::size_t pos){ return (pos >= tested); }))
+						{
+							for (auto i = first; i < sorted.size(); ++i)
+							{
+								if (accepted[sorted[i]])
+									shown.push_back(sorted[i]);
+							}
+							return;
+						}
+					}
+
+					shown.clear();
+					for (auto pos : sorted)
+					{
+						if (accepted[pos])
+							shown.push_back(pos);
+					}
+				}
+
+				/// Removes the kept items of a virtual category which are in default state, the items are only accessed but not changed.
+				/// It is amortized by compacting the items when the number of them is doubled.
+				void compact() noexcept
+				{
+					if (virtual_items.size() < virtual_compact_size)
+						return;
+
+					for (auto i = virtual_items.begin(); i != virtual_items.end();)
+					{
+						if (i->second.is_default())
+							i = virtual_items.erase(i);
+						else
+							++i;
+					}
+
+					virtual_compact_size = (std::max)(virtual_items.size() * 2, std::size_t(1024));
+				}
+			};
+
+			//A filter by a predicate of the cells, the predicate is only invoked by the thread of the listbox.
+			class predicate_filter
+				: public item_filter
+			{
+			public:
+				using predicate = std::function<bool(const std::vector<cell>&)>;
+
+				predicate_filter(predicate pred)
+					: pred_(std::move(pred))
+				{}
+
+				bool accept(const category_t& cat, std::size_t pos) const override
+				{
+					return pred_(cat.cells(pos));
+				}
+
+				bool concurrent(const category_t&) const override
+				{
+					return false;
+				}
+			private:
+				predicate pred_;
+			};
+
+			//A filter by a text query, an item is accepted if one of the specified columns contains the query. The ASCII
+			//letters are compared case-insensitively. The items of a category without a model are tested by threads.
+			class text_filter
+				: public item_filter
+			{
+			public:
+				text_filter(const std::string& query, std::vector<std::size_t> columns)
+					: columns_(std::move(columns))
+				{
+					for (auto ch : query)
+						query_ += _m_fold(ch);
+
+					std::sort(columns_.begin(), columns_.end());
+				}
+
+				/// Determines whether this filter accepts a subset of the items accepted by the other.
+				bool narrows(const text_filter& other) const
+				{
+					return ((columns_ == other.columns_) && (query_.find(other.query_) != std::string::npos));
+				}
+
+				bool accept(const category_t& cat, std::size_t pos) const override
+				{
+					if (cat.model_ptr)
+					{
+						auto const cells = cat.cells(pos);
+						return _m_any_column(cells.size(), [&cells](std::size_t col, std::size_t& len) -> const char*
+						{
+							len = cells[col].text.size();
+							return cells[col].text.data();
+						});
+					}
+
+					return _m_any_column(cat.store.cells(pos), [&cat, pos](std::size_t col, std::size_t& len)
+					{
+						return cat.store.data(pos, col, len);
+					});
+				}
+
+				bool concurrent(const category_t& cat) const override
+				{
+					return !cat.model_ptr;
+				}
+			private:
+				static char _m_fold(char ch) noexcept
+				{
+					return (('A' <= ch && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch);
 				}
-				
-				std::vector<cell> cells(size_type pos) const
+
+				template<typename TextOf>
+				bool _m_any_column(std::size_t cells, TextOf text_of) const
 				{
-					if (model_ptr)
-						return model_ptr->container()->to_cells(pos);
+					auto contains = [this, &text_of](std::size_t col)
+					{
+						std::size_t len;
+						auto text = text_of(col, len);
+						return (text && (std::search(text, text + len, query_.begin(), query_.end(), [](char a, char b)
+						{
+							return (_m_fold(a) == b);
+						}) != text + len));
+					};
 
-					return *(items.at(pos).cells);
+					if (columns_.empty())
+					{
+						for (std::size_t col = 0; col < cells; ++col)
+						{
+							if (contains(col))
+								return true;
+						}
+						return false;
+					}
+
+					for (auto col : columns_)
+					{
+						if ((col < cells) && contains(col))
+							return true;
+					}
+					return false;
 				}
+			private:
+				std::string query_;		//The folded query
+				std::vector<std::size_t> columns_;
 			};
 
 			struct inline_pane
@@ -716,6 +1812,8 @@ namespace nana
 				std::function<std::function<bool(const ::std::string&, ::nana::any*,
 								const ::std::string&, ::nana::any*, bool reverse)>(std::size_t) > fetch_ordering_comparer;
 
+				std::function<sort_key(std::size_t)> fetch_sort_key;
+
 				struct sort_attributes
 				{
 					std::size_t	column;		///< The position of the column to be sorted
@@ -747,28 +1845,34 @@ namespace nana
 				nana::any * anyobj(const index_pair& id, bool allocate_if_empty) const
 				{
 					auto& catobj = *get(id.cat);
-					if(id.item < catobj.items.size())
+					if(id.item < catobj.size())
 					{
-						auto& item = catobj.items[id.item];
+						auto& item = catobj.at(id.item);
 
-						if(item.anyobj)
-							return item.anyobj.get();
+						if(item.anyobj())
+							return item.anyobj();
 
 						if (allocate_if_empty)
 						{
-							item.anyobj.reset(new ::nana::any);
-							return item.anyobj.get();
+							//The item of a virtual category is kept when the object is allocated.
+							auto & m = const_cast<category_t&>(catobj).at(id.item);
+							m.attr().anyobj.reset(new ::nana::any);
+							return m.anyobj();
 						}
 					}
 					return nullptr;
 				}
 
-                std::string to_string(const export_options& exp_opt) const;
+				/// Writes the items of categories in the display order.
+				void export_to(const export_options& exp_opt, widgets::skeletons::delimited_writer& writer) const;
 
-				void emit_cs(const index_pair& pos, bool for_selection)
+				/// Emits the selected or checked event. The changed_items is greater than 1 if the states of items are changed in a
+				/// batch, the pos is the first changed item.
+				void emit_cs(const index_pair& pos, bool for_selection, std::size_t changed_items = 1)
 				{
 					item_proxy i(ess_, pos);
 					arg_listbox arg{ i };
+					arg.changed_items = changed_items;
 
 					auto & events = wd_ptr()->events();
 					
@@ -778,14 +1882,13 @@ namespace nana
 						events.checked.emit(arg, wd_ptr()->handle());
 
 					//notify the inline pane. An item may have multiple panes, each pane is for a column.
+					//All the panes are notified for a batch, because they are few.
 					for (auto p : active_panes_)
 					{
-						if (p && (p->item_pos == pos))
+						if (p && ((p->item_pos == pos) || (changed_items > 1)))
 						{
-							if (for_selection)
-								p->inline_ptr->notify_status(inline_widget_status::selecting, i.selected());
-							else
-								p->inline_ptr->notify_status(inline_widget_status::checking, i.checked());
+							auto & states = get(p->item_pos.cat)->states(for_selection);
+							p->inline_ptr->notify_status((for_selection ? inline_widget_status::selecting : inline_widget_status::checking), states.test(p->item_pos.item));
 						}
 					}
 				}
@@ -804,113 +1907,70 @@ namespace nana
 					if((npos == sort_attrs_.column) || (!sort_attrs_.resort))
 						return;
 
-					auto weak_ordering_comp = fetch_ordering_comparer(sort_attrs_.column);
-					if(weak_ordering_comp)
-					{
-						for (auto & cat : categories_)
-						{
-							const bool use_model = (cat.model_ptr != nullptr);
-
-							std::stable_sort(cat.sorted.begin(), cat.sorted.end(), [&cat, &weak_ordering_comp, use_model, this](std::size_t x, std::size_t y){
-								//The predicate must be a strict weak ordering.
-								//!comp(x, y) != comp(x, y)
-								if (use_model)
-								{
-									auto & mx = cat.items[x];
-									auto & my = cat.items[y];
-
-									auto mx_cells = cat.model_ptr->container()->to_cells(x);
-									auto my_cells = cat.model_ptr->container()->to_cells(y);
-
-									if (mx_cells.size() <= sort_attrs_.column || my_cells.size() <= sort_attrs_.column)
-									{
-										std::string a;
-										if (mx_cells.size() > sort_attrs_.column)
-											a = mx_cells[sort_attrs_.column].text;
-
-										std::string b;
-										if (my_cells.size() > sort_attrs_.column)
-											b = my_cells[sort_attrs_.column].text;
+					using widgets::skeletons::adaptive_stable_sort;
 
-										return weak_ordering_comp(a, mx.anyobj.get(), b, my.anyobj.get(), sort_attrs_.reverse);
-									}
-
-									return weak_ordering_comp(mx_cells[sort_attrs_.column].text, mx.anyobj.get(), my_cells[sort_attrs_.column].text, my.anyobj.get(), sort_attrs_.reverse);
-								}
-								
-								auto & mx = cat.items[x];
-								auto & my = cat.items[y];
-
-								if (mx.cells->size() <= sort_attrs_.column || my.cells->size() <= sort_attrs_.column)
-								{
-									std::string a;
-									if (mx.cells->size() > sort_attrs_.column)
-										a = (*mx.cells)[sort_attrs_.column].text;
+					auto const col = sort_attrs_.column;
+					auto const reverse = sort_attrs_.reverse;
+					auto weak_ordering_comp = fetch_ordering_comparer(col);
+					auto const key = fetch_sort_key(col);
 
-									std::string b;
-									if (my.cells->size() > sort_attrs_.column)
-										b = (*my.cells)[sort_attrs_.column].text;
+					for (auto & cat : categories_)
+					{
+						//The items of a virtual category are ordered by its source.
+						if (cat.virtual_ptr || (cat.sorted.size() < 2))
+							continue;
 
-									return weak_ordering_comp(a, mx.anyobj.get(), b, my.anyobj.get(), sort_attrs_.reverse);
-								}
+						//The texts are extracted once for each item instead of each comparison. The texts of the store
+						//are compared in the arenas without copying them.
+						std::vector<std::string> texts;
+						if (weak_ordering_comp || cat.model_ptr || (sort_key::text != key))
+							texts = _m_sort_texts(cat, col);
 
-								return weak_ordering_comp((*mx.cells)[sort_attrs_.column].text, mx.anyobj.get(), (*my.cells)[sort_attrs_.column].text, my.anyobj.get(), sort_attrs_.reverse);
-							});
-						}
-					}
-					else
-					{	//No user-defined comparer is provided, and default comparer is applying.
-						for (auto & cat : categories_)
+						auto text_less = [&texts, reverse](std::size_t x, std::size_t y)
 						{
-							const bool use_model = (cat.model_ptr != nullptr);
+							return (reverse ? texts[x] > texts[y] : texts[x] < texts[y]);
+						};
 
-							std::stable_sort(cat.sorted.begin(), cat.sorted.end(), [this, &cat, use_model](std::size_t x, std::size_t y){
+						if (weak_ordering_comp)
+						{
+							//The user-defined comparer may not be thread-safe, it is only invoked by this thread.
+							adaptive_stable_sort(cat.sorted, [&](std::size_t x, std::size_t y)
+							{
 								//The predicate must be a strict weak ordering.
 								//!comp(x, y) != comp(x, y)
-								if (use_model)
-								{
-									auto mx_cells = cat.model_ptr->container()->to_cells(x);
-									auto my_cells = cat.model_ptr->container()->to_cells(y);
-
-									if (mx_cells.size() <= sort_attrs_.column || my_cells.size() <= sort_attrs_.column)
-									{
-										std::string a;
-										if (mx_cells.size() > sort_attrs_.column)
-											a = mx_cells[sort_attrs_.column].text;
-
-										std::string b;
-										if (my_cells.size() > sort_attrs_.column)
-											b = my_cells[sort_attrs_.column].text;
-
-										return (sort_attrs_.reverse ? a > b : a < b);
-									}
-
-									auto & a = mx_cells[sort_attrs_.column].text;
-									auto & b = my_cells[sort_attrs_.column].text;
-									return (sort_attrs_.reverse ? a > b : a < b);
-								}
-
-								auto & mx = cat.items[x];
-								auto & my = cat.items[y];
-
-								if (mx.cells->size() <= sort_attrs_.column || my.cells->size() <= sort_attrs_.column)
-								{
-									std::string a;
-									if (mx.cells->size() > sort_attrs_.column)
-										a = (*mx.cells)[sort_attrs_.column].text;
-
-									std::string b;
-									if (my.cells->size() > sort_attrs_.column)
-										b = (*my.cells)[sort_attrs_.column].text;
+								return weak_ordering_comp(texts[x], cat.items[x].anyobj(), texts[y], cat.items[y].anyobj(), reverse);
+							}, false);
+						}
+						else if (sort_key::numeric == key)
+						{
+							auto const numbers = _m_numeric_keys(texts);
+							adaptive_stable_sort(cat.sorted, [&numbers, &text_less, reverse](std::size_t x, std::size_t y)
+							{
+								auto const x_nan = std::isnan(numbers[x]);
+								auto const y_nan = std::isnan(numbers[y]);
+								if (x_nan || y_nan)
+									return ((x_nan != y_nan) ? y_nan : text_less(x, y));
 
-									return (sort_attrs_.reverse ? a > b : a < b);
-								}
+								return (reverse ? numbers[x] > numbers[y] : numbers[x] < numbers[y]);
+							}, true);
+						}
+						else if (texts.empty())
+						{
+							adaptive_stable_sort(cat.sorted, [&cat, col, reverse](std::size_t x, std::size_t y)
+							{
+								auto const r = cat.store.compare(x, y, col);
+								return (reverse ? r > 0 : r < 0);
+							}, true);
+						}
+						else
+						{
+							if (sort_key::locale == key)
+								_m_collation_keys(texts);
 
-								auto & a = (*mx.cells)[sort_attrs_.column].text;
-								auto & b = (*my.cells)[sort_attrs_.column].text;
-								return (sort_attrs_.reverse ? a > b : a < b);
-							});
+							adaptive_stable_sort(cat.sorted, text_less, true);
 						}
+
+						cat.filter_sync();
 					}
 				}
 
@@ -964,10 +2024,40 @@ namespace nana
 
 				void scroll(const index_pair& pos, bool to_bottom);
 
+				/// Applies a filter to all categories, the filter is removed if f is null.
+				void filter(std::shared_ptr<item_filter> f, bool narrowing)
+				{
+					for (auto & cat : categories_)
+						cat.apply_filter(f, narrowing);
+
+					filter_ = std::move(f);
+				}
+
+				/// Applies a text query, the current filter is narrowed if it is a text filter of a shorter query.
+				void filter(const std::string& query, std::vector<std::size_t> columns)
+				{
+					if (query.empty())
+					{
+						filter(nullptr, false);
+						return;
+					}
+
+					auto f = std::make_shared<text_filter>(query, std::move(columns));
+					auto current = dynamic_cast<const text_filter*>(filter_.get());
+					auto const narrowing = (current && f->narrows(*current));
+					filter(std::move(f), narrowing);
+				}
+
+				bool filtered() const noexcept
+				{
+					return (filter_ != nullptr);
+				}
+
 				/// Append a new category with a specified name and return a pointer to it.
 				category_t* create_cat(native_string_type&& text)
 				{
 					categories_.emplace_back(std::move(text));
+					categories_.back().filter = filter_;
 					return &categories_.back();
 				}
 
@@ -993,6 +2083,7 @@ namespace nana
 							{
 								auto & catobj = *categories_.emplace(i);
 								catobj.key_ptr = ptr;
+								catobj.filter = filter_;
 								return &catobj;
 							}
 						}
@@ -1000,13 +2091,16 @@ namespace nana
 
 					categories_.emplace_back();
 					categories_.back().key_ptr = ptr;
+					categories_.back().filter = filter_;
 					return &(categories_.back());
 				}
                 
 				/// add a new cat created at "pos" and return a ref to it
 				category_t* create_cat(std::size_t pos, native_string_type&& text)
 				{
-					return &(*categories_.emplace(this->get(pos), std::move(text)));
+					auto & catobj = *categories_.emplace(this->get(pos), std::move(text));
+					catobj.filter = filter_;
+					return &catobj;
 				}
 
 				/// Insert  before item in absolute "pos" a new item with "text" in column 0, and place it in last display position of this cat
@@ -1016,19 +2110,22 @@ namespace nana
 
 					const auto item_count = catobj.items.size();
 
+					throw_if_immutable_model(catobj.model_ptr.get());
 					check_range(pos.item, item_count);
 
 					catobj.sorted.push_back(item_count);
 
 					if (catobj.model_ptr)
 					{
-						throw_if_immutable_model(catobj.model_ptr.get());
 						auto container = catobj.model_ptr->container();
 						std::size_t item_index;
 						//
 						if (pos.item < item_count)
 						{
 							catobj.items.emplace(catobj.items.begin() + pos.item);
+							catobj.selection.insert(pos.item);
+							catobj.checks.insert(pos.item);
+							catobj.filter_insert(pos.item);
 							container->emplace(pos.item);
 							item_index = pos.item;
 						}
@@ -1043,11 +2140,15 @@ namespace nana
 						cells.emplace_back(std::move(text));
 						cells.resize(columns);
 						container->assign(item_index, cells);
-
-						return;
+					}
+					else
+					{
+						std::vector<cell> cells;
+						cells.emplace_back(std::move(text));
+						catobj.insert((pos.item < item_count ? pos.item : item_count), std::move(cells));
 					}
 
-					catobj.items.emplace(catobj.items.begin() + (pos.item < item_count ? pos.item : item_count), std::move(text));
+					catobj.filter_sync();
 				}
 
 				/// Converts an index between display position and absolute real position.
@@ -1060,15 +2161,27 @@ namespace nana
 				index_pair index_cast(const index_pair& from, bool from_display_order) const
 				{
 					auto cat = get(from.cat);
-					if (from.item < cat->sorted.size())
+					if (cat->virtual_ptr)
+					{
+						if (from.item < cat->size())
+							return from;
+					}
+					else
 					{
+						//The items which are not accepted by the filter don't have display positions.
+						auto & order = cat->display_order();
 						if (from_display_order)
-							return index_pair{ from.cat, static_cast<size_type>(cat->sorted[from.item]) };
-
-						for (size_type i = 0; i < cat->sorted.size(); ++i)
 						{
-							if (from.item == cat->sorted[i])
-								return index_pair{ from.cat, i };
+							if (from.item < order.size())
+								return index_pair{ from.cat, static_cast<size_type>(order[from.item]) };
+						}
+						else if (from.item < cat->size())
+						{
+							for (size_type i = 0; i < order.size(); ++i)
+							{
+								if (from.item == order[i])
+									return index_pair{ from.cat, i };
+							}
 						}
 					}
 					throw std::out_of_range("listbox: invalid item position");
@@ -1082,15 +2195,26 @@ namespace nana
 						std::advance(i, from.cat);
 
 						auto & cat = *i;
-						if (from.item < cat.sorted.size())
+						if (cat.virtual_ptr)
+						{
+							if (from.item < cat.size())
+								return from;
+						}
+						else
 						{
+							auto & order = cat.display_order();
 							if (from_display_order)
-								return index_pair{ from.cat, static_cast<size_type>(cat.sorted[from.item]) };
-
-							for (size_type i = 0; i < cat.sorted.size(); ++i)
 							{
-								if (from.item == cat.sorted[i])
-									return index_pair{ from.cat, i };
+								if (from.item < order.size())
+									return index_pair{ from.cat, static_cast<size_type>(order[from.item]) };
+							}
+							else
+							{
+								for (size_type i = 0; i < order.size(); ++i)
+								{
+									if (from.item == order[i])
+										return index_pair{ from.cat, i };
+								}
 							}
 						}
 					}
@@ -1138,7 +2262,7 @@ namespace nana
 
 				category_t::container::value_type& at_abs(const index_pair& pos)
 				{
-					return get(pos.cat)->items.at(pos.item);
+					return get(pos.cat)->at(pos.item);
 				}
 
 				std::vector<cell> at_model_abs(const index_pair& pos) const
@@ -1152,23 +2276,23 @@ namespace nana
 					return{};
 				}
 
-                /// return a ref to the real item object at display!!! position pos using current sorting only if it is active, and at absolute position if no sorting is currently active.
+                /// return a ref to the real item object at display!!! position pos using current sorting or filter if one of them is active, and at absolute position otherwise.
 				category_t::container::value_type& at(const index_pair& pos)
 				{
 					auto acc_pos = pos.item;
-					if (npos != sort_attrs_.column)
+					if ((npos != sort_attrs_.column) || get(pos.cat)->filter)
 						acc_pos = index_cast(pos, true).item;	//convert display position to absolute position
 
-					return get(pos.cat)->items.at(acc_pos);
+					return get(pos.cat)->at(acc_pos);
 				}
 
 				const category_t::container::value_type& at(const index_pair& pos) const
 				{
 					auto acc_pos = pos.item;
-					if (npos != sort_attrs_.column)
+					if ((npos != sort_attrs_.column) || get(pos.cat)->filter)
 						acc_pos = index_cast(pos, true).item;	//convert display position to absolute position
 
-					return get(pos.cat)->items.at(acc_pos);
+					return get(pos.cat)->at(acc_pos);
 				}
 
 				std::vector<cell> at_model(const index_pair& pos) const
@@ -1180,7 +2304,7 @@ namespace nana
 					model_lock_guard lock(model_ptr);
 
 					auto acc_pos = pos.item;
-					if (npos != sort_attrs_.column)
+					if ((npos != sort_attrs_.column) || get(pos.cat)->filter)
 						acc_pos = index_cast(pos, true).item;	//convert display position to absolute position
 
 					return model_ptr->container()->to_cells(acc_pos);
@@ -1201,7 +2325,9 @@ namespace nana
 					auto& catobj = *get(cat);
 
 					model_lock_guard lock(catobj.model_ptr.get());
-					if (catobj.model_ptr)
+					if (catobj.virtual_ptr)
+						catobj.virtual_ptr->resize(0);
+					else if (catobj.model_ptr)
 					{
 						//The immutable modal can't be cleared.
 						throw_if_immutable_model(catobj.model_ptr.get());
@@ -1209,8 +2335,7 @@ namespace nana
 						catobj.model_ptr->container()->clear();
 					}
 
-					catobj.items.clear();
-					catobj.sorted.clear();
+					catobj.clear();
 				}
 
                 // Clears all items in all cat, but not the container of cat self.
@@ -1218,7 +2343,10 @@ namespace nana
 				{
 					// Check whether there is a immutable model before performing clear.
 					for (auto & cat : categories_)
-						throw_if_immutable_model(cat.model_ptr.get());
+					{
+						if (!cat.virtual_ptr)
+							throw_if_immutable_model(cat.model_ptr.get());
+					}
 
 					for (size_type i = 0; i < categories_.size(); ++i)
 						clear(i);
@@ -1285,7 +2413,7 @@ namespace nana
 
 							--i;
 							--dpos.cat;
-							count = static_cast<int>(i->expand ? i->items.size() : 0) + 1;
+							count = static_cast<int>(i->expand ? i->display_size() : 0) + 1;
 						}
 					}
 					return index_pair{npos, npos};
@@ -1310,7 +2438,7 @@ namespace nana
 					for (auto i = get(from.cat); i != get(to.cat); ++i)
 					{
 						if (i->expand)
-							count += i->items.size() + 1;
+							count += i->display_size() + 1;
 						else
 							++count;
 					}
@@ -1328,67 +2456,74 @@ namespace nana
 
 				void text(category_t* cat, size_type pos, size_type abs_col, cell&& cl, size_type columns)
 				{
-					if ((abs_col < columns) && (pos < cat->items.size()))
+					if ((abs_col < columns) && (pos < cat->size()))
 					{
-						std::vector<cell> model_cells;
-
 						model_lock_guard lock(cat->model_ptr.get());
-						if (cat->model_ptr)
+						if (!cat->model_ptr)
 						{
-							throw_if_immutable_model(cat->model_ptr.get());
-							model_cells = cat->model_ptr->container()->to_cells(pos);
+							auto const exists = (abs_col < cat->store.cells(pos));
+							cat->assign(pos, abs_col, std::move(cl));
+							cat->filter_retest(pos);
+							if (exists && (sort_attrs_.column == abs_col))
+								sort();
+							return;
 						}
 
-						auto & cells = (cat->model_ptr ? model_cells : *(cat->items[pos].cells));
+						throw_if_immutable_model(cat->model_ptr.get());
+						auto model_cells = cat->model_ptr->container()->to_cells(pos);
 
-						if (abs_col < cells.size())
+						if (abs_col < model_cells.size())
 						{
-							cells[abs_col] = std::move(cl);
+							model_cells[abs_col] = std::move(cl);
 							if (sort_attrs_.column == abs_col)
 								sort();
 						}
 						else
 						{	//If the index of specified sub item is over the number of sub items that item contained,
 							//it fills the non-exist items.
-							cells.resize(abs_col);
-							cells.emplace_back(std::move(cl));
+							model_cells.resize(abs_col);
+							model_cells.emplace_back(std::move(cl));
 						}
 
-						if (cat->model_ptr)
-							cat->model_ptr->container()->assign(pos, model_cells);
+						cat->model_ptr->container()->assign(pos, model_cells);
+						cat->filter_retest(pos);
 					}
 				}
 
 				void text(category_t* cat, size_type pos, size_type abs_col, std::string&& str, size_type columns)
 				{
-					if ((abs_col < columns) && (pos < cat->items.size()))
+					if ((abs_col < columns) && (pos < cat->size()))
 					{
-						std::vector<cell> model_cells;
-
 						model_lock_guard lock(cat->model_ptr.get());
-						if (cat->model_ptr)
+						if (!cat->model_ptr)
 						{
-							throw_if_immutable_model(cat->model_ptr.get());
-							model_cells = cat->model_ptr->container()->to_cells(pos);
+							//The custom format of the cell is kept.
+							auto const exists = (abs_col < cat->store.cells(pos));
+							cat->store.assign(pos, abs_col, str);
+							cat->filter_retest(pos);
+							if (exists && (sort_attrs_.column == abs_col))
+								sort();
+							return;
 						}
 
-						auto & cells = (cat->model_ptr ? model_cells : *(cat->items[pos].cells));
+						throw_if_immutable_model(cat->model_ptr.get());
+						auto model_cells = cat->model_ptr->container()->to_cells(pos);
 
-						if (abs_col < cells.size())
+						if (abs_col < model_cells.size())
 						{
-							cells[abs_col].text = std::move(str);
+							model_cells[abs_col].text = std::move(str);
 							if (sort_attrs_.column == abs_col)
 								sort();
 						}
 						else
 						{	//If the index of specified sub item is over the number of sub items that item contained,
 							//it fills the non-exist items.
-							cells.resize(abs_col);
-							cells.emplace_back(std::move(str));
+							model_cells.resize(abs_col);
+							model_cells.emplace_back(std::move(str));
 						}
 
-						if (cat->model_ptr)
-							cat->model_ptr->container()->assign(pos, model_cells);
+						cat->model_ptr->container()->assign(pos, model_cells);
+						cat->filter_retest(pos);
 					}
 				}
 
@@ -1401,14 +2536,15 @@ namespace nana
 					//If the category is the first one, it just clears the items instead of removing whole category.
 					if(0 == cat)
 					{
-						if (i->model_ptr)
+						if (i->virtual_ptr)
+							i->virtual_ptr->resize(0);
+						else if (i->model_ptr)
 						{
 							throw_if_immutable_model(i->model_ptr.get());
 							i->model_ptr->container()->clear();
 						}
 
-						i->items.clear();
-						i->sorted.clear();
+						i->clear();
 					}
 					else
 						categories_.erase(i);
@@ -1501,7 +2637,7 @@ namespace nana
 					for (auto & i : categories_)
 					{
 						if(i.expand)
-							n += i.items.size();
+							n += i.display_size();
 					}
 					return n;
 				}
@@ -1519,7 +2655,8 @@ namespace nana
 						to_dpl = this->last();
 					}
 
-					auto fr_dpl = (fr_abs.is_category() ? fr_abs : this->index_cast(fr_abs, false));	//Converts an absolute position to display position
+					//Converts an absolute position to display position, the range begins at to_dpl if fr_abs is filtered out.
+					auto fr_dpl = (fr_abs.is_category() ? fr_abs : this->index_cast_noexcpt(fr_abs, false, to_dpl));
                     if (fr_dpl > to_dpl)
 						std::swap(fr_dpl, to_dpl);
 
@@ -1567,8 +2704,8 @@ namespace nana
 						//Deselects the already selected which is out of range [begin, last] 
 						for (auto index : already_selected)
 						{
-							auto disp_order = this->index_cast(index, false);	//converts an absolute position to a display position
-							if (begin > disp_order || disp_order > last)
+							auto disp_order = this->index_cast_noexcpt(index, false);	//converts an absolute position to a display position
+							if (disp_order.empty() || begin > disp_order || disp_order > last)
 								item_proxy{ ess_, index }.select(false);
 						}
 					}
@@ -1578,51 +2715,165 @@ namespace nana
 
 				bool select_for_all(bool sel, const index_pair& except = index_pair{npos, npos})
 				{
-					bool changed = false;
-					index_pair pos;
+					return status_for_all(true, sel, except);
+				}
+
+				/// Sets the selected or checked states of all the items except one, the event is emitted once for all the
+				/// changed items. Only the displayed items are changed if a filter is set. Returns true if a state is changed.
+				bool status_for_all(bool for_selection, bool value, const index_pair& except = index_pair{npos, npos})
+				{
+					index_pair first{ npos, npos };	//The first changed item
+					std::size_t changed = 0;
+
+					std::size_t cat_pos = 0;
 					for (auto & cat : categories_)
 					{
-						pos.item = 0;
-						for(auto & m : cat.items)
+						auto & states = cat.states(for_selection);
+						auto const n = cat.size();
+						auto const keep = ((except.cat == cat_pos) && (except.item < n));
+
+						if (cat.filter && !cat.virtual_ptr)
 						{
-							if (except != pos)
+							cat.filter_sync();
+
+							std::size_t last = npos;	//The last displayed item which is not kept
+							for (auto pos : cat.display_order())
 							{
-								if (m.flags.selected != sel)
+								if (keep && (pos == except.item))
+									continue;
+
+								if (states.set(pos, value))
 								{
-									changed = true;
-									m.flags.selected = sel;
+									if (first.empty())
+										first = index_pair{ cat_pos, pos };
+									++changed;
+								}
+								last = pos;
+							}
 
-									this->emit_cs(pos, true);
+							if (for_selection && value && (last != npos))
+								latest_selected_abs = index_pair{ cat_pos, last };
 
-									if (m.flags.selected)
-										latest_selected_abs = pos;
-									else if (latest_selected_abs == pos)
-										latest_selected_abs.set_both(npos);		//make empty
-								}
+							++cat_pos;
+							continue;
+						}
+
+						auto const kept = (keep && states.test(except.item));
+
+						auto count = (value ? n - states.count() : states.count());
+						if (keep && (kept != value))
+							--count;
+
+						if (count)
+						{
+							if (first.empty())
+							{
+								auto pos = states.find(0, !value);
+								if (keep && (pos == except.item))
+									pos = states.find(pos + 1, !value);
+								first = index_pair{ cat_pos, pos };
 							}
-							++pos.item;
+
+							states.set_all(n, value);
+							if (keep)
+								states.set(except.item, kept);
+
+							changed += count;
+
+							if (for_selection && value)
+							{
+								auto last = n - 1;
+								if (keep && !kept && (except.item == last))
+									--last;
+
+								if (last < n)
+									latest_selected_abs = index_pair{ cat_pos, last };
+							}
+						}
+						++cat_pos;
+					}
+
+					if (for_selection && !value && !latest_selected_abs.empty() && (latest_selected_abs.cat < categories_.size()))
+					{
+						if (!get(latest_selected_abs.cat)->selection.test(latest_selected_abs.item))
+							latest_selected_abs.set_both(npos);		//make empty
+					}
+
+					if (changed)
+						this->emit_cs(first, for_selection, changed);
+
+					return (changed != 0);
+				}
+
+				/// Inverts the selected or checked states of all the items, the event is emitted once for all the items.
+				/// Only the displayed items are inverted if a filter is set.
+				bool invert_for_all(bool for_selection)
+				{
+					index_pair first{ npos, npos };
+					std::size_t changed = 0;
+
+					std::size_t cat_pos = 0;
+					for (auto & cat : categories_)
+					{
+						auto const n = cat.size();
+						if (cat.filter && !cat.virtual_ptr)
+						{
+							cat.filter_sync();
+
+							auto & states = cat.states(for_selection);
+							auto & order = cat.display_order();
+							for (auto pos : order)
+								states.set(pos, !states.test(pos));
+
+							if (first.empty() && !order.empty())
+								first = index_pair{ cat_pos, order.front() };
+							changed += order.size();
+						}
+						else if (n)
+						{
+							cat.states(for_selection).flip_all(n);
+							if (first.empty())
+								first = index_pair{ cat_pos, 0 };
+							changed += n;
 						}
-						++pos.cat;
+						++cat_pos;
+					}
+
+					if (for_selection && !latest_selected_abs.empty() && (latest_selected_abs.cat < categories_.size()))
+					{
+						if (!get(latest_selected_abs.cat)->selection.test(latest_selected_abs.item))
+							latest_selected_abs.set_both(npos);
 					}
-					return changed;
+
+					if (changed)
+						this->emit_cs(first, for_selection, changed);
+
+					return (changed != 0);
+				}
+
+				/// Returns the number of the selected or checked items.
+				std::size_t status_count(bool for_selection) const noexcept
+				{
+					std::size_t count = 0;
+					for (auto & cat : categories_)
+						count += cat.states(for_selection).count();
+					return count;
 				}
 
 				/// return absolute positions, no relative to display
 				index_pairs pick_items(bool for_selection) const
 				{
 					index_pairs results;
-					index_pair id;
+					results.reserve(status_count(for_selection));
 
+					std::size_t cat_pos = 0;
 					for (auto & cat : categories_)
 					{
-						id.item = 0;
-						for (auto & m : cat.items)
+						cat.states(for_selection).for_each([&results, cat_pos](std::size_t item_pos)
 						{
-							if (for_selection ? m.flags.selected : m.flags.checked)
-								results.push_back(id);  // absolute positions, no relative to display
-							++id.item;
-						}
-						++id.cat;
+							results.emplace_back(cat_pos, item_pos);  // absolute positions, no relative to display
+						});
+						++cat_pos;
 					}
 					return results;
 				}
@@ -1630,22 +2881,17 @@ namespace nana
 				/// return absolute positions, no relative to display
 				bool item_selected_all_checked(index_pairs& vec) const
 				{
-					index_pair id;
 					bool ck = true;
 
+					std::size_t cat_pos = 0;
 					for (auto & cat : categories_)
 					{
-						id.item = 0;
-						for (auto & m : cat.items)
+						cat.selection.for_each([&](std::size_t item_pos)
 						{
-							if (m.flags.selected)
-							{
-								vec.push_back(id);  // absolute positions, no relative to display
-								ck &= m.flags.checked;
-							}
-							++id.item;
-						}
-						++id.cat;
+							vec.emplace_back(cat_pos, item_pos);  // absolute positions, no relative to display
+							ck &= cat.checks.test(item_pos);
+						});
+						++cat_pos;
 					}
 
 					//Just returns true when the all selected items are checked.
@@ -1656,72 +2902,41 @@ namespace nana
                 /// we are moving in display, but the selection ocurre in abs position
                 void move_select(bool upwards=true, bool unselect_previous=true, bool trace_selected=false) noexcept;
 
-				struct pred_cancel
+				//Cancels the selected or checked states of a category except an item, the event is emitted for each of them.
+				void cancel_status(category_t& cat, std::size_t cat_pos, bool for_selection, std::size_t except)
 				{
-					const bool for_selection;
+					auto & states = cat.states(for_selection);
 
-					pred_cancel(bool for_sel) noexcept : for_selection(for_sel) {}
-
-					bool operator()(category_t::container::value_type & m) const noexcept
+					std::vector<std::size_t> cancels;
+					states.for_each([&cancels, except](std::size_t item_pos)
 					{
-						return (for_selection ? m.flags.selected : m.flags.checked);
-					}
-				};
-
-				struct emit_cancel
-				{
-					es_lister* const self;
-					const bool for_selection;
-
-					emit_cancel(es_lister* self, bool for_sel) noexcept : self(self), for_selection(for_sel) {}
+						if (item_pos != except)
+							cancels.push_back(item_pos);
+					});
 
-					void operator()(category_t::container::value_type& m, const index_pair& item_pos) const
+					for (auto item_pos : cancels)
 					{
-						if (for_selection)
-							m.flags.selected = false;
-						else
-							m.flags.checked = false;
-
-						self->emit_cs(item_pos, for_selection);
+						states.set(item_pos, false);
+						this->emit_cs(index_pair{ cat_pos, item_pos }, for_selection);
 					}
-				};
+				}
 
 				void cancel_others_if_single_enabled(bool for_selection, const index_pair& except)
 				{
 					if (!(for_selection ? single_selection_ : single_check_))
 						return;
 
-					pred_cancel pred{ for_selection };
-					emit_cancel do_cancel{ this, for_selection };
-
 					if (for_selection ? single_selection_category_limited_ : single_check_category_limited_)
 					{
-						auto i = this->get(except.cat);
-
-						std::size_t item_pos = 0;
-						for (auto & m : i->items)
-						{
-							if ((item_pos != except.item) && pred(m))
-								do_cancel(m, index_pair{ except.cat, item_pos });
-
-							++item_pos;
-						}
+						cancel_status(*get(except.cat), except.cat, for_selection, except.item);
 					}
 					else
 					{
-						index_pair cancel_pos;
+						std::size_t cat_pos = 0;
 						for (auto & cat : categories_)
 						{
-							for (auto & m : cat.items)
-							{
-								if ((cancel_pos != except) && pred(m))
-									do_cancel(m, cancel_pos);
-
-								++cancel_pos.item;
-							}
-
-							++cancel_pos.cat;
-							cancel_pos.item = 0;
+							cancel_status(cat, cat_pos, for_selection, (cat_pos == except.cat ? except.item : npos));
+							++cat_pos;
 						}
 					}
 				}
@@ -1742,53 +2957,25 @@ namespace nana
 					single = true;
 					limited = category_limited;
 
-					pred_cancel pred{ for_selection };
-					emit_cancel cancel{ this, for_selection };
-
+					//Keeps the first matched item of each category if it is category limited, otherwise keeps the first
+					//matched item of all the items.
+					bool kept = false;
 					std::size_t cat_pos = 0;
-
-					bool selected = false;
-
 					for (auto & cat : categories_)
 					{
-						if ((category_limited) || (!selected))
+						if (category_limited || !kept)
 						{
-							bool ignore = true;	//Ignore the first matched item
-							std::size_t pos = 0;
-							for (auto & m : cat.items)
+							auto const first = cat.states(for_selection).find(0);
+							if (npos != first)
 							{
-								if (pred(m))
-								{
-									selected = true;
-
-									if (ignore)
-										ignore = false;
-									else
-										cancel(m, index_pair{ cat_pos, pos });
-								}
-								++pos;
+								kept = true;
+								cancel_status(cat, cat_pos, for_selection, first);
 							}
-							++cat_pos;
 						}
 						else
-						{
-							std::size_t skip_cat = 0;
-							for (auto & cat : categories_)
-							{
-								if (skip_cat++ < cat_pos)
-									continue;
+							cancel_status(cat, cat_pos, for_selection, npos);
 
-								std::size_t pos = 0;
-								for (auto & m : cat.items)
-								{
-									if (pred(m))
-										cancel(m, index_pair{ cat_pos, pos });
-									++pos;
-								}
-								++cat_pos;
-							}
-							break;
-						}
+						++cat_pos;
 					}
 				}
 
@@ -1797,20 +2984,16 @@ namespace nana
 					(for_selection ? single_selection_ : single_check_) = false;
 				}
 
+				/// Returns the number of the displayed items of a category.
 				size_type size_item(size_type cat) const
 				{
-					return get(cat)->items.size();
+					return get(cat)->display_size();
 				}
 
 				bool cat_status(size_type pos, bool for_selection) const
 				{
-					auto & items = get(pos)->items;
-					for (auto & m : items)
-					{
-						if ((for_selection ? m.flags.selected : m.flags.checked) == false)
-							return false;
-					}
-					return true;
+					auto & cat = *get(pos);
+					return (cat.states(for_selection).count() == cat.size());
 				}
 
 				bool cat_status(size_type pos, bool for_selection, bool value);
@@ -1819,7 +3002,7 @@ namespace nana
 				{
 					if (pos < categories_.size())
 					{
-						return cat_status(pos, !cat_status(pos, for_selection));
+						return cat_status(pos, for_selection, !cat_status(pos, for_selection));
 					}
 					return false;
 				}
@@ -1827,7 +3010,7 @@ namespace nana
                 /// can be used as the absolute position of the last absolute item, or as the display pos of the last displayed item
                 index_pair last() const noexcept
 				{
-					index_pair i{ categories_.size() - 1, categories_.back().items.size() };
+					index_pair i{ categories_.size() - 1, categories_.back().display_size() };
 
 					if (i.cat)
 					{
@@ -1851,7 +3034,7 @@ namespace nana
                 index_pair first() const noexcept
                 {
 					auto i = categories_.cbegin();
-					if (i->items.size())
+					if (i->display_size())
 						return index_pair{ 0, 0 };
 
 					if (categories_.size() > 1)
@@ -1880,13 +3063,79 @@ namespace nana
 					return i;
 				}
 
-				container::const_iterator get(size_type pos) const
-				{
-					check_range(pos, categories_.size());
+				container::const_iterator get(size_type pos) const
+				{
+					check_range(pos, categories_.size());
+
+					auto i = categories_.cbegin();
+					std::advance(i, pos);
+					return i;
+				}
+			private:
+				/// Returns the texts of a column for sorting, they are indexed by the absolute positions.
+				static std::vector<std::string> _m_sort_texts(const category_t& cat, std::size_t col)
+				{
+					std::vector<std::string> texts(cat.items.size());
+					for (std::size_t i = 0; i < texts.size(); ++i)
+					{
+						if (cat.model_ptr)
+						{
+							auto cells = cat.model_ptr->container()->to_cells(i);
+							if (col < cells.size())
+								texts[i].swap(cells[col].text);
+						}
+						else
+							texts[i] = cat.store.text(i, col);
+					}
+					return texts;
+				}
+
+				/// Returns the numbers of the texts, the number is NaN if the text is not a number.
+				static std::vector<double> _m_numeric_keys(const std::vector<std::string>& texts)
+				{
+					std::vector<double> keys(texts.size());
+
+					static const std::size_t chunk_size = 65536;
+					widgets::skeletons::parallel_for((texts.size() + chunk_size - 1) / chunk_size, [&texts, &keys](std::size_t chunk)
+					{
+						for (auto i = chunk * chunk_size, end = (std::min)(i + chunk_size, texts.size()); i < end; ++i)
+						{
+							auto const begin = texts[i].c_str();
+							char* last;
+							auto value = std::strtod(begin, &last);
+							while (std::isspace(static_cast<unsigned char>(*last)))
+								++last;
+
+							keys[i] = (((last != begin) && !*last) ? value : std::numeric_limits<double>::quiet_NaN());
+						}
+					});
+					return keys;
+				}
+
+				/// Replaces the texts with the collation keys of the user's locale, the keys are compared in byte order.
+				static void _m_collation_keys(std::vector<std::string>& texts)
+				{
+					std::locale loc;
+					try
+					{
+						loc = std::locale("");
+					}
+					catch (std::runtime_error&)
+					{
+						//Uses the classic locale if the user's locale is not supported.
+					}
+
+					auto & facet = std::use_facet<std::collate<char>>(loc);
 
-					auto i = categories_.cbegin();
-					std::advance(i, pos);
-					return i;
+					static const std::size_t chunk_size = 65536;
+					widgets::skeletons::parallel_for((texts.size() + chunk_size - 1) / chunk_size, [&texts, &facet](std::size_t chunk)
+					{
+						for (auto i = chunk * chunk_size, end = (std::min)(i + chunk_size, texts.size()); i < end; ++i)
+						{
+							auto & text = texts[i];
+							text = facet.transform(text.data(), text.data() + text.size());
+						}
+					});
 				}
 			public:
 				index_pair latest_selected_abs;	//Stands for the latest selected item that selected by last operation. Invalid if it is empty.
@@ -1906,6 +3155,8 @@ namespace nana
 				bool single_check_category_limited_{ false };
 
 				std::vector<inline_pane*> active_panes_;
+
+				std::shared_ptr<item_filter> filter_;	//The filter for the categories which are created later.
 			};//end class es_lister
 
 
@@ -1964,6 +3215,11 @@ namespace nana
 					{
 						return header.at(pos).weak_ordering;
 					};
+
+					lister.fetch_sort_key = [this](std::size_t pos)
+					{
+						return header.at(pos).sort_key;
+					};
 				}
 
 				void resize_disp_area()
@@ -1988,9 +3244,23 @@ namespace nana
 
                 std::string to_string(const export_options& exp_opt) const
                 {
-                    return header.to_string(exp_opt) + exp_opt.endl + lister.to_string(exp_opt) ;
+					std::string str;
+					export_to(exp_opt, [&str](const char* text, std::size_t len)
+					{
+						str.append(text, len);
+					});
+					return str;
                 }
 
+				void export_to(const export_options& exp_opt, widgets::skeletons::delimited_writer::output_fn output) const
+				{
+					widgets::skeletons::delimited_writer writer{ std::move(output), exp_opt.sep, exp_opt.quote_fields };
+					header.export_to(exp_opt, writer);
+					writer.write(exp_opt.endl);
+					lister.export_to(exp_opt, writer);
+					writer.flush();
+				}
+
 				int content_position(const index_pair& pos) const
 				{
 					return static_cast<int>(lister.distance(lister.first(), pos) * this->item_height());
@@ -2678,6 +3948,17 @@ namespace nana
 				unsigned max_px = 0;
 				for (auto & cat : categories_)
 				{
+					//Only the cached items of a virtual category are measured.
+					if (cat.virtual_ptr)
+					{
+						cat.virtual_ptr->for_each_cached([&](const std::vector<cell>& cells)
+						{
+							if (pos < cells.size())
+								max_px = (std::max)(max_px, ess_->graph->text_extent_size(cells[pos].text).width);
+						});
+						continue;
+					}
+
 					for (std::size_t i = 0; i < cat.items.size(); ++i)
 					{
 						unsigned content_px = 0;
@@ -2691,10 +3972,12 @@ namespace nana
 						}
 						else
 						{
-							if (pos >= cat.items[i].cells->size())
+							std::size_t len;
+							auto text = cat.store.data(i, pos, len);
+							if (!text)
 								continue;
 
-							content_px = ess_->graph->text_extent_size((*cat.items[i].cells)[pos].text).width;
+							content_px = ess_->graph->text_extent_size(text, len).width;
 						}
 
 						if (content_px > max_px)
@@ -2794,26 +4077,34 @@ namespace nana
 				{
 					ess_->lister.throw_if_immutable_model(pos);
 
+					if (!ess_->lister.has_model(pos))
+					{
+						auto & cat = *ess_->lister.get(pos.cat);
+						if (cat.store.text(pos.item, column_pos_) != value)
+						{
+							cat.store.assign(pos.item, column_pos_, value);
+							cat.filter_retest(pos.item);
+							ess_->update();
+						}
+						return;
+					}
+
 					auto model_cells = ess_->lister.at_model_abs(pos);
-					auto & cells = ess_->lister.has_model(pos) ? model_cells : (*ess_->lister.at_abs(pos).cells);
 
-					if (cells.size() <= column_pos_)
-						cells.resize(column_pos_ + 1);
+					if (model_cells.size() <= column_pos_)
+						model_cells.resize(column_pos_ + 1);
 
-					if (cells[column_pos_].text != value)
+					if (model_cells[column_pos_].text != value)
 					{
-						cells[column_pos_].text = value;
-
-						if (model_cells.size())
-							ess_->lister.assign_model(pos, model_cells);
-
+						model_cells[column_pos_].text = value;
+						ess_->lister.assign_model(pos, model_cells);
 						ess_->update();
 					}
 				}
 
 				void selected(index_type pos) override
 				{
-					if (ess_->lister.at(pos).flags.selected)
+					if (ess_->lister.get(pos.cat)->selection.test(pos.item))
 						return;
 					ess_->lister.select_for_all(false);
 					cat_proxy(ess_, pos.cat).at(pos.item).select(true);
@@ -2840,7 +4131,7 @@ namespace nana
 			{
 				auto& cat = *get(pos.cat);
 
-				if ((pos.item != nana::npos) && (pos.item >= cat.items.size()))
+				if ((pos.item != nana::npos) && (pos.item >= cat.size()))
 					throw std::invalid_argument("listbox: invalid pos to scroll");
 
 				if (!cat.expand)
@@ -2855,7 +4146,7 @@ namespace nana
 			void es_lister::erase(const index_pair& pos)
 			{
 				auto & cat = *get(pos.cat);
-				if (pos.item < cat.items.size())
+				if (pos.item < cat.size())
 				{
 					if (cat.model_ptr)
 					{
@@ -2863,8 +4154,9 @@ namespace nana
 						cat.model_ptr->container()->erase(pos.item);
 					}
 
-					cat.items.erase(cat.items.begin() + pos.item);
+					cat.erase(pos.item);
 					cat.sorted.erase(std::find(cat.sorted.begin(), cat.sorted.end(), cat.items.size()));
+					cat.filter_sync();
 
 					sort();
 				}
@@ -2952,67 +4244,122 @@ namespace nana
 				}
 			}
 
-			std::string es_lister::to_string(const export_options& exp_opt) const
+			void es_lister::export_to(const export_options& exp_opt, widgets::skeletons::delimited_writer& writer) const
 			{
-				std::string list_str;
 				bool first{true};
 				for(auto & cat: cat_container())
 				{
 					if(first)
 						first=false;
 					else
- 						list_str += (to_utf8(cat.text) + exp_opt.endl);
-	
-					std::vector<cell> model_cells;
-
-					auto const pcell = (cat.model_ptr ? &model_cells : nullptr);
+					{
+						auto text = to_utf8(cat.text);
+						writer.field(text.data(), text.size());
+						writer.write(exp_opt.endl);
+					}
 
-					for (auto i : cat.sorted)
+					//The texts of a category without model are written from its store without copying.
+					std::vector<cell> cells;
+					for (std::size_t i = 0; i < cat.display_size(); ++i)
 					{
-						auto& item = cat.items[i];
-						if (item.flags.selected || !exp_opt.only_selected_items)
+						auto const pos = cat.absolute(i);
+						if (exp_opt.only_selected_items || exp_opt.only_checked_items)
 						{
-							//Test if the category have a model set.
-							if (pcell)
-								cat.model_ptr->container()->to_cells(i).swap(model_cells);
-							
-							list_str += (item.to_string(exp_opt, pcell) + exp_opt.endl);
+							if ((exp_opt.only_selected_items && !cat.selection.test(pos)) || (exp_opt.only_checked_items && !cat.checks.test(pos)))
+								continue;
+						}
+
+						if (cat.model_ptr)
+							cells = cat.cells(pos);
+
+						bool ignore_first = true;
+						for (auto col : exp_opt.columns_order)
+						{
+							if (ignore_first)
+								ignore_first = false;
+							else
+								writer.write(exp_opt.sep);
+
+							if (cat.model_ptr)
+							{
+								if (col < cells.size())
+									writer.field(cells[col].text.data(), cells[col].text.size());
+							}
+							else
+							{
+								std::size_t len;
+								auto text = cat.store.data(pos, col, len);
+								writer.field(text, len);
+							}
 						}
+						writer.write(exp_opt.endl);
 					}
 				}
-				return list_str ;
 			}
 
 			bool es_lister::cat_status(size_type pos, bool for_selection, bool value)
 			{
 				bool changed = false;
 
-				if (for_selection)
+				auto & cat = *get(pos);
+				if (value && single_status(for_selection))
 				{
+					//Every item is changed by item_proxy to cancel the others.
 					cat_proxy cpx{ ess_, pos };
 					for (item_proxy &it : cpx)
-						it.select(value);
+					{
+						if (for_selection)
+							it.select(true);
+						else
+							it.check(true);
+					}
+					changed = true;
+				}
+				else if (cat.filter && !cat.virtual_ptr)
+				{
+					//Only the displayed items are changed if a filter is set.
+					cat.filter_sync();
 
-					latest_selected_abs.cat = pos;
-					latest_selected_abs.item = npos;
+					auto & states = cat.states(for_selection);
+					std::size_t first = npos;
+					std::size_t count = 0;
+					for (auto item : cat.display_order())
+					{
+						if (states.set(item, value))
+						{
+							if (npos == first)
+								first = item;
+							++count;
+						}
+					}
 
-					return true;
+					if (count)
+					{
+						this->emit_cs(index_pair{ pos, first }, for_selection, count);
+						changed = true;
+					}
 				}
 				else
 				{
-					auto & items = get(pos)->items;
-					size_type index = 0;
-					for (auto & m : items)
+					auto & states = cat.states(for_selection);
+					auto const n = cat.size();
+					auto const count = (value ? n - states.count() : states.count());
+					if (count)
 					{
-						if (m.flags.checked != value)
-						{
-							m.flags.checked = value;
-							this->emit_cs(index_pair{ pos, index }, false);
-							changed = true;
-						}
-						++index;
+						auto const first = states.find(0, !value);
+						states.set_all(n, value);
+						this->emit_cs(index_pair{ pos, first }, for_selection, count);
+						changed = true;
 					}
 				}
+
+				if (for_selection)
+				{
+					latest_selected_abs.cat = pos;
+					latest_selected_abs.item = npos;
+
+					return true;
+				}
 				return changed;
 			}
 
@@ -3329,6 +4676,9 @@ namespace nana
 					//clear active panes
 					essence_->lister.append_active_panes(nullptr);
 
+					for (auto & cat : essence_->lister.cat_container())
+						cat.compact();
+
 					//The count of items to be drawn
 					auto item_count = essence_->count_of_exposed(true);
 					if (0 == item_count)
@@ -3406,6 +4756,8 @@ namespace nana
 									ind->detach();
 							}
 
+						essence_->graph->glyph_run_begin();
+
 						//Here we draw the root categ (0) or a first item if the first drawing is not a categ.(item!=npos))
 						if (idx.cat == 0 || !idx.is_category())
 						{
@@ -3415,7 +4767,7 @@ namespace nana
 								idx.item = 0;
 							}
 
-							std::size_t size = i_categ->items.size();
+							std::size_t size = i_categ->display_size();
 							for (std::size_t offs = first_disp.item; offs < size; ++offs, ++idx.item)
 							{
 								if (item_coord.y >= rect.bottom())
@@ -3449,7 +4801,7 @@ namespace nana
 							if (false == i_categ->expand)
 								continue;
 
-							auto size = i_categ->items.size();
+							auto size = i_categ->display_size();
 							for (decltype(size) pos = 0; pos < size; ++pos)
 							{
 								if (item_coord.y > rect.bottom())
@@ -3469,6 +4821,8 @@ namespace nana
 							}
 						}
 
+						essence_->graph->glyph_run_end();
+
 						essence_->inline_buffered_table.clear();
 					}
 
@@ -3507,10 +4861,8 @@ namespace nana
 					rectangle bground_r{ x + static_cast<int>(essence_->header.margin()), y, width, item_height };
 					auto graph = essence_->graph;
 
-					item_data item;
-					item.flags.selected = categ.selected();
-
-					this->_m_draw_item_bground(bground_r, bgcolor, {}, state, item);
+					auto const selected = categ.selected();
+					this->_m_draw_item_bground(bground_r, bgcolor, {}, state, item_data{}, selected);
 
 					color txt_color{ static_cast<color_rgb>(0x3399) };
 
@@ -3522,7 +4874,7 @@ namespace nana
 
 					graph->string({ x + 20, y + txtoff }, categ.text, txt_color);
 
-					native_string_type str = to_nstring('(' + std::to_string(categ.items.size()) + ')');
+					native_string_type str = to_nstring('(' + std::to_string(categ.size()) + ')');
 
 					auto text_s = graph->text_extent_size(categ.text).width;
 					auto extend_text_w = text_s + graph->text_extent_size(str).width;
@@ -3538,11 +4890,11 @@ namespace nana
 					}
 
 					//Draw selecting inner rectangle
-					if (item.flags.selected && (categ.expand == false))
+					if (selected && (categ.expand == false))
 						_m_draw_item_border(y);
 				}
 
-				color _m_draw_item_bground(const rectangle& bground_r, color bgcolor, color cell_color, item_state state, const item_data& item)
+				color _m_draw_item_bground(const rectangle& bground_r, color bgcolor, color cell_color, item_state state, const item_data& item, bool selected)
 				{
 					auto graph = essence_->graph;
 
@@ -3551,7 +4903,7 @@ namespace nana
 					if (is_transparent)
 						bgcolor = color{};
 
-					if (item.flags.selected)
+					if (selected)
 					{
 						bgcolor = essence_->scheme_ptr->item_selected;
 
@@ -3560,12 +4912,12 @@ namespace nana
 					}
 					else if (!cell_color.invisible())
 						bgcolor = cell_color;
-					else if (!item.bgcolor.invisible())
-						bgcolor = item.bgcolor;
+					else if (!item.bgcolor().invisible())
+						bgcolor = item.bgcolor();
 
 					if (item_state::highlighted == state)
 					{
-						if (item.flags.selected)
+						if (selected)
 							bgcolor = bgcolor.blend(essence_->scheme_ptr->item_highlighted, 0.5);
 						else
 							bgcolor = bgcolor.blend(essence_->scheme_ptr->item_highlighted, 0.7);
@@ -3598,18 +4950,17 @@ namespace nana
 					              item_state state
 					)
 				{
-					auto & item = cat.items[item_pos.item];
+					auto & item = cat.at(item_pos.item);
+					auto const selected = cat.selection.test(item_pos.item);
+					auto const checked = cat.checks.test(item_pos.item);
 
-					std::vector<cell> model_cells;
-					if (cat.model_ptr)
-					{
-						model_cells = cat.model_ptr->container()->to_cells(item_pos.item);
-					}
+					auto cells = cat.cells(item_pos.item);
 
-					auto & cells = (cat.model_ptr ? model_cells : *item.cells);
+					if(!item.fgcolor().invisible())
+						fgcolor = item.fgcolor();
 
-					if(!item.fgcolor.invisible())
-						fgcolor = item.fgcolor;
+					//The image of the item, it is null if the item doesn't have an image.
+					auto const img = ((item.attrs && item.attrs->img) ? &item.attrs->img : nullptr);
 
 					const unsigned show_w = (std::min)(content_r.width, width - essence_->content_view->origin().x);
 
@@ -3617,7 +4968,7 @@ namespace nana
 
 					//draw the background for the whole item
 					rectangle bground_r{ content_r.x + static_cast<int>(essence_->header.margin()), coord.y, show_w, essence_->item_height() };
-					auto const state_bgcolor = this->_m_draw_item_bground(bground_r, bgcolor, {}, state, item);
+					auto const state_bgcolor = this->_m_draw_item_bground(bground_r, bgcolor, {}, state, item, selected);
 
 					int column_x = coord.x;
 
@@ -3652,18 +5003,19 @@ namespace nana
 									}
 
 									using state = facade<element::crook>::state;
-									crook_renderer_.check(item.flags.checked ? state::checked : state::unchecked);
+									crook_renderer_.check(checked ? state::checked : state::unchecked);
 								}
 
 								if (essence_->if_image)
 								{
 									//Draw the image in the 1st column in display order
-									if (item.img)
+									if (img)
 									{
-										nana::rectangle imgt(item.img_show_size);
+										auto & img_show_size = item.attrs->img_show_size;
+										nana::rectangle imgt(img_show_size);
 										img_r = imgt;
-										img_r.x = content_pos + coord.x + (16 - static_cast<int>(item.img_show_size.width)) / 2;  // center in 16 - geom scheme?
-										img_r.y = coord.y + (static_cast<int>(essence_->item_height()) - static_cast<int>(item.img_show_size.height)) / 2; // center
+										img_r.x = content_pos + coord.x + (16 - static_cast<int>(img_show_size.width)) / 2;  // center in 16 - geom scheme?
+										img_r.y = coord.y + (static_cast<int>(essence_->item_height()) - static_cast<int>(img_show_size.height)) / 2; // center
 									}
 									content_pos += 18;  // image width, geom scheme?
 								}
@@ -3708,8 +5060,8 @@ namespace nana
 									inline_wdg->pane_widget.size(sz);
 									inline_wdg->inline_ptr->resize(sz);
 
-									inline_wdg->inline_ptr->notify_status(status_type::selected, item.flags.selected);
-									inline_wdg->inline_ptr->notify_status(status_type::checked, item.flags.checked);
+									inline_wdg->inline_ptr->notify_status(status_type::selected, selected);
+									inline_wdg->inline_ptr->notify_status(status_type::checked, checked);
 									
 									inline_wdg->indicator->attach(item_pos, inline_wdg);
 
@@ -3738,7 +5090,7 @@ namespace nana
 									col_fgcolor = m_cell.custom_format->fgcolor;
 
 									bground_r = rectangle{ column_x, coord.y, col.width_px, essence_->item_height() };
-									col_bgcolor = this->_m_draw_item_bground(bground_r, bgcolor, m_cell.custom_format->bgcolor, state, item);
+									col_bgcolor = this->_m_draw_item_bground(bground_r, bgcolor, m_cell.custom_format->bgcolor, state, item, selected);
 								}
 								else
 									col_bgcolor = state_bgcolor;
@@ -3762,8 +5114,8 @@ namespace nana
 							{
 								if (essence_->checkable)
 									crook_renderer_.draw(*graph, col_bgcolor, col_fgcolor, essence_->checkarea(column_x, coord.y), estate);
-								if (item.img)
-									item.img.stretch(rectangle{ item.img.size() }, *graph, img_r);
+								if (img)
+									img->stretch(rectangle{ img->size() }, *graph, img_r);
 							}
 
 							if (display_order > 0)
@@ -3774,7 +5126,7 @@ namespace nana
 					}
 
 					//Draw selecting inner rectangle
-					if (item.flags.selected)
+					if (selected)
 						_m_draw_item_border(coord.y);
 				}
 
@@ -4041,10 +5393,11 @@ namespace nana
 
 						if ((essence_->column_from_pos(arg.pos.x) != npos) && !item_pos.empty())
 						{
-							auto * item_ptr = (item_pos.is_category() ? nullptr : &lister.at(item_pos));
-
 							const auto abs_item_pos = lister.index_cast_noexcpt(item_pos, true, item_pos);	//convert display position to absolute position
 
+							//The states of the item, it is null if the category is clicked.
+							auto * item_cat = (item_pos.is_category() ? nullptr : &*lister.get(abs_item_pos.cat));
+
 							if(ptr_where.first == parts::list)
 							{
 								//adjust the display of selected into the list rectangle if the part of the item is beyond the top/bottom edge
@@ -4090,14 +5443,13 @@ namespace nana
 										if (nana::mouse::right_button == arg.button)
 										{
 											//Unselects all selected items if the current item is not selected before selecting.
-											auto selected = lister.pick_items(true);
-											if (selected.cend() == std::find(selected.cbegin(), selected.cend(), item_pos))
-												lister.select_for_all(false, item_pos);
+											if (!item_cat || !item_cat->selection.test(abs_item_pos.item))
+												lister.select_for_all(false, abs_item_pos);
 										}
 										else
 										{
 											//Unselects all selected items except current item if right button clicked.
-											lister.select_for_all(false, item_pos);	//cancel all selections
+											lister.select_for_all(false, abs_item_pos);	//cancel all selections
 										}
 									}
 								}
@@ -4105,18 +5457,17 @@ namespace nana
 								{
 									//Clicking on a category is ignored when single selection is enabled.
 									//Fixed by Greentwip(issue #121)
-									if (item_ptr)
+									if (item_cat)
 										sel = !item_proxy(essence_, abs_item_pos).selected();
 								}
 
-								if(item_ptr)
+								if(item_cat)
 								{
-									if (item_ptr->flags.selected != sel)
+									if (item_cat->selection.set(abs_item_pos.item, sel))
 									{
-										item_ptr->flags.selected = sel;
 										lister.emit_cs(abs_item_pos, true);
 
-										if (item_ptr->flags.selected)
+										if (sel)
 										{
 											lister.cancel_others_if_single_enabled(true, abs_item_pos);
 											essence_->lister.latest_selected_abs = abs_item_pos;
@@ -4132,12 +5483,13 @@ namespace nana
 							}
 							else
 							{
-								if (item_ptr)
+								if (item_cat)
 								{
-									item_ptr->flags.checked = !item_ptr->flags.checked;
+									auto const checked = !item_cat->checks.test(abs_item_pos.item);
+									item_cat->checks.set(abs_item_pos.item, checked);
 									lister.emit_cs(abs_item_pos, false);
 
-									if (item_ptr->flags.checked)
+									if (checked)
 										lister.cancel_others_if_single_enabled(false, abs_item_pos);
 								}
 								else if (!lister.single_status(false))	//not single checked
@@ -4440,7 +5792,11 @@ namespace nana
 					if (!ess_->lister.get(pos_.cat)->expand)
 						return false;
 
-					auto pos = to_display();
+					//The item which is not accepted by the filter doesn't have a display position.
+					auto pos = ess_->lister.index_cast_noexcpt(pos_, false);
+					if (pos.empty())
+						return false;
+
 					if (ess_->first_display() > pos)
 						return false;
 
@@ -4457,28 +5813,29 @@ namespace nana
 				item_proxy & item_proxy::check(bool ck, bool scroll_view)
 				{
 					internal_scope_guard lock;
-					auto & m = cat_->items.at(pos_.item);
-					if(m.flags.checked != ck)
-					{
-						m.flags.checked = ck;
-						ess_->lister.emit_cs(pos_, false);
-						if (scroll_view)
-						{
-							if (ess_->lister.get(pos_.cat)->expand)
-								ess_->lister.get(pos_.cat)->expand = false;
+					check_range(pos_.item, cat_->size());
+					if (!cat_->checks.set(pos_.item, ck))
+						return *this;
 
-							if (!this->displayed())
-								ess_->lister.scroll(pos_, !(ess_->first_display() > this->to_display()));
-						}
+					ess_->lister.emit_cs(pos_, false);
+					if (scroll_view)
+					{
+						if (ess_->lister.get(pos_.cat)->expand)
+							ess_->lister.get(pos_.cat)->expand = false;
 
-						ess_->update();
+						auto const disp_pos = ess_->lister.index_cast_noexcpt(pos_, false);
+						if (!disp_pos.empty() && !this->displayed())
+							ess_->lister.scroll(pos_, !(ess_->first_display() > disp_pos));
 					}
+
+					ess_->update();
 					return *this;
 				}
 
 				bool item_proxy::checked() const
 				{
-					return cat_->items.at(pos_.item).flags.checked;
+					check_range(pos_.item, cat_->size());
+					return cat_->checks.test(pos_.item);
 				}
 
 				/// is ignored if no change (maybe set last_selected anyway??), but if change emit event, deselect others if need ans set/unset last_selected
@@ -4487,15 +5844,13 @@ namespace nana
 					internal_scope_guard lock;
 
 					//pos_ never represents a category if this item_proxy is available.
-					auto & m = cat_->items.at(pos_.item);       // a ref to the real item
-					if(m.flags.selected == s)
+					check_range(pos_.item, cat_->size());
+					if (!cat_->selection.set(pos_.item, s))
 						return *this;     // ignore if no change
 
-					m.flags.selected = s;                       // actually change selection
-
 					ess_->lister.emit_cs(this->pos_, true);
 
-					if (m.flags.selected)
+					if (s)
 					{
 						ess_->lister.cancel_others_if_single_enabled(true, pos_);	//Cancel all selections except pos_ if single_selection is enabled.
 						ess_->lister.latest_selected_abs = pos_;
@@ -4508,8 +5863,9 @@ namespace nana
 						if (ess_->lister.get(pos_.cat)->expand)
 							ess_->lister.get(pos_.cat)->expand = false;
 
-						if (!this->displayed())
-							ess_->lister.scroll(pos_, !(ess_->first_display() > this->to_display()));
+						auto const disp_pos = ess_->lister.index_cast_noexcpt(pos_, false);
+						if (!disp_pos.empty() && !this->displayed())
+							ess_->lister.scroll(pos_, !(ess_->first_display() > disp_pos));
 					}
 
 					ess_->update();
@@ -4518,31 +5874,34 @@ namespace nana
 
 				bool item_proxy::selected() const
 				{
-					return cat_->items.at(pos_.item).flags.selected;
+					check_range(pos_.item, cat_->size());
+					return cat_->selection.test(pos_.item);
 				}
 
 				item_proxy & item_proxy::bgcolor(const nana::color& col)
 				{
-					cat_->items.at(pos_.item).bgcolor = col;
+					cat_->at(pos_.item).attr().bgcolor = col;
 					ess_->update();
 					return *this;
 				}
 
 				nana::color item_proxy::bgcolor() const
 				{
-					return cat_->items.at(pos_.item).bgcolor;
+					const auto & cat = *cat_;
+					return cat.at(pos_.item).bgcolor();
 				}
 
 				item_proxy& item_proxy::fgcolor(const nana::color& col)
 				{
-					cat_->items.at(pos_.item).fgcolor = col;
+					cat_->at(pos_.item).attr().fgcolor = col;
 					ess_->update();
 					return *this;
 				}
 
 				nana::color item_proxy::fgcolor() const
 				{
-					return cat_->items.at(pos_.item).fgcolor;
+					const auto & cat = *cat_;
+					return cat.at(pos_.item).fgcolor();
 				}
 
 				std::size_t item_proxy::columns() const noexcept
@@ -4578,16 +5937,22 @@ namespace nana
 
 				std::string item_proxy::text(size_type col) const
 				{
-					return cat_->cells(pos_.item).at(col).text;
+					if (cat_->model_ptr)
+						return cat_->cells(pos_.item).at(col).text;
+
+					//Only the requested text is copied from the store.
+					check_range(pos_.item, cat_->size());
+					check_range(col, cat_->store.cells(pos_.item));
+					return cat_->store.text(pos_.item, col);
 				}
 
 				void item_proxy::icon(const nana::paint::image& img)
 				{
 					if (img)
 					{
-						auto & item = cat_->items.at(pos_.item);
-						item.img = img;
-						nana::fit_zoom(img.size(), nana::size(16, 16), item.img_show_size);
+						auto & attr = cat_->at(pos_.item).attr();
+						attr.img = img;
+						nana::fit_zoom(img.size(), nana::size(16, 16), attr.img_show_size);
 
 						ess_->if_image = true;
 						ess_->update();
@@ -4629,7 +5994,7 @@ namespace nana
 				// Behavior of Iterator
 				item_proxy & item_proxy::operator++()
 				{
-					if (++pos_.item >= cat_->items.size())
+					if (++pos_.item >= cat_->size())
 						cat_ = nullptr;
 
 					return *this;
@@ -4640,7 +6005,7 @@ namespace nana
 				{
 					item_proxy ip(*this);
 
-					if (++pos_.item >= cat_->items.size())
+					if (++pos_.item >= cat_->size())
 						cat_ = nullptr;
 					return ip;
 				}
@@ -4742,6 +6107,147 @@ namespace nana
 					return{ cat_->model_ptr.get() };
 				}
 
+				void cat_proxy::virtualize(size_type items, std::function<std::vector<cell>(size_type pos)> source)
+				{
+					internal_scope_guard lock;
+
+					auto model = new virtual_model(items, std::move(source));
+					cat_->model_ptr.reset(model);
+					cat_->virtual_ptr = &model->items();
+					cat_->clear();
+					cat_->make_sort_order();
+
+					ess_->update(true);
+				}
+
+				void cat_proxy::virtual_size(size_type items)
+				{
+					internal_scope_guard lock;
+					if (!cat_->virtual_ptr)
+						throw std::runtime_error("nana::listbox the category is not virtual");
+
+					cat_->virtual_ptr->resize(items);
+					cat_->virtual_items.erase(cat_->virtual_items.lower_bound(items), cat_->virtual_items.end());
+					cat_->selection.truncate(items);
+					cat_->checks.truncate(items);
+
+					ess_->update(true);
+				}
+
+				void cat_proxy::invalidate()
+				{
+					internal_scope_guard lock;
+					if (cat_->virtual_ptr)
+					{
+						cat_->virtual_ptr->invalidate();
+						ess_->update();
+					}
+				}
+
+				void cat_proxy::append_items(const std::vector<std::vector<std::string>>& items_utf8)
+				{
+					internal_scope_guard lock;
+
+					if (cat_->model_ptr)
+					{
+						//The items are appended to the model one by one.
+						for (auto & texts : items_utf8)
+						{
+							std::vector<cell> cells;
+							for (auto & txt : texts)
+								cells.emplace_back(txt);
+
+							cells.resize(columns());
+							_m_append(std::move(cells));
+						}
+					}
+					else
+					{
+						auto pos = cat_->items.size();
+						cat_->append(items_utf8, columns());
+
+						for (; pos < cat_->items.size(); ++pos)
+							cat_->sorted.push_back(pos);
+
+						cat_->filter_sync();
+					}
+
+					ess_->lister.sort();
+					ess_->update();
+				}
+
+				auto cat_proxy::import_items(const char* data, std::size_t len, const import_options& opt) -> size_type
+				{
+					namespace skeletons = widgets::skeletons;
+					skeletons::delimited_format const fmt{ opt.sep, opt.quoted };
+
+					auto begin = data;
+					auto const end = data + len;
+
+					//Skips the UTF-8 BOM
+					if ((len >= 3) && (0 == std::memcmp(begin, "\xEF\xBB\xBF", 3)))
+						begin += 3;
+
+					if (opt.skip_first_row)
+					{
+						while ((begin < end) && (('\r' == *begin) || ('\n' == *begin)))
+							++begin;
+						begin = skeletons::next_row(begin, end, fmt);
+					}
+
+					internal_scope_guard lock;
+
+					size_type rows = 0;
+					if (cat_->model_ptr)
+					{
+						//The items are appended to the model one by one.
+						std::vector<cell> cells;
+						std::string text;
+						rows = skeletons::parse_rows(begin, end, fmt, [this, &cells, &text](std::size_t, std::size_t col, const char* field, std::size_t n, bool escaped)
+						{
+							if ((0 == col) && !cells.empty())
+							{
+								cells.resize(columns());
+								_m_append(std::move(cells));
+								cells.clear();
+							}
+
+							text.resize(skeletons::unescape(field, n, escaped, nullptr));
+							skeletons::unescape(field, n, escaped, &text[0]);
+							cells.emplace_back(text);
+						});
+
+						if (!cells.empty())
+						{
+							cells.resize(columns());
+							_m_append(std::move(cells));
+						}
+					}
+					else
+					{
+						auto pos = cat_->items.size();
+						rows = cat_->import(begin, end, fmt, columns());
+
+						for (; pos < cat_->items.size(); ++pos)
+							cat_->sorted.push_back(pos);
+
+						cat_->filter_sync();
+					}
+
+					ess_->lister.sort();
+					ess_->update();
+					return rows;
+				}
+
+				auto cat_proxy::import_file(const std::string& file_utf8, const import_options& opt) -> size_type
+				{
+					widgets::skeletons::text_file_view view;
+					if (!view.open(file_utf8.c_str()))
+						throw std::runtime_error("nana::listbox failed to open the file");
+
+					return import_items(view.data(), view.size(), opt);
+				}
+
 				void cat_proxy::append(std::initializer_list<std::string> arg)
 				{
 					const auto items = columns();
@@ -4846,7 +6352,13 @@ namespace nana
 						cat_->items.emplace_back();
 					}
 					else
-						cat_->items.emplace_back(std::move(s));
+					{
+						std::vector<cell> cells;
+						cells.emplace_back(std::move(s));
+						cat_->insert(cat_->items.size(), std::move(cells));
+					}
+
+					cat_->filter_sync();
 
 					ess_->update();
 				}
@@ -4855,7 +6367,7 @@ namespace nana
 				item_proxy cat_proxy::begin() const
 				{
 					auto i = ess_->lister.get(pos_);
-					if (i->items.empty())
+					if (0 == i->size())
 						return end();
 
 					return item_proxy(ess_, index_pair(pos_, 0));
@@ -4887,10 +6399,10 @@ namespace nana
 
 				item_proxy cat_proxy::back() const
 				{
-					if (cat_->items.empty())
+					if (0 == cat_->size())
 						throw std::runtime_error("listbox.back() no element in the container.");
 
-					return item_proxy(ess_, index_pair(pos_, cat_->items.size() - 1));
+					return item_proxy(ess_, index_pair(pos_, cat_->size() - 1));
 				}
 
 				size_type cat_proxy::index_cast(size_type from, bool from_display_order) const
@@ -4905,7 +6417,7 @@ namespace nana
 
 				size_type cat_proxy::size() const
 				{
-					return cat_->items.size();
+					return cat_->size();
 				}
 
 				// Behavior of Iterator
@@ -5024,10 +6536,11 @@ namespace nana
 					else
 					{
 						cells.resize(columns());
-						cat_->items.emplace_back(std::move(cells));
+						cat_->insert(cat_->items.size(), std::move(cells));
 					}
 
 					cat_->sorted.push_back(cat_->items.size() - 1);
+					cat_->filter_sync();
 				}
 
 				void cat_proxy::_m_try_append_model(const const_virtual_pointer& dptr)
@@ -5043,6 +6556,7 @@ namespace nana
 
 					cat_->sorted.push_back(cat_->items.size());
 					cat_->items.emplace_back();
+					cat_->filter_sync();
 				}
 
 				void cat_proxy::_m_cat_by_pos() noexcept
@@ -5070,7 +6584,8 @@ namespace nana
 					if (ess_->listbox_ptr)
 					{
 						cat_->model_ptr.reset(p);
-						cat_->items.clear();
+						cat_->virtual_ptr = nullptr;
+						cat_->clear();
 
 						cat_->items.resize(cat_->model_ptr->container()->size());
 
@@ -5249,14 +6764,10 @@ namespace nana
 			internal_scope_guard lock;
 			auto & ess = _m_ess();
 			ess.lister.insert(pos, std::move(text), this->column_size());
-			
+
+			//The item is drawn with the colors of listbox, its attributes are not allocated until one of them is set.
 			if (!empty())
-			{
-				auto & item = ess.lister.at(pos);
-				item.bgcolor = bgcolor();
-				item.fgcolor = fgcolor();
 				ess.update();
-			}
 		}
 
 		void listbox::insert_item(const index_pair& pos, const std::wstring& text)
@@ -5334,6 +6845,23 @@ namespace nana
 			return _m_ess().lister.pick_items(false);
 		}
 
+		auto listbox::size_checked() const -> size_type
+		{
+			internal_scope_guard lock;
+			return _m_ess().lister.status_count(false);
+		}
+
+		void listbox::check_all(bool ck)
+		{
+			internal_scope_guard lock;
+			auto & ess = _m_ess();
+			if (ck && ess.lister.single_status(false))
+				return;
+
+			if (ess.lister.status_for_all(false, ck))
+				ess.update();
+		}
+
 		void listbox::clear(size_type cat)
 		{
 			auto & ess = _m_ess();
@@ -5417,7 +6945,7 @@ namespace nana
 			for (auto & pos : indexes)
 			{
 				auto & cat = *ess.lister.get(pos.cat);
-				if (pos.item < cat.items.size())
+				if (pos.item < cat.size())
 				{
 					if (cat.model_ptr)
 					{
@@ -5425,7 +6953,7 @@ namespace nana
 						cat.model_ptr->container()->erase(pos.item);
 					}
 
-					cat.items.erase(cat.items.begin() + pos.item);
+					cat.erase(pos.item);
 				}
 			}
 
@@ -5489,6 +7017,19 @@ namespace nana
 			_m_ess().header.at(col).weak_ordering = std::move(strick_ordering);
 		}
 
+		void listbox::set_sort_key(size_type col, sort_key key)
+		{
+			internal_scope_guard lock;
+			auto & ess = _m_ess();
+			ess.header.at(col).sort_key = key;
+
+			if (ess.lister.sort_attrs().column == col)
+			{
+				ess.lister.sort();
+				ess.update();
+			}
+		}
+
         /// sort() and ivalidate any existing reference from display position to absolute item, that is: after sort() display offset point to different items
         void listbox::sort_col(size_type col, bool reverse)
 		{
@@ -5506,6 +7047,46 @@ namespace nana
 			this->sort_col(npos, false);
 		}
 
+		void listbox::filter(std::function<bool(const std::vector<cell>&)> pred, bool narrowing)
+		{
+			internal_scope_guard lock;
+			auto & ess = _m_ess();
+
+			if (pred)
+				ess.lister.filter(std::make_shared<drawerbase::listbox::predicate_filter>(std::move(pred)), narrowing);
+			else
+				ess.lister.filter(nullptr, false);
+
+			ess.calc_content_size(false);
+			ess.content_view->change_position(0, false, false);
+			ess.content_view->sync(false);
+			ess.update();
+		}
+
+		void listbox::filter_text(const std::string& query_utf8, std::vector<size_type> columns)
+		{
+			internal_scope_guard lock;
+			auto & ess = _m_ess();
+
+			ess.lister.filter(query_utf8, std::move(columns));
+
+			ess.calc_content_size(false);
+			ess.content_view->change_position(0, false, false);
+			ess.content_view->sync(false);
+			ess.update();
+		}
+
+		void listbox::unfilter()
+		{
+			filter(nullptr);
+		}
+
+		bool listbox::filtered() const
+		{
+			internal_scope_guard lock;
+			return _m_ess().lister.filtered();
+		}
+
 		bool listbox::freeze_sort(bool freeze)
 		{
 			return !_m_ess().lister.active_sort(!freeze);
@@ -5516,6 +7097,34 @@ namespace nana
 			return _m_ess().lister.pick_items(true);   // absolute positions, no relative to display
 		}
 
+		auto listbox::size_selected() const -> size_type
+		{
+			internal_scope_guard lock;
+			return _m_ess().lister.status_count(true);
+		}
+
+		void listbox::select_all(bool sel)
+		{
+			internal_scope_guard lock;
+			auto & ess = _m_ess();
+			if (sel && ess.lister.single_status(true))
+				return;
+
+			if (ess.lister.select_for_all(sel))
+				ess.update();
+		}
+
+		void listbox::invert_selection()
+		{
+			internal_scope_guard lock;
+			auto & ess = _m_ess();
+			if (ess.lister.single_status(true))
+				return;
+
+			if (ess.lister.invert_for_all(true))
+				ess.update();
+		}
+
 		void listbox::show_header(bool sh)
 		{
 			_m_ess().header.visible(sh);
@@ -5540,7 +7149,7 @@ namespace nana
 
 		listbox::size_type listbox::size_item(size_type categ) const
 		{
-			return _m_ess().lister.size_item(categ);
+			return _m_ess().lister.get(categ)->size();
 		}
 
 		void listbox::enable_single(bool for_selection, bool category_limited)
@@ -5559,6 +7168,20 @@ namespace nana
 			return _m_ess().def_exp_options;
         }
 
+		void listbox::export_items(const export_options& exp_opt, std::function<void(const char* data, std::size_t len)> output) const
+		{
+			internal_scope_guard lock;
+			auto & ess = _m_ess();
+			if (exp_opt.columns_order.empty())
+			{
+				auto opt = exp_opt;
+				opt.columns_order = ess.header.get_headers(exp_opt.only_visible_columns);
+				ess.export_to(opt, std::move(output));
+			}
+			else
+				ess.export_to(exp_opt, std::move(output));
+		}
+
 		drawerbase::listbox::essence & listbox::_m_ess() const
 		{
 			return get_drawer_trigger().ess();
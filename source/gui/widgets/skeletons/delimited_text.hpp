@@ -0,0 +1,287 @@
+/*
+ *	A Delimited Text Parser and Writer
+ *	Nana C++ Library(http://www.nanapro.org)
+ *	Copyright(C) 2017 Jinhao(cnjinhao@hotmail.com)
+ *
+ *	Distributed under the Boost Software License, Version 1.0.
+ *	(See accompanying file LICENSE_1_0.txt or copy at
+ *	http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *	@file: nana/gui/widgets/skeletons/delimited_text.hpp
+ */
+
+#ifndef NANA_WIDGETS_SKELETONS_DELIMITED_TEXT_INCLUDED
+#define NANA_WIDGETS_SKELETONS_DELIMITED_TEXT_INCLUDED
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstring>
+#include <algorithm>
+
+namespace nana { namespace widgets {
+namespace skeletons
+{
+	struct delimited_format
+	{
+		char sep;
+		bool quoted;	//A field may be enclosed in quotation marks, and a quotation mark in it is doubled(RFC 4180).
+	};
+
+	//Splits the text into at most the specified number of chunks, every chunk consists of whole rows. The text is
+	//scanned from the beginning if the fields are quoted, because a quoted field may contain line breaks.
+	inline std::vector<const char*> split_rows(const char* begin, const char* end, const delimited_format& fmt, std::size_t chunks)
+	{
+		std::vector<const char*> bounds{ begin };
+
+		auto const n = static_cast<std::size_t>(end - begin);
+		bool quoted = false;
+		auto p = begin;
+		for (std::size_t i = 1; i < chunks; ++i)
+		{
+			auto const target = (std::max)(begin + n * i / chunks, p);
+			if (fmt.quoted)
+			{
+				for (; p < target; ++p)
+				{
+					if ('"' == *p)
+						quoted = !quoted;
+				}
+
+				for (; p < end; ++p)
+				{
+					if ('"' == *p)
+						quoted = !quoted;
+					else if (('\n' == *p) && !quoted)
+						break;
+				}
+			}
+			else
+			{
+				p = static_cast<const char*>(std::memchr(target, '\n', end - target));
+				if (!p)
+					p = end;
+			}
+
+			if (p == end)
+				break;
+
+			bounds.push_back(++p);
+		}
+
+		if (bounds.back() != end)
+			bounds.push_back(end);
+		return bounds;
+	}
+
+	//Returns the beginning of the row behind the row which begins at p.
+	inline const char* next_row(const char* p, const char* end, const delimited_format& fmt)
+	{
+		bool quoted = false;
+		for (; p < end; ++p)
+		{
+			if (fmt.quoted && ('"' == *p))
+				quoted = !quoted;
+			else if (('\n' == *p) && !quoted)
+				return p + 1;
+		}
+		return end;
+	}
+
+	//Parses the rows of the text, and calls fn(row, col, text, len, escaped) for each field, the row is counted from 0.
+	//The text of a field is escaped if it contains doubled quotation marks, see unescape(). A row is ended by LF or CRLF,
+	//and the blank lines are skipped. Returns the number of rows.
+	template<typename Function>
+	std::size_t parse_rows(const char* p, const char* end, const delimited_format& fmt, Function fn)
+	{
+		std::size_t rows = 0;
+		while (p < end)
+		{
+			if ('\n' == *p)
+			{
+				++p;
+				continue;
+			}
+
+			if (('\r' == *p) && (p + 1 < end) && ('\n' == p[1]))
+			{
+				p += 2;
+				continue;
+			}
+
+			std::size_t col = 0;
+			while (true)
+			{
+				const char* text;
+				std::size_t len;
+				bool escaped = false;
+
+				if (fmt.quoted && (p < end) && ('"' == *p))
+				{
+					text = ++p;
+					for (; p < end; ++p)
+					{
+						if ('"' == *p)
+						{
+							if ((p + 1 == end) || ('"' != p[1]))
+								break;
+
+							escaped = true;
+							++p;
+						}
+					}
+					len = static_cast<std::size_t>(p - text);
+
+					//Skips the closing quotation mark and the characters behind it, they are malformed except a CR.
+					while ((p < end) && (fmt.sep != *p) && ('\n' != *p))
+						++p;
+				}
+				else
+				{
+					text = p;
+					while ((p < end) && (fmt.sep != *p) && ('\n' != *p))
+						++p;
+
+					len = static_cast<std::size_t>(p - text);
+					if (len && ('\r' == text[len - 1]) && ((p == end) || ('\n' == *p)))
+						--len;
+				}
+
+				fn(rows, col++, text, len, escaped);
+
+				if ((p < end) && (fmt.sep == *p))
+				{
+					++p;
+					continue;
+				}
+				break;
+			}
+
+			if (p < end)
+				++p;	//Skips the LF
+			++rows;
+		}
+		return rows;
+	}
+
+	//Copies the text of a field to out and replaces the doubled quotation marks if it is escaped. The out may be null
+	//to calculate the length. Returns the length of the unescaped text.
+	inline std::size_t unescape(const char* text, std::size_t len, bool escaped, char* out)
+	{
+		if (!escaped)
+		{
+			if (out && len)
+				std::memcpy(out, text, len);
+			return len;
+		}
+
+		std::size_t n = 0;
+		for (std::size_t i = 0; i < len; ++i)
+		{
+			if (out)
+				out[n] = text[i];
+			++n;
+
+			if ('"' == text[i])
+				++i;
+		}
+		return n;
+	}
+
+	//Writes delimited text through an output function in chunks, the output function is invoked when the buffer is
+	//full and when flush() is called.
+	class delimited_writer
+	{
+		static const std::size_t buffer_size = 0x10000;
+	public:
+		using output_fn = std::function<void(const char*, std::size_t)>;
+
+		//The fields which contain the separator, quotation marks or line breaks are quoted if quoted is true.
+		delimited_writer(output_fn output, const std::string& sep, bool quoted)
+			: output_(std::move(output)), sep_(sep), quoted_(quoted)
+		{
+			buf_.reserve(buffer_size);
+		}
+
+		void write(const char* text, std::size_t len)
+		{
+			if (0 == len)
+				return;
+
+			if (buf_.size() + len > buffer_size)
+			{
+				flush();
+
+				//A large text is written directly
+				if (len >= buffer_size)
+				{
+					output_(text, len);
+					return;
+				}
+			}
+			buf_.append(text, len);
+		}
+
+		void write(const std::string& text)
+		{
+			write(text.data(), text.size());
+		}
+
+		void field(const char* text, std::size_t len)
+		{
+			if (!(quoted_ && _m_need_quotes(text, len)))
+			{
+				write(text, len);
+				return;
+			}
+
+			write("\"", 1);
+			for (auto end = text + len; text < end;)
+			{
+				auto p = static_cast<const char*>(std::memchr(text, '"', end - text));
+				if (!p)
+				{
+					write(text, end - text);
+					break;
+				}
+
+				write(text, p - text + 1);
+				write("\"", 1);
+				text = p + 1;
+			}
+			write("\"", 1);
+		}
+
+		void flush()
+		{
+			if (!buf_.empty())
+			{
+				output_(buf_.data(), buf_.size());
+				buf_.clear();
+			}
+		}
+	private:
+		bool _m_need_quotes(const char* text, std::size_t len) const
+		{
+			for (std::size_t i = 0; i < len; ++i)
+			{
+				auto const ch = text[i];
+				if (('"' == ch) || ('\n' == ch) || ('\r' == ch))
+					return true;
+
+				if (!sep_.empty() && (sep_[0] == ch) && (0 == sep_.compare(0, sep_.size(), text + i, (std::min)(sep_.size(), len - i))))
+					return true;
+			}
+			return false;
+		}
+	private:
+		output_fn output_;
+		std::string const sep_;
+		bool const quoted_;
+		std::string buf_;
+	};
+}
+}
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ *	A Parallel Sort Implementation
+ *	Nana C++ Library(http://www.nanapro.org)
+ *	Copyright(C) 2017 Jinhao(cnjinhao@hotmail.com)
+ *
+ *	Distributed under the Boost Software License, Version 1.0.
+ *	(See accompanying file LICENSE_1_0.txt or copy at
+ *	http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *	@file: nana/gui/widgets/skeletons/parallel_sort.hpp
+ */
+
+#ifndef NANA_WIDGETS_SKELETONS_PARALLEL_SORT_INCLUDED
+#define NANA_WIDGETS_SKELETONS_PARALLEL_SORT_INCLUDED
+
+#include <nana/threads/pool.hpp>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include <algorithm>
+
+namespace nana { namespace widgets {
+namespace skeletons
+{
+	//Runs fn(0) ... fn(n - 1) by the calling thread and the threads of a shared pool, and returns when all of them are
+	//finished. The first exception thrown by fn is rethrown.
+	template<typename Function>
+	void parallel_for(std::size_t n, Function fn)
+	{
+		auto const hardware_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+		if ((n < 2) || (hardware_threads < 2))
+		{
+			for (std::size_t i = 0; i < n; ++i)
+				fn(i);
+			return;
+		}
+
+		//The state is shared with the tasks, a task may be run after all the indexes are finished, and it
+		//only accesses the fn when it claims an index.
+		struct state
+		{
+			std::mutex mutex;
+			std::condition_variable cond;
+			std::size_t next{ 0 };
+			std::size_t running{ 0 };
+			std::exception_ptr error;
+		};
+
+		auto st = std::make_shared<state>();
+		auto fnptr = &fn;
+
+		auto run = [st, fnptr, n]
+		{
+			std::unique_lock<std::mutex> lock(st->mutex);
+			while (st->next < n)
+			{
+				auto const i = st->next++;
+				++st->running;
+				lock.unlock();
+
+				std::exception_ptr error;
+				try
+				{
+					(*fnptr)(i);
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				lock.lock();
+				if (error && !st->error)
+				{
+					st->error = error;
+					st->next = n;
+				}
+
+				--st->running;
+				st->cond.notify_all();
+			}
+		};
+
+		auto const tasks = (std::min)(std::size_t(hardware_threads) - 1, n - 1);
+		for (std::size_t i = 0; i < tasks; ++i)
+			threads::shared_pool().push(run);
+
+		run();
+
+		//Waits for the claimed indexes, all the indexes are claimed or cancelled when run() returns.
+		std::unique_lock<std::mutex> lock(st->mutex);
+		st->cond.wait(lock, [&st]{ return (0 == st->running); });
+
+		if (st->error)
+			std::rethrow_exception(st->error);
+	}
+
+	//Sorts a range stably. A large range is split into chunks for the threads, the chunks are sorted and then
+	//merged in pairs.
+	template<typename RandomIt, typename Compare>
+	void parallel_stable_sort(RandomIt first, RandomIt last, Compare comp)
+	{
+		static const std::size_t chunk_min = 16384;
+
+		auto const n = static_cast<std::size_t>(last - first);
+		auto const hardware_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+		auto const chunks = (std::min)(std::size_t(hardware_threads), n / chunk_min);
+		if (chunks < 2)
+		{
+			std::stable_sort(first, last, comp);
+			return;
+		}
+
+		std::vector<RandomIt> bounds;
+		for (std::size_t i = 0; i <= chunks; ++i)
+			bounds.push_back(first + static_cast<std::ptrdiff_t>(n * i / chunks));
+
+		parallel_for(chunks, [&bounds, &comp](std::size_t i)
+		{
+			std::stable_sort(bounds[i], bounds[i + 1], comp);
+		});
+
+		//The adjacent chunks are merged, the merged chunk precedes the next one to keep the sort stable.
+		for (std::size_t width = 1; width < chunks; width *= 2)
+		{
+			auto const pairs = (chunks + 2 * width - 1) / (2 * width);
+			parallel_for(pairs, [&bounds, &comp, width, chunks](std::size_t i)
+			{
+				auto const lower = 2 * width * i;
+				auto const middle = (std::min)(lower + width, chunks);
+				auto const upper = (std::min)(lower + 2 * width, chunks);
+				if (middle < upper)
+					std::inplace_merge(bounds[lower], bounds[middle], bounds[upper], comp);
+			});
+		}
+	}
+
+	//Sorts a sequence stably, it takes advantage of a sequence which is almost sorted. The elements which break the
+	//order are taken out, sorted and merged back if they are few. The sorted order is as same as std::stable_sort.
+	template<typename T, typename Compare>
+	void adaptive_stable_sort(std::vector<T>& v, Compare comp, bool parallel)
+	{
+		auto const n = v.size();
+		if (n < 2)
+			return;
+
+		//Counts the elements which are less than the last element in order. An element can't be equal to a later
+		//element which is kept, so merging them back keeps the relative order of equal elements.
+		std::size_t displaced = 0;
+		std::size_t last = 0;
+		for (std::size_t i = 1; i < n; ++i)
+		{
+			if (comp(v[i], v[last]))
+				++displaced;
+			else
+				last = i;
+		}
+
+		if (0 == displaced)
+			return;
+
+		if (displaced > n / 8)
+		{
+			if (parallel)
+				parallel_stable_sort(v.begin(), v.end(), comp);
+			else
+				std::stable_sort(v.begin(), v.end(), comp);
+			return;
+		}
+
+		std::vector<T> out;
+		out.reserve(displaced);
+
+		std::size_t kept = 1;
+		for (std::size_t i = 1; i < n; ++i)
+		{
+			if (comp(v[i], v[kept - 1]))
+				out.push_back(v[i]);
+			else
+				v[kept++] = v[i];
+		}
+
+		std::stable_sort(out.begin(), out.end(), comp);
+		std::copy(out.begin(), out.end(), v.begin() + kept);
+		std::inplace_merge(v.begin(), v.begin() + kept, v.end(), comp);
+	}
+}
+}
+}
+
+#endif
@@ -16,20 +16,103 @@
 #include <nana/system/dataexch.hpp>
 #include <nana/unicode_bidi.hpp>
 #include <nana/gui/widgets/widget.hpp>
+#include <nana/gui/timer.hpp>
 #include "content_view.hpp"
+#include "text_finder.hpp"
 
 #include <deque>
 #include <numeric>
 #include <cwctype>
+#include <cctype>
 #include <cstring>
 #include <algorithm>
 #include <map>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 namespace nana{	namespace widgets
 {
 	namespace skeletons
 	{
 
+		//The texts of undoable commands. They are appended contiguously in the order of commands, and the texts of
+		//the oldest commands are released from the front when the commands are dropped.
+		class undo_text_arena
+		{
+		public:
+			struct span
+			{
+				std::size_t offset{ 0 };	//The offset from the beginning of the texts which are ever appended.
+				std::size_t length{ 0 };
+			};
+
+			std::size_t end() const
+			{
+				return base_ + buf_.size();
+			}
+
+			/// Returns the number of characters which are not released.
+			std::size_t size() const
+			{
+				return end() - front_;
+			}
+
+			span append(const std::wstring& text)
+			{
+				span s;
+				s.offset = end();
+				s.length = text.size();
+
+				buf_ += text;
+				return s;
+			}
+
+			wchar_t at(std::size_t offset) const
+			{
+				return buf_[offset - base_];
+			}
+
+			/// Returns the text of a span, the text is reversed if reversed is true.
+			std::wstring text(const span& s, bool reversed) const
+			{
+				auto first = buf_.cbegin() + (s.offset - base_);
+				if (reversed)
+					return std::wstring(std::wstring::const_reverse_iterator(first + s.length), std::wstring::const_reverse_iterator(first));
+
+				return std::wstring(first, first + s.length);
+			}
+
+			/// Releases the texts before the offset. The buffer is compacted when the most part of it is released.
+			void release(std::size_t offset)
+			{
+				front_ = offset;
+				if ((front_ - base_ > 0x1000) && (front_ - base_ > buf_.size() / 2))
+				{
+					buf_.erase(0, front_ - base_);
+					base_ = front_;
+				}
+			}
+
+			/// Drops the texts from the offset to the end.
+			void truncate(std::size_t offset)
+			{
+				buf_.resize(offset - base_);
+			}
+
+			void clear()
+			{
+				std::wstring{}.swap(buf_);
+				base_ = front_ = 0;
+			}
+		private:
+			std::wstring buf_;
+			std::size_t base_{ 0 };		//The offset of the first character of buf_
+			std::size_t front_{ 0 };	//The texts before it are released.
+		};
+
 		template<typename EnumCommand>
 		class undoable_command_interface
 		{
@@ -37,20 +120,31 @@ namespace nana{	namespace widgets
 			virtual ~undoable_command_interface() = default;
 
 			virtual EnumCommand get() const = 0;
-			virtual bool merge(const undoable_command_interface&) = 0;
+
+			/// Merges a command which is not stored. The texts of the command are appended to the arena if it is merged.
+			virtual bool merge(const undoable_command_interface&, undo_text_arena&) = 0;
+
+			/// Moves the texts of the command into the arena, it is invoked when the command is recorded.
+			virtual void store(undo_text_arena&) = 0;
 			virtual void execute(bool redo) = 0;
 		};
 
 		template<typename EnumCommand>
 		class undoable
 		{
+			struct entry
+			{
+				std::unique_ptr<undoable_command_interface<EnumCommand>> cmd;
+				std::size_t mark;	//The end of the arena before the texts of the command are stored.
+			};
 		public:
 			using command = EnumCommand;
-			using container = std::deque<std::unique_ptr<undoable_command_interface<command>>>;
+			using container = std::deque<entry>;
 
 			void clear()
 			{
 				commands_.clear();
+				arena_.clear();
 				pos_ = 0;
 			}
 
@@ -58,7 +152,7 @@ namespace nana{	namespace widgets
 			{
 				max_steps_ = maxs;
 				if (maxs && (commands_.size() >= maxs))
-					commands_.erase(commands_.begin(), commands_.begin() + (commands_.size() - maxs + 1));
+					_m_drop_front(commands_.size() - maxs + 1);
 			}
 
 			std::size_t max_steps() const
@@ -66,6 +160,14 @@ namespace nana{	namespace widgets
 				return max_steps_;
 			}
 
+			/// Sets the maximum bytes of the texts which are kept for the commands, 0 means unlimited.
+			/// The latest command is always kept even if its texts exceed the limit.
+			void max_bytes(std::size_t bytes)
+			{
+				max_bytes_ = bytes;
+				_m_trim();
+			}
+
 			void enable(bool enb)
 			{
 				enabled_ = enb;
@@ -84,19 +186,29 @@ namespace nana{	namespace widgets
 					return;
 
 				if (pos_ < commands_.size())
+				{
+					arena_.truncate(commands_[pos_].mark);
 					commands_.erase(commands_.begin() + pos_, commands_.end());
+				}
 				else if (max_steps_ && (commands_.size() >= max_steps_))
-					commands_.erase(commands_.begin(), commands_.begin() + (commands_.size() - max_steps_ + 1));
+					_m_drop_front(commands_.size() - max_steps_ + 1);
 
 				pos_ = commands_.size();
 				if (!commands_.empty())
 				{
-					if (commands_.back().get()->merge(*ptr))
+					if (commands_.back().cmd->merge(*ptr, arena_))
+					{
+						_m_trim();
 						return;
+					}
 				}
 
-				commands_.emplace_back(std::move(ptr));
+				auto const mark = arena_.end();
+				ptr->store(arena_);
+				commands_.push_back(entry{ std::move(ptr), mark });
 				++pos_;
+
+				_m_trim();
 			}
 
 			std::size_t count(bool is_undo) const
@@ -109,23 +221,51 @@ namespace nana{	namespace widgets
 				if (pos_ > 0)
 				{
 					--pos_;
-					commands_[pos_].get()->execute(false);
+					commands_[pos_].cmd->execute(false);
 				}
 			}
 
 			void redo()
 			{
 				if (pos_ != commands_.size())
-					commands_[pos_++].get()->execute(true);
+					commands_[pos_++].cmd->execute(true);
 			}
+		private:
+			//Drops the oldest commands until the texts of the rest commands are within the byte limit. Only the undoable
+			//commands are dropped, the redoable commands are kept until they are discarded by a new command.
+			void _m_trim()
+			{
+				std::size_t drops = 0;
+				while (max_bytes_ && (drops < pos_) && (drops + 1 < commands_.size()) && ((arena_.end() - commands_[drops].mark) * sizeof(wchar_t) > max_bytes_))
+					++drops;
+
+				_m_drop_front(drops);
+			}
+
+			//Drops the oldest commands, at most the commands before the current position are dropped, because a redoable
+			//command can't be executed without the commands before it.
+			void _m_drop_front(std::size_t n)
+			{
+				n = (std::min)(n, pos_);
+				if (0 == n)
+					return;
+
+				commands_.erase(commands_.begin(), commands_.begin() + n);
+				pos_ -= n;
 
+				if (commands_.empty())
+					arena_.clear();
+				else
+					arena_.release(commands_.front().mark);
+			}
 		private:
 			container commands_;
+			undo_text_arena arena_;
 			bool		enabled_{ true };
 			std::size_t max_steps_{ 30 };
+			std::size_t max_bytes_{ 0 };
 			std::size_t pos_{ 0 };
 		};
-
 		template<typename T>
 		using undo_command_ptr = std::unique_ptr <undoable_command_interface<T>> ;
 
@@ -160,15 +300,40 @@ namespace nana{	namespace widgets
 				return cmd_;
 			}
 
-			virtual bool merge(const undoable_command_interface<EnumCommand>&) override
+			bool merge(const undoable_command_interface<EnumCommand>&, undo_text_arena&) override
 			{
 				return false;
 			}
+
+			void store(undo_text_arena& arena) override
+			{
+				arena_ = &arena;
+				selected_ = arena.append(selected_text_);
+				std::wstring{}.swap(selected_text_);
+			}
+
+			std::wstring _m_text(const undo_text_arena::span& s, bool reversed = false) const
+			{
+				return arena_->text(s, reversed);
+			}
+
+			bool _m_is_enter(const undo_text_arena::span& s) const
+			{
+				return ((s.length == 1) && ('\n' == arena_->at(s.offset)));
+			}
+
+			//Determines whether a text is a single character of keystroke which can be merged.
+			static bool _m_keystroke(const std::wstring& text)
+			{
+				return ((text.size() == 1) && ('\n' != text[0]) && ('\r' != text[0]));
+			}
 		protected:
 			text_editor & editor_;
 			upoint			pos_;
 			upoint			sel_a_, sel_b_;
-			std::wstring	selected_text_;
+			std::wstring	selected_text_;			//It is moved into the arena when the command is stored.
+			undo_text_arena::span selected_;
+			undo_text_arena* arena_{ nullptr };
 		private:
 			const EnumCommand cmd_;
 		};
@@ -187,12 +352,44 @@ namespace nana{	namespace widgets
 				selected_text_ = std::move(str);
 			}
 
+			//Merges the characters which are removed one by one by backspace or delete.
+			bool merge(const undoable_command_interface<command>& other, undo_text_arena& arena) override
+			{
+				if (other.get() != command::backspace)
+					return false;
+
+				auto & bs = static_cast<const undo_backspace&>(other);
+				if ((sel_a_ != sel_b_) || (bs.sel_a_ != bs.sel_b_) || !bs._m_keystroke(bs.selected_text_))
+					return false;
+
+				//The removed text must be the last text of the arena for appending the other one.
+				if ((0 == selected_.length) || (selected_.offset + selected_.length != arena.end()) || _m_is_enter(selected_))
+					return false;
+
+				if (bs.pos_ == pos_ && !reversed_)
+				{
+					//Delete, the characters are removed at a same position.
+				}
+				else if ((bs.pos_.y == pos_.y) && (bs.pos_.x + 1 == pos_.x) && (reversed_ || 1 == selected_.length))
+				{
+					//Backspace, the characters are removed from right to left and they are kept in reversed order.
+					reversed_ = true;
+					pos_ = bs.pos_;
+				}
+				else
+					return false;
+
+				arena.append(bs.selected_text_);
+				++selected_.length;
+				return true;
+			}
+
 			void execute(bool redo) override
 			{
 				editor_._m_cancel_select(0);
 				editor_.points_.caret = pos_;
 
-				bool is_enter = ((selected_text_.size() == 1) && ('\n' == selected_text_[0]));
+				bool is_enter = _m_is_enter(selected_);
 				if (redo)
 				{
 					if (sel_a_ != sel_b_)
@@ -211,7 +408,7 @@ namespace nana{	namespace widgets
 							editor_.backspace(false);
 						}
 						else
-							editor_.textbase().erase(pos_.y, pos_.x, selected_text_.size());
+							editor_.textbase().erase(pos_.y, pos_.x, selected_.length);
 					}
 				}
 				else
@@ -222,7 +419,7 @@ namespace nana{	namespace widgets
 					}
 					else
 					{
-						editor_._m_put(selected_text_);
+						editor_._m_put(_m_text(selected_, reversed_));
 						if (sel_a_ != sel_b_)
 						{
 							editor_.select_.a = sel_a_;
@@ -230,12 +427,14 @@ namespace nana{	namespace widgets
 							editor_.points_.caret = sel_b_;
 						}
 						else
-							++editor_.points_.caret.x;
+							editor_.points_.caret.x += static_cast<unsigned>(selected_.length);
 					}
 				}
 
 				editor_.move_caret(editor_.points_.caret);
 			}
+		private:
+			bool reversed_{ false };	//true if the removed text is kept in reversed order.
 		};
 
 		class text_editor::undo_input_text
@@ -244,13 +443,45 @@ namespace nana{	namespace widgets
 		public:
 			undo_input_text(text_editor & editor, const std::wstring& text)
 				:	basic_undoable<command>(editor, command::input_text),
-					text_(text)
+					text_(text),
+					keystroke_(_m_keystroke(text))
+			{
+			}
+
+			//Merges the characters which are typed one by one, the typed text is split into words.
+			bool merge(const undoable_command_interface<command>& other, undo_text_arena& arena) override
+			{
+				if (other.get() != command::input_text)
+					return false;
+
+				auto & in = static_cast<const undo_input_text&>(other);
+				if (!keystroke_ || !in.keystroke_ || selected_.length || !in.selected_text_.empty())
+					return false;
+
+				//The typed text must be the last text of the arena for appending the other one.
+				if ((text_span_.offset + text_span_.length != arena.end()) || (in.pos_ != upoint(pos_.x + static_cast<unsigned>(text_span_.length), pos_.y)))
+					return false;
+
+				auto const last = arena.at(text_span_.offset + text_span_.length - 1);
+				if (std::iswspace(last) && !std::iswspace(in.text_[0]))
+					return false;
+
+				arena.append(in.text_);
+				++text_span_.length;
+				return true;
+			}
+
+			void store(undo_text_arena& arena) override
 			{
+				//The text_ is stored after the selected text, it allows the merged characters to be appended.
+				basic_undoable<command>::store(arena);
+				text_span_ = arena.append(text_);
+				std::wstring{}.swap(text_);
 			}
 
 			void execute(bool redo) override
 			{
-				bool is_enter = (text_.size() == 1 && '\n' == text_[0]);
+				bool is_enter = _m_is_enter(text_span_);
 				editor_._m_cancel_select(0);
 				editor_.points_.caret = pos_;	//The pos_ specifies the caret position before input
 
@@ -262,13 +493,13 @@ namespace nana{	namespace widgets
 					}
 					else
 					{
-						if (!selected_text_.empty())
+						if (selected_.length)
 						{
 							editor_.select_.a = sel_a_;
 							editor_.select_.b = sel_b_;
 							editor_._m_erase_select();
 						}
-						editor_.points_.caret = editor_._m_put(text_); //redo
+						editor_.points_.caret = editor_._m_put(_m_text(text_span_)); //redo
 					}
 				}
 				else
@@ -282,7 +513,7 @@ namespace nana{	namespace widgets
 					else
 					{
 						std::vector<std::pair<std::size_t, std::size_t>> lines;
-						if (editor_._m_resolve_text(text_, lines))
+						if (editor_._m_resolve_text(_m_text(text_span_), lines))
 						{
 							editor_.select_.a = pos_;
 							editor_.select_.b = upoint(static_cast<unsigned>(lines.back().second - lines.back().first), static_cast<unsigned>(pos_.y + lines.size() - 1));
@@ -290,13 +521,13 @@ namespace nana{	namespace widgets
 							editor_.select_.a = editor_.select_.b;
 						}
 						else
-							editor_.textbase().erase(pos_.y, pos_.x, text_.size());	//undo
+							editor_.textbase().erase(pos_.y, pos_.x, text_span_.length);	//undo
 					}
 
-					if (!selected_text_.empty())
+					if (selected_.length)
 					{
 						editor_.points_.caret = (std::min)(sel_a_, sel_b_);
-						editor_._m_put(selected_text_);
+						editor_._m_put(_m_text(selected_));
 						editor_.points_.caret = sel_b_;
 						editor_.select_.a = sel_a_;	//Reset the selected text
 						editor_.select_.b = sel_b_;
@@ -305,7 +536,9 @@ namespace nana{	namespace widgets
 				editor_.move_caret(editor_.points_.caret);
 			}
 		private:
-			std::wstring text_;
+			std::wstring text_;	//It is moved into the arena when the command is stored.
+			undo_text_arena::span text_span_;
+			const bool keystroke_;
 		};
 
 		class text_editor::undo_move_text
@@ -353,6 +586,55 @@ namespace nana{	namespace widgets
 			nana::upoint dest_a_, dest_b_;
 		};
 
+		class text_editor::undo_replace_text
+			: public basic_undoable <command>
+		{
+			struct line_rep
+			{
+				std::size_t line;
+				undo_text_arena::span before;
+				undo_text_arena::span after;
+			};
+		public:
+			undo_replace_text(text_editor& editor)
+				:	basic_undoable<command>(editor, command::replace_text)
+			{}
+
+			void add_line(std::size_t line, const std::wstring& before, const std::wstring& after)
+			{
+				replaced_.emplace_back(line, std::make_pair(before, after));
+			}
+
+			void store(undo_text_arena& arena) override
+			{
+				basic_undoable<command>::store(arena);
+				for (auto & r : replaced_)
+				{
+					line_rep ln;
+					ln.line = r.first;
+					ln.before = arena.append(r.second.first);
+					ln.after = arena.append(r.second.second);
+					lines_.push_back(ln);
+				}
+				decltype(replaced_){}.swap(replaced_);
+			}
+
+			void execute(bool redo) override
+			{
+				editor_._m_cancel_select(0);
+
+				auto & tb = editor_.textbase();
+				for (auto & ln : lines_)
+					tb.replace(ln.line, _m_text(redo ? ln.after : ln.before));
+
+				editor_.points_.caret = pos_;
+				editor_.move_caret(pos_);
+			}
+		private:
+			std::vector<std::pair<std::size_t, std::pair<std::wstring, std::wstring>>> replaced_;	//It is moved into the arena when the command is stored.
+			std::vector<line_rep> lines_;
+		};
+
 		struct text_editor::text_section
 		{
 			const wchar_t* begin{ nullptr };
@@ -391,6 +673,522 @@ namespace nana{	namespace widgets
 			const keyword_scheme * scheme;
 		};
 
+		//A matcher of keywords which is built by Aho-Corasick algorithm, it finds all keywords in a pass of text.
+		//The keywords are matched in the case-folded form, a case-sensitive keyword should be verified when it is matched.
+		class keyword_automaton
+		{
+			struct node
+			{
+				std::size_t depth;
+				std::size_t fail;
+				std::size_t dict;		//The nearest node on the failure chain that has outputs, 0 if there isn't.
+				std::size_t edge_first, edge_last;
+				std::size_t out_first, out_last;
+			};
+		public:
+			static wchar_t fold(wchar_t ch)
+			{
+				//Same as casei_char_traits which is used by ciwstring. std::toupper is only defined for
+				//the values of unsigned char, wchar_t is signed on some platforms.
+				return ((0 <= ch && ch < 0x100) ? static_cast<wchar_t>(std::toupper(ch)) : ch);
+			}
+
+			void invalidate()
+			{
+				built_ = false;
+			}
+
+			void prepare(const std::deque<keyword_desc>& base)
+			{
+				if (built_)
+					return;
+
+				built_ = true;
+				nodes_.clear();
+				edges_.clear();
+				outputs_.clear();
+
+				//Builds the trie
+				std::vector<std::map<wchar_t, std::size_t>> trie(1);
+				std::vector<std::vector<std::size_t>> own(1);
+				std::vector<std::size_t> depth(1, 0);
+
+				std::size_t kw = 0;
+				for (auto & ds : base)
+				{
+					if (!ds.text.empty())
+					{
+						std::size_t state = 0;
+						for (auto ch : ds.text)
+						{
+							auto const key = fold(ch);
+							auto i = trie[state].find(key);
+							if (i != trie[state].end())
+							{
+								state = i->second;
+								continue;
+							}
+
+							auto const child = trie.size();
+							trie[state][key] = child;
+							trie.emplace_back();
+							own.emplace_back();
+							depth.push_back(depth[state] + 1);
+							state = child;
+						}
+						own[state].push_back(kw);
+					}
+					++kw;
+				}
+
+				nodes_.resize(trie.size());
+				for (std::size_t i = 0; i < trie.size(); ++i)
+				{
+					auto & nd = nodes_[i];
+					nd.depth = depth[i];
+					nd.fail = nd.dict = 0;
+
+					nd.edge_first = edges_.size();
+					for (auto & e : trie[i])
+						edges_.emplace_back(e.first, e.second);
+					nd.edge_last = edges_.size();
+
+					nd.out_first = outputs_.size();
+					outputs_.insert(outputs_.end(), own[i].begin(), own[i].end());
+					nd.out_last = outputs_.size();
+				}
+
+				//Makes the failure links in breadth-first order
+				std::deque<std::size_t> queue;
+				for (auto e = nodes_[0].edge_first; e != nodes_[0].edge_last; ++e)
+					queue.push_back(edges_[e].second);
+
+				while (!queue.empty())
+				{
+					auto const state = queue.front();
+					queue.pop_front();
+
+					for (auto e = nodes_[state].edge_first; e != nodes_[state].edge_last; ++e)
+					{
+						auto const ch = edges_[e].first;
+						auto const child = edges_[e].second;
+
+						std::size_t fail = nodes_[state].fail;
+						auto next = _m_goto(fail, ch);
+						while (npos == next && fail)
+						{
+							fail = nodes_[fail].fail;
+							next = _m_goto(fail, ch);
+						}
+
+						auto & nd = nodes_[child];
+						nd.fail = (npos == next ? 0 : next);
+
+						auto & fnd = nodes_[nd.fail];
+						nd.dict = (fnd.out_first != fnd.out_last ? nd.fail : fnd.dict);
+
+						queue.push_back(child);
+					}
+				}
+			}
+
+			//Finds the keywords in the text, the fn is invoked with the position and the index of matched keyword.
+			template<typename Function>
+			void match(const wchar_t* text, std::size_t len, Function fn) const
+			{
+				std::size_t state = 0;
+				for (std::size_t i = 0; i < len; ++i)
+				{
+					auto const ch = fold(text[i]);
+
+					auto next = _m_goto(state, ch);
+					while (npos == next && state)
+					{
+						state = nodes_[state].fail;
+						next = _m_goto(state, ch);
+					}
+					state = (npos == next ? 0 : next);
+
+					auto out = state;
+					if (nodes_[out].out_first == nodes_[out].out_last)
+						out = nodes_[out].dict;
+
+					for (; out; out = nodes_[out].dict)
+					{
+						auto & nd = nodes_[out];
+						for (auto k = nd.out_first; k != nd.out_last; ++k)
+							fn(i + 1 - nd.depth, outputs_[k]);
+					}
+				}
+			}
+		private:
+			std::size_t _m_goto(std::size_t state, wchar_t ch) const
+			{
+				auto const first = edges_.begin() + nodes_[state].edge_first;
+				auto const last = edges_.begin() + nodes_[state].edge_last;
+
+				auto i = std::lower_bound(first, last, ch, [](const std::pair<wchar_t, std::size_t>& e, wchar_t c)
+				{
+					return e.first < c;
+				});
+
+				return ((i != last && i->first == ch) ? i->second : npos);
+			}
+		private:
+			bool built_{ false };
+			std::vector<node> nodes_;
+			std::vector<std::pair<wchar_t, std::size_t>> edges_;	//The edges of a node are sorted by the character.
+			std::vector<std::size_t> outputs_;						//The indexes of keywords
+		};
+
+		//The keywords which are parsed from the sections of lines. The cached lines are shifted or dropped by replaying
+		//the changes of textbase, and the whole cache is dropped when the keywords or the schemes are changed.
+		class highlight_cache
+		{
+			static const std::size_t max_lines = 1024;
+			static const std::size_t max_sections = 16;	//The sections of a line, they are different for different wrapping widths.
+		public:
+			struct span
+			{
+				std::size_t offset;	//The offset from the beginning of section
+				std::size_t length;
+				const keyword_scheme * scheme;
+			};
+
+			void clear()
+			{
+				lines_.clear();
+			}
+
+			/// Returns the cached keywords of a section, nullptr if the section is not parsed since the line was changed.
+			const std::vector<span>* find(const skeletons::textbase<wchar_t>& tb, const upoint& text_coord, std::size_t len)
+			{
+				_m_sync(tb);
+
+				auto i = lines_.find(text_coord.y);
+				if (i != lines_.end())
+				{
+					for (auto & sct : i->second)
+					{
+						if (sct.offset == text_coord.x && sct.length == len)
+							return &sct.spans;
+					}
+				}
+				return nullptr;
+			}
+
+			void store(const upoint& text_coord, std::size_t len, std::vector<span>&& spans)
+			{
+				auto i = lines_.find(text_coord.y);
+				if (i == lines_.end())
+				{
+					if (lines_.size() >= max_lines)
+						lines_.clear();
+
+					i = lines_.emplace(text_coord.y, std::vector<section>{}).first;
+				}
+				else if (i->second.size() >= max_sections)
+					i->second.clear();
+
+				i->second.push_back(section{ text_coord.x, len, std::move(spans) });
+			}
+		private:
+			void _m_sync(const skeletons::textbase<wchar_t>& tb)
+			{
+				if (version_ == tb.version())
+					return;
+
+				bool const replayed = tb.changes_since(version_, [this](std::size_t first, std::size_t removed, std::size_t inserted)
+				{
+					auto i = lines_.lower_bound(first);
+					while (i != lines_.end() && i->first < first + removed)
+						i = lines_.erase(i);
+
+					if (removed == inserted)
+						return;
+
+					//Moves the lines behind the changed lines
+					std::vector<std::pair<std::size_t, std::vector<section>>> behind;
+					while (i != lines_.end())
+					{
+						behind.emplace_back(i->first - removed + inserted, std::move(i->second));
+						i = lines_.erase(i);
+					}
+
+					for (auto & ln : behind)
+						lines_.emplace_hint(lines_.end(), ln.first, std::move(ln.second));
+				});
+
+				if (!replayed)
+					lines_.clear();
+
+				version_ = tb.version();
+			}
+		private:
+			struct section
+			{
+				std::size_t offset;	//The offset from the beginning of line
+				std::size_t length;
+				std::vector<span> spans;
+			};
+
+			std::size_t version_{ 0 };	//The version of textbase which the cached lines are synchronized with.
+			std::map<std::size_t, std::vector<section>> lines_;
+		};
+
+		//Tokenizes the lines with a lexer in a worker thread. The lines are copied into a job in batches by the GUI thread,
+		//and the spans of the job are applied when it is finished. The state at the end of each tokenized line is kept,
+		//a changed line is tokenized again from the state of its previous line, and the tokenizing stops when the state
+		//at the end of an unchanged line is not changed.
+		class text_editor::background_lexer
+		{
+			using state_type = text_lexer_interface::state_type;
+
+			static const std::size_t max_job_lines = 4096;
+			static const std::size_t max_job_chars = 0x100000;
+
+			struct job_rep
+			{
+				std::size_t version;
+				std::size_t first;
+				state_type state;	//The state at the beginning of the first line
+				std::vector<std::wstring> lines;
+				std::vector<std::vector<lexer_span>> spans;
+				std::vector<state_type> states;	//The states at the end of the lines
+			};
+		public:
+			struct span
+			{
+				std::size_t begin;
+				std::size_t end;
+				std::size_t scheme;	//The index of the scheme name
+			};
+
+			background_lexer(std::shared_ptr<text_lexer_interface> lexer)
+				: lexer_(std::move(lexer))
+			{
+				thread_ = std::thread([this]{ _m_run(); });
+			}
+
+			~background_lexer()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					exit_ = true;	//It is set with the lock for the waiting worker thread.
+				}
+				cond_.notify_one();
+				thread_.join();
+			}
+
+			/// Determines whether there are lines to be tokenized.
+			bool pending(const skeletons::textbase<wchar_t>& tb) const
+			{
+				return busy_ || (version_ != tb.version()) || (valid_ < tb.lines());
+			}
+
+			/// Synchronizes with the changes of text, applies the finished job and dispatches the next job.
+			/// Returns the range of lines [first, second) whose spans are applied.
+			std::pair<std::size_t, std::size_t> update(const skeletons::textbase<wchar_t>& tb)
+			{
+				_m_sync(tb);
+
+				std::pair<std::size_t, std::size_t> applied{ 0, 0 };
+
+				if (busy_)
+				{
+					std::unique_ptr<job_rep> job;
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						job.swap(done_);
+					}
+
+					if (!job)
+						return applied;
+
+					busy_ = false;
+
+					//The job is dropped if the text is changed after it was dispatched.
+					if ((job->version == version_) && (job->first == valid_))
+						applied = _m_apply(*job);
+				}
+
+				auto const lines = tb.lines();
+				if (valid_ < lines)
+				{
+					std::unique_ptr<job_rep> job(new job_rep);
+					job->version = version_;
+					job->first = valid_;
+					job->state = (valid_ ? lines_[valid_ - 1].state : 0);
+
+					//The lines are peeked to avoid keeping the decoded lines of a mapped file in the add buffer.
+					std::size_t chars = 0;
+					std::wstring buf;
+					for (auto pos = valid_; (pos < lines) && (job->lines.size() < max_job_lines) && (chars < max_job_chars); ++pos)
+					{
+						auto & text = tb.peek(pos, buf);
+						if (&text == &buf)
+							job->lines.push_back(std::move(buf));
+						else
+							job->lines.push_back(text);
+
+						chars += job->lines.back().size();
+					}
+
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						pending_.swap(job);
+					}
+					cond_.notify_one();
+					busy_ = true;
+				}
+
+				return applied;
+			}
+
+			/// Returns the spans of a line, nullptr if the line is not tokenized.
+			const std::vector<span>* spans(std::size_t line) const
+			{
+				return (line < lines_.size() ? &lines_[line].spans : nullptr);
+			}
+
+			const std::string& scheme(std::size_t index) const
+			{
+				return names_[index];
+			}
+		private:
+			void _m_run()
+			{
+				while (true)
+				{
+					std::unique_ptr<job_rep> job;
+					{
+						std::unique_lock<std::mutex> lock(mutex_);
+						cond_.wait(lock, [this]{ return exit_ || pending_; });
+						if (exit_)
+							return;
+
+						job.swap(pending_);
+					}
+
+					auto state = job->state;
+					job->spans.resize(job->lines.size());
+					job->states.reserve(job->lines.size());
+					for (std::size_t i = 0; i < job->lines.size(); ++i)
+					{
+						if (exit_)
+							return;
+
+						state = lexer_->tokenize(state, job->lines[i], job->spans[i]);
+						job->states.push_back(state);
+					}
+
+					std::lock_guard<std::mutex> lock(mutex_);
+					done_.swap(job);
+				}
+			}
+
+			void _m_sync(const skeletons::textbase<wchar_t>& tb)
+			{
+				if (version_ == tb.version())
+					return;
+
+				bool const replayed = tb.changes_since(version_, [this](std::size_t first, std::size_t removed, std::size_t inserted)
+				{
+					if (first < lines_.size())
+					{
+						auto const last = (std::min)(first + removed, lines_.size());
+						lines_.erase(lines_.begin() + first, lines_.begin() + last);
+						lines_.insert(lines_.begin() + first, inserted, line_rep{});
+					}
+
+					valid_ = (std::min)(valid_, first);
+
+					//The lines before edit_bound_ are changed, the tokenizing doesn't stop before it.
+					edit_bound_ = (edit_bound_ > first + removed ? edit_bound_ - removed + inserted : first + inserted);
+				});
+
+				if (!replayed)
+				{
+					lines_.clear();
+					valid_ = 0;
+					edit_bound_ = 0;
+				}
+
+				version_ = tb.version();
+			}
+
+			std::pair<std::size_t, std::size_t> _m_apply(job_rep& job)
+			{
+				auto pos = job.first;
+				for (std::size_t i = 0; i < job.lines.size(); ++i, ++pos)
+				{
+					std::vector<span> spans;
+					spans.reserve(job.spans[i].size());
+					for (auto & sp : job.spans[i])
+					{
+						if (sp.begin < sp.end)
+							spans.push_back(span{ sp.begin, sp.end, _m_scheme(sp.scheme) });
+					}
+
+					if (pos < lines_.size())
+					{
+						bool const converged = (pos >= edit_bound_) && (lines_[pos].state == job.states[i]);
+
+						lines_[pos].spans.swap(spans);
+						lines_[pos].state = job.states[i];
+
+						if (converged)
+						{
+							valid_ = lines_.size();
+							edit_bound_ = 0;
+							return{ job.first, pos + 1 };
+						}
+					}
+					else
+						lines_.push_back(line_rep{ job.states[i], std::move(spans) });
+				}
+
+				valid_ = pos;
+				return{ job.first, pos };
+			}
+
+			std::size_t _m_scheme(const std::string& name)
+			{
+				auto i = scheme_indexes_.find(name);
+				if (i != scheme_indexes_.end())
+					return i->second;
+
+				names_.push_back(name);
+				scheme_indexes_[name] = names_.size() - 1;
+				return names_.size() - 1;
+			}
+		private:
+			struct line_rep
+			{
+				state_type state;	//The state at the end of the line
+				std::vector<span> spans;
+			};
+
+			std::shared_ptr<text_lexer_interface> const lexer_;
+
+			std::thread thread_;
+			std::mutex mutex_;
+			std::condition_variable cond_;
+			std::atomic<bool> exit_{ false };
+			std::unique_ptr<job_rep> pending_;	//The job which is waiting for the worker thread
+			std::unique_ptr<job_rep> done_;		//The job which is finished by the worker thread
+
+			//The members below are accessed by the GUI thread only.
+			bool busy_{ false };			//true if a job is dispatched and not applied.
+			std::size_t version_{ 0 };		//The version of textbase which the lines are synchronized with.
+			std::size_t valid_{ 0 };		//The lines before it are tokenized.
+			std::size_t edit_bound_{ 0 };
+			std::vector<line_rep> lines_;	//The tokenized lines, the lines after valid_ are out of date.
+
+			std::vector<std::string> names_;
+			std::map<std::string, std::size_t> scheme_indexes_;
+		};
+
 		enum class sync_graph
 		{
 			none,
@@ -528,8 +1326,39 @@ namespace nana{	namespace widgets
 			{
 				std::map<std::string, std::shared_ptr<keyword_scheme>> schemes;
 				std::deque<keyword_desc> base;
+				mutable keyword_automaton automaton;	//It is rebuilt when the keywords are changed.
+				mutable highlight_cache cache;
 			}keywords;
 
+			//The matches of highlight_matches(), they are searched when the lines are drawn.
+			struct matches_rep
+			{
+				std::unique_ptr<text_matcher> matcher;
+				std::string scheme;
+				mutable highlight_cache cache;
+			}matches;
+
+			struct lexer_rep
+			{
+				timer tmr;	//It polls the worker thread while there are lines to be tokenized.
+				std::unique_ptr<background_lexer> worker;
+			}lexer;
+
+			//The lines are queued by any thread and they are appended by the GUI thread once per frame.
+			struct stream_rep
+			{
+				timer tmr;
+				std::shared_ptr<line_stream> queue{ std::make_shared<line_stream>() };
+				std::size_t max_lines{ 0 };
+			}stream;
+
+			//The content size is updated periodically while the lines of a loaded file are being indexed.
+			struct indexing_rep
+			{
+				timer tmr;
+				std::size_t lines{ 0 };
+			}indexing;
+
 			std::unique_ptr<content_view> cview;
 		};
 
@@ -560,6 +1389,8 @@ namespace nana{	namespace widgets
 			virtual std::size_t take_lines() const = 0;
 			/// Returns the number of lines that the line of text specified by pos takes.
 			virtual std::size_t take_lines(std::size_t pos) const = 0;
+			/// Returns the number of lines that the lines of text before pos take.
+			virtual std::size_t take_lines_before(std::size_t pos) const = 0;
 		};
 
 		inline bool is_right_text(const unicode_bidi::entity& e)
@@ -578,9 +1409,13 @@ namespace nana{	namespace widgets
 
 			std::vector<text_section> line(std::size_t pos) const override
 			{
-				//Every line of normal behavior only has one text_section
+				//Every line of normal behavior only has one text_section. The section is made when it is
+				//required, it avoids decoding and measuring the lines which are never displayed.
+				auto const & text = editor_.textbase().getline(pos);
+				auto const pixels = _m_measure(pos, text);
+
 				std::vector<text_section> sections;
-				sections.emplace_back(this->sections_[pos]);
+				sections.emplace_back(text.c_str(), text.c_str() + text.size(), pixels);
 				return sections;
 			}
 
@@ -600,88 +1435,50 @@ namespace nana{	namespace widgets
 					0 };
 			}
 
+			//Returns the pixels of the widest line which is measured. The lines are measured when they are displayed, and the
+			//longest line in characters is measured as well, so the lines which are never displayed are not decoded.
 			unsigned max_pixels() const override
 			{
-				unsigned px = editor_.width_pixels();
-				for (auto & sct : sections_)
-				{
-					if (sct.pixels > px)
-						px = sct.pixels;
-				}
-				return px;
-			}
-
-			void merge_lines(std::size_t first, std::size_t second) override
-			{
-				if (first > second)
-					std::swap(first, second);
+				auto & tb = editor_.textbase();
+				_m_sync();
 
-				if (second < this->sections_.size())
-#ifdef _MSC_VER
-					this->sections_.erase(this->sections_.cbegin() + (first + 1), this->sections_.cbegin() + second);
-#else
-					this->sections_.erase(this->sections_.begin() + (first + 1), this->sections_.begin() + second);
-#endif
-				pre_calc_line(first, 0);
+				auto const maxline = tb.max_line();
+				_m_measure(maxline.first, tb.getline(maxline.first));
 
-				//textbase is implement by using deque, and the linemtr holds the text pointers
-				//If the textbase is changed, it will check the text pointers.
-				std::size_t line = 0;
-
-				auto const & const_sections = sections_;
-				for (auto & sct : const_sections)
+				if (widths_.dirty)
 				{
-					auto const& text = editor_.textbase().getline(line);
-					if (sct.begin < text.c_str() || (text.c_str() + text.size() < sct.begin))
-						pre_calc_line(line, 0);
+					widths_.widest = 0;
+					for (auto px : widths_.pixels)
+					{
+						if (unmeasured != px)
+							widths_.widest = (std::max)(widths_.widest, px);
+					}
 
-					++line;
+					widths_.dirty = false;
 				}
+
+				return (std::max)(editor_.width_pixels(), widths_.widest);
 			}
 
-			void add_lines(std::size_t pos, std::size_t line_size) override
+			void merge_lines(std::size_t, std::size_t) override
 			{
-				if (pos < this->sections_.size())
-				{
-					for (std::size_t i = 0; i < line_size; ++i)
-#ifdef _MSC_VER
-						this->sections_.emplace(this->sections_.cbegin() + (pos + i));
-#else
-						this->sections_.emplace(this->sections_.begin() + (pos + i));
-#endif
-					//textbase is implement by using deque, and the linemtr holds the text pointers
-					//If the textbase is changed, it will check the text pointers.
-					std::size_t line = 0;
+				//The widths of lines are synchronized with the changes of textbase.
+			}
 
-					auto const & const_sections = sections_;
-					for (auto & sct : const_sections)
-					{
-						if (line < pos || (pos + line_size) <= line)
-						{
-							auto const & text = editor_.textbase().getline(line);
-							if (sct.begin < text.c_str() || (text.c_str() + text.size() < sct.begin))
-								pre_calc_line(line, 0);
-						}
-						++line;
-					}
-				}
+			void add_lines(std::size_t, std::size_t) override
+			{
 			}
 
-			void pre_calc_line(std::size_t pos, unsigned) override
+			void pre_calc_line(std::size_t, unsigned) override
 			{
-				auto const & text = editor_.textbase().getline(pos);
-				auto& txt_section = this->sections_[pos];
-				txt_section.begin = text.c_str();
-				txt_section.end = txt_section.begin + text.size();
-				txt_section.pixels = editor_._m_text_extent_size(txt_section.begin, text.size()).width;
 			}
 
 			void pre_calc_lines(unsigned) override
 			{
-				auto const line_count = editor_.textbase().lines();
-				this->sections_.resize(line_count);
-				for (std::size_t i = 0; i < line_count; ++i)
-					pre_calc_line(i, 0);
+				//The font may be changed, all the lines should be measured again.
+				widths_.pixels.clear();
+				widths_.widest = 0;
+				widths_.dirty = false;
 			}
 
 			std::size_t take_lines() const override
@@ -693,28 +1490,201 @@ namespace nana{	namespace widgets
 			{
 				return 1;
 			}
+
+			std::size_t take_lines_before(std::size_t pos) const override
+			{
+				return pos;
+			}
 		private:
+			//Returns the pixels of a line, the line is measured if it is not measured yet.
+			unsigned _m_measure(std::size_t pos, const std::wstring& text) const
+			{
+				_m_sync();
+
+				if (widths_.pixels.size() <= pos)
+					widths_.pixels.resize(pos + 1, static_cast<unsigned>(unmeasured));
+
+				auto & px = widths_.pixels[pos];
+				if (unmeasured == px)
+				{
+					px = editor_._m_text_extent_size(text.c_str(), text.size()).width;
+					widths_.widest = (std::max)(widths_.widest, px);
+				}
+				return px;
+			}
+
+			//Moves the widths of the lines which are not changed, and removes the widths of the changed lines.
+			void _m_sync() const
+			{
+				auto & tb = editor_.textbase();
+				if (widths_.version == tb.version())
+					return;
+
+				bool const replayed = tb.changes_since(widths_.version, [this](std::size_t first, std::size_t removed, std::size_t inserted)
+				{
+					auto & pixels = widths_.pixels;
+					if (first >= pixels.size())
+						return;
+
+					//The widths of replaced lines are reset in place, only the difference of the numbers of lines
+					//moves the widths behind, so that an edit in a line doesn't move the widths of all lines.
+					auto const last = (std::min)(first + removed, pixels.size());
+					auto const reset_end = first + (std::min)(last - first, inserted);
+					for (auto i = first; i < last; ++i)
+					{
+						if (pixels[i] == widths_.widest)
+							widths_.dirty = true;
+
+						if (i < reset_end)
+							pixels[i] = unmeasured;
+					}
+
+					if (reset_end < last)
+						pixels.erase(pixels.begin() + reset_end, pixels.begin() + last);
+					else
+						pixels.insert(pixels.begin() + reset_end, inserted - (reset_end - first), static_cast<unsigned>(unmeasured));
+				});
+
+				if (!replayed)
+				{
+					widths_.pixels.clear();
+					widths_.widest = 0;
+					widths_.dirty = false;
+				}
+
+				widths_.version = tb.version();
+			}
+		private:
+			static const unsigned unmeasured = static_cast<unsigned>(-1);
+
 			text_editor& editor_;
-			std::vector<text_section> sections_;
+
+			struct line_widths
+			{
+				std::vector<unsigned> pixels;	//The pixels of lines, it is unmeasured if a line is not measured yet.
+				unsigned widest{ 0 };
+				bool dirty{ false };			//Indicates whether the widest line may be removed.
+				std::size_t version{ 0 };		//The version of textbase which the widths are synchronized with.
+			};
+			mutable line_widths widths_;
 		}; //end class behavior_normal
 
 
 		class text_editor::behavior_linewrapped
 			: public text_editor::editor_behavior_interface
 		{
+			//A secondary line, it is stored by the offsets in the line of text because the text may be moved.
+			struct row_section
+			{
+				std::size_t begin;
+				std::size_t end;
+				unsigned pixels;
+			};
+
 			struct line_metrics
 			{
-				std::size_t		take_lines;	//The number of lines that text of this line takes.
-				std::vector<text_section>	line_sections;
+				std::size_t		take_lines;	//The number of lines that text of this line takes. It is estimated if the line is not wrapped.
+				bool			wrapped{ false };
+				std::vector<row_section>	line_sections;	//It is only kept for the lines which are displayed.
+
+				explicit line_metrics(std::size_t lines = 0)
+					: take_lines(lines)
+				{}
+			};
+
+			//A Fenwick tree over the numbers of lines that the lines of text take, it maps
+			//between the lines of text and the secondary lines in O(log n).
+			class row_index
+			{
+			public:
+				void assign(const std::vector<line_metrics>& linemtr)
+				{
+					tree_.resize(linemtr.size());
+					total_ = 0;
+					for (std::size_t i = 0; i < linemtr.size(); ++i)
+					{
+						tree_[i] = linemtr[i].take_lines;
+						total_ += tree_[i];
+					}
+
+					for (std::size_t i = 1; i <= tree_.size(); ++i)
+					{
+						auto parent = i + (i & (0 - i));
+						if (parent <= tree_.size())
+							tree_[parent - 1] += tree_[i - 1];
+					}
+
+					top_ = (tree_.empty() ? 0 : 1);
+					while (top_ && (top_ << 1) <= tree_.size())
+						top_ <<= 1;
+				}
+
+				//The difference is added in modular arithmetic, it works when the number of lines decreases.
+				void update(std::size_t pos, std::size_t before, std::size_t after)
+				{
+					auto const diff = after - before;
+					total_ += diff;
+					for (auto i = pos + 1; i <= tree_.size(); i += (i & (0 - i)))
+						tree_[i - 1] += diff;
+				}
+
+				std::size_t total() const
+				{
+					return total_;
+				}
+
+				std::size_t before(std::size_t pos) const
+				{
+					std::size_t lines = 0;
+					for (auto i = (std::min)(pos, tree_.size()); i; i -= (i & (0 - i)))
+						lines += tree_[i - 1];
+
+					return lines;
+				}
+
+				//Returns the line of text that takes the specified secondary line, and the secondary position in the line.
+				//The first is the number of lines if the row is beyond the text.
+				row_coordinate locate(std::size_t row) const
+				{
+					row_coordinate coord;
+					for (auto mask = top_; mask; mask >>= 1)
+					{
+						auto next = coord.first + mask;
+						if (next <= tree_.size() && tree_[next - 1] <= row)
+						{
+							coord.first = next;
+							row -= tree_[next - 1];
+						}
+					}
+					coord.second = row;
+					return coord;
+				}
+			private:
+				std::vector<std::size_t> tree_;
+				std::size_t top_{ 0 };
+				std::size_t total_{ 0 };
 			};
 		public:
 			behavior_linewrapped(text_editor& editor)
 				: editor_(editor)
-			{}
+			{
+				idle_.tmr.interval(20);
+				idle_.tmr.elapse([this]{
+					_m_wrap_in_idle();
+				});
+			}
 
 			std::vector<text_section> line(std::size_t pos) const override
 			{
-				return linemtr_[pos].line_sections;
+				auto & mtr = _m_wrapped(pos, true);
+				auto const text = editor_.textbase().getline(pos).c_str();
+
+				std::vector<text_section> sections;
+				sections.reserve(mtr.line_sections.size());
+				for (auto & sct : mtr.line_sections)
+					sections.emplace_back(text + sct.begin, text + sct.end, sct.pixels);
+
+				return sections;
 			}
 
 			row_coordinate text_position_from_screen(int top) const override
@@ -727,11 +1697,16 @@ namespace nana{	namespace widgets
 
 				auto text_row = (std::max)(0, (top - editor_.text_area_.area.y + editor_.impl_->cview->origin().y) / line_px);
 
-				coord = _m_textline(static_cast<std::size_t>(text_row));
+				coord = rows_.locate(static_cast<std::size_t>(text_row));
 				if (linemtr_.size() <= coord.first)
 				{
 					coord.first = linemtr_.size() - 1;
-					coord.second = linemtr_.back().line_sections.size() - 1;
+					coord.second = _m_wrapped(coord.first, false).take_lines - 1;
+				}
+				else if (coord.second >= _m_wrapped(coord.first, false).take_lines)
+				{
+					//The line took an estimated number of lines before it was wrapped.
+					coord.second = linemtr_[coord.first].take_lines - 1;
 				}
 				return coord;
 			}
@@ -747,7 +1722,11 @@ namespace nana{	namespace widgets
 					std::swap(first, second);
 
 				if (second < linemtr_.size())
+				{
 					linemtr_.erase(linemtr_.begin() + first + 1, linemtr_.begin() + second + 1);
+					rows_.assign(linemtr_);
+					idle_.pos = (std::min)(idle_.pos, first);
+				}
 
 				auto const width_px = editor_.width_pixels();
 
@@ -758,37 +1737,129 @@ namespace nana{	namespace widgets
 			{
 				if (pos < linemtr_.size())
 				{
-					for (std::size_t i = 0; i < lines; ++i)
-						linemtr_.emplace(linemtr_.begin() + pos + i);
+					linemtr_.insert(linemtr_.begin() + pos, lines, line_metrics(1));
+
+					rows_.assign(linemtr_);
+					idle_.pos = (std::min)(idle_.pos, pos);
+				}
+			}
+
+			void pre_calc_line(std::size_t line, unsigned pixels) override
+			{
+				auto const before = linemtr_[line].take_lines;
+				_m_wrap(line, pixels, false);
+				rows_.update(line, before, linemtr_[line].take_lines);
+			}
+
+			//The lines are not wrapped immediately, they are wrapped when they are displayed or in idle time.
+			//The number of lines that a line takes is estimated with the previous width until it is wrapped.
+			void pre_calc_lines(unsigned pixels) override
+			{
+				auto const lines = editor_.textbase().lines();
+				linemtr_.resize(lines, line_metrics(0));
+
+				for (auto & mtr : linemtr_)
+				{
+					if (mtr.take_lines && pixels_ && pixels)
+						mtr.take_lines = (std::max)(std::size_t{ 1 }, (mtr.take_lines * pixels_ + pixels - 1) / pixels);
+					else
+						mtr.take_lines = 1;
+
+					mtr.wrapped = false;
+					mtr.line_sections.clear();
+				}
+
+				pixels_ = pixels;
+				rows_.assign(linemtr_);
+
+				idle_.pos = 0;
+				if (lines)
+					idle_.tmr.start();
+			}
+
+			std::size_t take_lines() const override
+			{
+				return rows_.total();
+			}
+
+			std::size_t take_lines(std::size_t pos) const override
+			{
+				return (pos < linemtr_.size() ? _m_wrapped(pos, false).take_lines : 0);
+			}
+
+			std::size_t take_lines_before(std::size_t pos) const override
+			{
+				return rows_.before(pos);
+			}
+		private:
+			//Returns the metrics of a line, the line is wrapped if it is not wrapped yet or if its sections are
+			//required but not kept.
+			const line_metrics& _m_wrapped(std::size_t line, bool sections) const
+			{
+				auto & mtr = linemtr_[line];
+				if ((!mtr.wrapped) || (sections && mtr.line_sections.empty()))
+				{
+					auto const before = mtr.take_lines;
+					_m_wrap(line, pixels_, sections);
+					rows_.update(line, before, mtr.take_lines);
+				}
+				return mtr;
+			}
+
+			//Wraps the lines which are not wrapped yet in a limited time. The view is kept on the same text
+			//when the lines before the view are wrapped.
+			void _m_wrap_in_idle()
+			{
+				auto const line_px = editor_.line_height();
+				auto & cview = *editor_.impl_->cview;
+
+				auto const origin_y = static_cast<std::size_t>((std::max)(0, cview.origin().y));
+				auto const anchor = rows_.locate(line_px ? origin_y / line_px : 0);
+				auto const rows_before = take_lines();
+
+				auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(8);
+				for (std::size_t n = 0; idle_.pos < linemtr_.size(); ++idle_.pos, ++n)
+				{
+					_m_wrapped(idle_.pos, false);
+
+					if ((n & 0x3F) == 0x3F && std::chrono::steady_clock::now() > deadline)
+						break;
+				}
 
-					//textbase is implement by using deque, and the linemtr holds the text pointers
-					//If the textbase is changed, it will check the text pointers.
-					std::size_t line = 0;
+				if (idle_.pos >= linemtr_.size())
+					idle_.tmr.stop();
 
-					auto const & const_linemtr = linemtr_;
-					for (auto & mtr : const_linemtr)
-					{
-						if (line < pos || (pos + lines) <= line)
-						{
-							auto & linestr = editor_.textbase().getline(line);
-							auto p = mtr.line_sections.front().begin;
-							if (p < linestr.c_str() || (linestr.c_str() + linestr.size() < p))
-								pre_calc_line(line, editor_.width_pixels());
-						}
-						++line;
-					}
+				if (rows_before == take_lines())
+					return;
+
+				editor_._m_reset_content_size(false);
+
+				if (anchor.first < linemtr_.size())
+				{
+					auto const row = rows_.before(anchor.first) + (std::min)(anchor.second, linemtr_[anchor.first].take_lines - 1);
+					auto const y = static_cast<int>(row * line_px + (line_px ? origin_y % line_px : 0));
+					if (cview.move_origin({ 0, y - cview.origin().y }))
+						cview.sync(true);
 				}
+
+				editor_.reset_caret();
+				API::refresh_window(editor_.window_);
 			}
 
-			void pre_calc_line(std::size_t line, unsigned pixels) override
+			//Wraps a line and counts the lines that it takes. The sections are kept if they are required, otherwise the
+			//line is read by peek() so that the lines wrapped in idle time are not kept decoded by the textbase.
+			void _m_wrap(std::size_t line, unsigned pixels, bool keep_sections) const
 			{
-				const string_type& lnstr = editor_.textbase().getline(line);
+				auto & mtr = linemtr_[line];
+				mtr.wrapped = true;
+				mtr.line_sections.clear();
+
+				const string_type& lnstr = (keep_sections ? editor_.textbase().getline(line) : editor_.textbase().peek(line, buf_));
 				if (lnstr.empty())
 				{
-					auto & mtr = linemtr_[line];
-					mtr.line_sections.clear();
+					if (keep_sections)
+						mtr.line_sections.push_back(row_section{ 0, 0, 0 });
 
-					mtr.line_sections.emplace_back(lnstr.c_str(), lnstr.c_str(), unsigned{});
 					mtr.take_lines = 1;
 					return;
 				}
@@ -851,42 +1922,22 @@ namespace nana{	namespace widgets
 					}
 				}
 
-				auto & mtr = linemtr_[line];
+				if (secondary_begin)
+					line_sections.emplace_back(secondary_begin, sections.back().end, unsigned{ text_px });
 
 				mtr.take_lines = line_sections.size();
-				mtr.line_sections.swap(line_sections);
 
-				if (secondary_begin)
+				if (keep_sections)
 				{
-					mtr.line_sections.emplace_back(secondary_begin, sections.back().end, unsigned{ text_px });
-					++mtr.take_lines;
-				}
-			}
-
-			void pre_calc_lines(unsigned pixels) override
-			{
-				auto const lines = editor_.textbase().lines();
-				linemtr_.resize(lines);
-
-				for (std::size_t i = 0; i < lines; ++i)
-					pre_calc_line(i, pixels);
-			}
+					auto const text = lnstr.c_str();
 
-			std::size_t take_lines() const override
-			{
-				std::size_t lines = 0;
-				for (auto & mtr : linemtr_)
-					lines += mtr.take_lines;
-
-				return lines;
+					mtr.line_sections.reserve(line_sections.size());
+					for (auto & sct : line_sections)
+						mtr.line_sections.push_back(row_section{ static_cast<std::size_t>(sct.begin - text), static_cast<std::size_t>(sct.end - text), sct.pixels });
+				}
 			}
 
-			std::size_t take_lines(std::size_t pos) const override
-			{
-				return (pos < linemtr_.size() ? linemtr_[pos].take_lines : 0);
-			}
-		private:
-			void _m_text_section(const std::wstring& str, std::vector<text_section>& tsec)
+			static void _m_text_section(const std::wstring& str, std::vector<text_section>& tsec)
 			{
 				if (str.empty())
 				{
@@ -921,97 +1972,157 @@ namespace nana{	namespace widgets
 					tsec.emplace_back(word, end, unsigned{});
 			}
 
-			row_coordinate _m_textline(std::size_t scrline) const
-			{
-				row_coordinate coord;
-				for (auto & mtr : linemtr_)
-				{
-					if (mtr.take_lines > scrline)
-					{
-						coord.second = scrline;
-						return coord;
-					}
-					else
-						scrline -= mtr.take_lines;
-
-					++coord.first;
-				}
-				return coord;
-			}
 		private:
 			text_editor& editor_;
-			std::vector<line_metrics> linemtr_;
+			mutable std::vector<line_metrics> linemtr_;
+			mutable row_index rows_;
+			unsigned pixels_{ 0 };	//The width that the lines are wrapped with.
+			mutable string_type buf_;	//The buffer that the lines are peeked into when they are wrapped.
+
+			struct idle_rep
+			{
+				timer tmr;
+				std::size_t pos{ 0 };	//The next line to be wrapped in idle time
+			}idle_;
 		}; //end class behavior_linewrapped
 
 		class text_editor::keyword_parser
 		{
 		public:
-			void parse(const std::wstring& text, const implementation::inner_keywords& keywords)
+			void parse(const wchar_t* text, std::size_t len, const implementation::inner_keywords& keywords)
 			{
-				if ( keywords.base.empty() || text.empty() )
+				if ( keywords.base.empty() || (0 == len) )
+					return;
+
+				keywords.automaton.prepare(keywords.base);
+
+				//The matched keywords with the indexes of keywords
+				std::vector<std::pair<entity, std::size_t>> matches;
+
+				keywords.automaton.match(text, len, [&](std::size_t pos, std::size_t kw)
+				{
+					auto & ds = keywords.base[kw];
+
+					if (ds.case_sensitive && std::char_traits<wchar_t>::compare(text + pos, ds.text.c_str(), ds.text.size()))
+						return;
+
+					if (ds.whole_word_matched && (!_m_whole_word(text, len, pos, ds.text.size())))
+						return;
+
+					auto ki = keywords.schemes.find(ds.scheme);
+					if ((ki != keywords.schemes.end()) && ki->second)
+						matches.emplace_back(entity{ text + pos, text + pos + ds.text.size(), ki->second.get() }, kw);
+				});
+
+				if (matches.empty())
 					return;
 
-				using index = std::wstring::size_type;
+				//The keyword which is set earlier takes precedence if two keywords begin at a same position.
+				std::sort(matches.begin(), matches.end(), [](const std::pair<entity, std::size_t>& a, const std::pair<entity, std::size_t>& b)
+				{
+					return (a.first.begin < b.first.begin) || ((a.first.begin == b.first.begin) && (a.second < b.second));
+				});
 
 				std::vector<entity> entities;
+				entities.reserve(matches.size());
 
-				::nana::ciwstring cistr;
-				for (auto & ds : keywords.base)
-				{
-                    index pos{0} ;
-                    for (index rest{text.size()}; rest >= ds.text.size() ; ++pos, rest = text.size() - pos)
-                    {
-					    if (ds.case_sensitive)
-					    {
-						    pos = text.find(ds.text, pos);
-						    if (pos == text.npos)
-							    break;
-					    }
-					    else
-					    {
-						    if (cistr.empty())
-							    cistr.append(text.c_str(), text.size());
-
-						    pos = cistr.find(ds.text.c_str(), pos);
-						    if (pos == cistr.npos)
-							    break;
-					    }
-
-						if (ds.whole_word_matched && (!_m_whole_word(text, pos, ds.text.size())))
-							continue;
-
-					    auto ki = keywords.schemes.find(ds.scheme);
-					    if ((ki != keywords.schemes.end()) && ki->second)
-					    {
-							entities.emplace_back();
-							auto & last = entities.back();
-							last.begin = text.c_str() + pos;
-							last.end = last.begin + ds.text.size();
-							last.scheme = ki->second.get();
-					    }
-                    }
-				}
-
-				if (!entities.empty())
-				{
-					std::sort(entities.begin(), entities.end(), [](const entity& a, const entity& b)
-					{
-						return (a.begin < b.begin);
-					});
+				const wchar_t* bound = nullptr;
+				for (auto & m : matches)
+				{
+					// erase overlaping. Left only the first.
+					if (bound && bound > m.first.begin)
+						continue;
+
+					entities.push_back(m.first);
+					bound = m.first.end;
+				}
 
-					auto i = entities.begin();
-					auto bound = i->end;
+				entities_.swap(entities);
+			}
+
+			/// Parses a section of line, the keywords are cached for the line until it is changed.
+			void parse(const wchar_t* text, std::size_t len, const upoint& text_coord, const implementation::inner_keywords& keywords, const skeletons::textbase<wchar_t>& tb)
+			{
+				if (keywords.base.empty() || (0 == len))
+					return;
+
+				auto spans = keywords.cache.find(tb, text_coord, len);
+				if (spans)
+				{
+					entities_.clear();
+					for (auto & sp : *spans)
+						entities_.push_back(entity{ text + sp.offset, text + sp.offset + sp.length, sp.scheme });
+					return;
+				}
+
+				parse(text, len, keywords);
+
+				std::vector<highlight_cache::span> parsed;
+				parsed.reserve(entities_.size());
+				for (auto & ent : entities_)
+					parsed.push_back(highlight_cache::span{ static_cast<std::size_t>(ent.begin - text), static_cast<std::size_t>(ent.end - ent.begin), ent.scheme });
+
+				keywords.cache.store(text_coord, len, std::move(parsed));
+			}
+
+			/// Takes the spans of a lexer which are in a section of line.
+			void parse(const wchar_t* text, std::size_t len, const upoint& text_coord, const background_lexer& lexer, const implementation::inner_keywords& keywords)
+			{
+				auto spans = lexer.spans(text_coord.y);
+				if ((nullptr == spans) || (0 == len))
+					return;
 
-					for (++i; i != entities.end(); )
+				entities_.clear();
+
+				auto const sct_end = text_coord.x + len;
+				for (auto & sp : *spans)
+				{
+					if ((sp.end <= text_coord.x) || (sct_end <= sp.begin))
+						continue;
+
+					auto ki = keywords.schemes.find(lexer.scheme(sp.scheme));
+					if ((ki == keywords.schemes.end()) || !ki->second)
+						continue;
+
+					auto const begin = (std::max)(sp.begin, std::size_t(text_coord.x)) - text_coord.x;
+					auto const end = (std::min)(sp.end, sct_end) - text_coord.x;
+					entities_.push_back(entity{ text + begin, text + end, ki->second.get() });
+				}
+			}
+
+			/// Appends the matches of highlight_matches() which are in a section of line, they are drawn over the keywords.
+			void append_matches(const wchar_t* text, std::size_t len, const upoint& text_coord, const implementation::matches_rep& matches, const implementation::inner_keywords& keywords, const skeletons::textbase<wchar_t>& tb)
+			{
+				if ((!matches.matcher) || (0 == len))
+					return;
+
+				auto ki = keywords.schemes.find(matches.scheme);
+				if ((ki == keywords.schemes.end()) || !ki->second)
+					return;
+
+				auto spans = matches.cache.find(tb, text_coord, len);
+				if (nullptr == spans)
+				{
+					//The whole line is searched, because a regular expression or a whole word depends on the text around the section.
+					std::vector<highlight_cache::span> found;
+					auto & line = tb.getline(text_coord.y);
+					auto const sct_end = text_coord.x + len;
+					matches.matcher->search(line.c_str(), line.size(), [&](std::size_t begin, std::size_t end)
 					{
-						if (bound > i->begin)
-							i = entities.erase(i);  // erase overlaping. Left only the first.
-						else
-							++i;
-					}
+						if ((end <= text_coord.x) || (sct_end <= begin))
+							return;
+
+						begin = (std::max)(begin, std::size_t(text_coord.x));
+						end = (std::min)(end, sct_end);
+						found.push_back(highlight_cache::span{ begin - text_coord.x, end - begin, ki->second.get() });
+					});
+
+					matches.cache.store(text_coord, len, std::move(found));
+					spans = matches.cache.find(tb, text_coord, len);
 				}
 
-				entities_.swap(entities);
+				for (auto & sp : *spans)
+					entities_.push_back(entity{ text + sp.offset, text + sp.offset + sp.length, sp.scheme });
 			}
 
 			const std::vector<entity>& entities() const
@@ -1019,7 +2130,7 @@ namespace nana{	namespace widgets
 				return entities_;
 			}
 		private:
-			static bool _m_whole_word(const std::wstring& text, std::wstring::size_type pos, std::size_t len)
+			static bool _m_whole_word(const wchar_t* text, std::size_t text_len, std::size_t pos, std::size_t len)
 			{
 				if (pos)
 				{
@@ -1028,7 +2139,7 @@ namespace nana{	namespace widgets
 						return false;
 				}
 
-				if (pos + len < text.size())
+				if (pos + len < text_len)
 				{
 					auto chr = text[pos + len];
 					if ((std::iswalpha(chr) && !std::isspace(chr)) || chr == '_')
@@ -1043,6 +2154,71 @@ namespace nana{	namespace widgets
 
 		//class text_editor
 
+		//class line_stream
+		struct line_stream::node
+		{
+			std::wstring line;
+			node* next;
+		};
+
+		line_stream::~line_stream()
+		{
+			auto p = head_.exchange(nullptr);
+			while (p)
+			{
+				auto next = p->next;
+				delete p;
+				p = next;
+			}
+		}
+
+		bool line_stream::push(std::wstring text)
+		{
+			if (!enabled_)
+				return false;
+
+			std::size_t begin = 0;
+			while (true)
+			{
+				auto end = text.find(L'\n', begin);
+				auto line = (std::wstring::npos == end ? text.substr(begin) : text.substr(begin, end - begin));
+				if (!line.empty() && (L'\r' == line.back()))
+					line.pop_back();
+
+				auto p = new node{ std::move(line), head_.load(std::memory_order_relaxed) };
+				while (!head_.compare_exchange_weak(p->next, p, std::memory_order_release, std::memory_order_relaxed));
+
+				//The text after a trailing new line is not a line.
+				if ((std::wstring::npos == end) || (end + 1 == text.size()))
+					break;
+
+				begin = end + 1;
+			}
+			return true;
+		}
+
+		std::vector<std::wstring> line_stream::take()
+		{
+			std::vector<std::wstring> lines;
+
+			auto p = head_.exchange(nullptr, std::memory_order_acquire);
+			while (p)
+			{
+				lines.emplace_back(std::move(p->line));
+				auto next = p->next;
+				delete p;
+				p = next;
+			}
+			std::reverse(lines.begin(), lines.end());
+			return lines;
+		}
+
+		void line_stream::enable(bool enabled)
+		{
+			enabled_ = enabled;
+		}
+		//end class line_stream
+
 		text_editor::text_editor(window wd, graph_reference graph, const text_editor_scheme* schm)
 			:	impl_(new implementation),
 				window_(wd),
@@ -1074,6 +2250,9 @@ namespace nana{	namespace widgets
 		{
 			//For instance of unique_ptr pimpl idiom.
 
+			//The owner may still keep the queue.
+			impl_->stream.queue->enable(false);
+
 			delete impl_->capacities.behavior;
 			delete impl_;
 		}
@@ -1085,6 +2264,8 @@ namespace nana{	namespace widgets
 
 		void text_editor::set_highlight(const std::string& name, const ::nana::color& fgcolor, const ::nana::color& bgcolor)
 		{
+			impl_->keywords.cache.clear();
+			impl_->matches.cache.clear();
 			if (fgcolor.invisible() && bgcolor.invisible())
 			{
 				impl_->keywords.schemes.erase(name);
@@ -1099,11 +2280,14 @@ namespace nana{	namespace widgets
 
 		void text_editor::erase_highlight(const std::string& name)
 		{
+			impl_->keywords.cache.clear();
+			impl_->matches.cache.clear();
 			impl_->keywords.schemes.erase(name);
 		}
 
 		void text_editor::set_keyword(const ::std::wstring& kw, const std::string& name, bool case_sensitive, bool whole_word_matched)
 		{
+			impl_->keywords.cache.clear();
 			for(auto & ds : impl_->keywords.base)
 			{
 				if (ds.text == kw)
@@ -1116,6 +2300,7 @@ namespace nana{	namespace widgets
 			}
 
 			impl_->keywords.base.emplace_back(kw, name, case_sensitive, whole_word_matched);
+			impl_->keywords.automaton.invalidate();
 		}
 
 		void text_editor::erase_keyword(const ::std::wstring& kw)
@@ -1125,11 +2310,138 @@ namespace nana{	namespace widgets
 				if (kw == i->text)
 				{
 					impl_->keywords.base.erase(i);
+					impl_->keywords.automaton.invalidate();
+					impl_->keywords.cache.clear();
 					return;
 				}
 			}
 		}
 		
+		void text_editor::set_lexer(std::shared_ptr<text_lexer_interface> lexer)
+		{
+			auto & lx = impl_->lexer;
+			lx.tmr.stop();
+			lx.worker.reset();
+
+			if (!lexer)
+				return;
+
+			lx.worker.reset(new background_lexer(std::move(lexer)));
+			lx.tmr.interval(15);
+			lx.tmr.elapse([this]{
+				auto & lx = impl_->lexer;
+
+				auto const applied = lx.worker->update(impl_->textbase);
+				if (!lx.worker->pending(impl_->textbase))
+					lx.tmr.stop();
+
+				if (applied.first == applied.second)
+					return;
+
+				//Refreshes the window if the applied lines are visible.
+				auto const first_line = impl_->capacities.behavior->text_position_from_screen(impl_->cview->view_area().y).first;
+				if ((applied.first <= first_line + screen_lines()) && (first_line < applied.second))
+					API::refresh_window(window_);
+			});
+			lx.tmr.start();
+		}
+
+		std::size_t text_editor::find_all(const std::wstring& pattern, const text_search_options& opt, const std::function<bool(const std::vector<text_range>&)>& fn)
+		{
+			text_matcher matcher(pattern, opt);
+
+			//The lines are read by the threads of finder, they are not read until the indexing is finished.
+			impl_->textbase.complete();
+			return text_finder::find_all(impl_->textbase, matcher, fn);
+		}
+
+		std::size_t text_editor::replace_all(const std::wstring& pattern, const std::wstring& replacement, const text_search_options& opt)
+		{
+			if (!attributes_.editable)
+				return 0;
+
+			text_matcher matcher(pattern, opt);
+
+			auto & tb = impl_->textbase;
+			tb.complete();
+
+			//Finds the lines which have matches in parallel, then the lines are replaced by this thread.
+			std::vector<std::size_t> lines;
+			text_finder::find_all(tb, matcher, [&lines](const std::vector<text_range>& matches)
+			{
+				for (auto & m : matches)
+				{
+					if (lines.empty() || (lines.back() != m.first.y))
+						lines.push_back(m.first.y);
+				}
+				return true;
+			});
+
+			if (lines.empty())
+				return 0;
+
+			//A replacement doesn't break a line.
+			auto const repl = replacement.substr(0, replacement.find_first_of(L"\r\n"));
+
+			std::unique_ptr<undo_replace_text> undo_ptr{ new undo_replace_text(*this) };
+
+			_m_cancel_select(0);
+			undo_ptr->set_caret_pos();
+
+			//The lines are replaced in a batch, the text_changed is emitted once.
+			std::vector<std::pair<std::size_t, std::wstring>> replaced;
+			replaced.reserve(lines.size());
+
+			std::size_t count = 0;
+			for (auto ln : lines)
+			{
+				std::wstring text;
+				count += matcher.replace(tb.getline(ln), repl, text);
+
+				if (impl_->undo.enabled())
+					undo_ptr->add_line(ln, tb.getline(ln), text);
+
+				replaced.emplace_back(ln, std::move(text));
+			}
+
+			tb.replace(std::move(replaced));
+
+			impl_->undo.push(std::move(undo_ptr));
+
+			//The caret may be behind the end of its line.
+			points_.caret.x = (std::min)(points_.caret.x, static_cast<unsigned>(tb.getline(points_.caret.y).size()));
+
+			_m_reset_content_size(true);
+
+			if (graph_)
+			{
+				this->_m_adjust_view();
+
+				reset_caret();
+				impl_->try_refresh = sync_graph::refresh;
+			}
+			return count;
+		}
+
+		void text_editor::highlight_matches(const std::wstring& pattern, const text_search_options& opt, const std::string& scheme)
+		{
+			auto & m = impl_->matches;
+			m.cache.clear();
+
+			if (pattern.empty())
+			{
+				m.matcher.reset();
+				m.scheme.clear();
+			}
+			else
+			{
+				m.matcher.reset(new text_matcher(pattern, opt));
+				m.scheme = scheme;
+			}
+
+			impl_->try_refresh = sync_graph::refresh;
+		}
+
 		colored_area_access_interface& text_editor::colored_area()
 		{
 			return impl_->colored_area;
@@ -1248,6 +2560,32 @@ namespace nana{	namespace widgets
 
 			impl_->try_refresh = sync_graph::refresh;
 			_m_reset_content_size(true);
+
+			auto & idx = impl_->indexing;
+			idx.tmr.stop();
+			if (impl_->textbase.indexing())
+			{
+				idx.lines = impl_->textbase.lines();
+				idx.tmr.interval(100);
+				idx.tmr.elapse([this]{
+					auto & idx = impl_->indexing;
+
+					bool const indexing = impl_->textbase.indexing();
+					auto const lines = impl_->textbase.lines();
+					if (indexing && (lines == idx.lines))
+						return;
+
+					if (!indexing)
+						idx.tmr.stop();
+
+					idx.lines = lines;
+
+					//The wrapped lines are calculated when the indexing is finished.
+					_m_reset_content_size(!(indexing && attributes_.line_wrapped));
+					API::refresh_window(window_);
+				});
+				idx.tmr.start();
+			}
 			return true;
 		}
 
@@ -1913,7 +3251,9 @@ namespace nana{	namespace widgets
 			//otherwise draw the tip string.
 			if ((false == textbase().empty()) || has_focus)
 			{
+				graph_.glyph_run_begin();
 				auto text_pos = _m_render_text(fgcolor);
+				graph_.glyph_run_end();
 				
 				if (text_pos.empty())
 					text_pos.emplace_back(upoint{});
@@ -2203,6 +3543,40 @@ namespace nana{	namespace widgets
 			impl_->undo.max_steps(len);
 		}
 
+		void text_editor::set_undo_memory_limit(std::size_t bytes)
+		{
+			impl_->undo.max_bytes(bytes);
+		}
+
+		void text_editor::stream(bool enable, std::size_t max_lines)
+		{
+			auto & st = impl_->stream;
+			st.max_lines = max_lines;
+			st.queue->enable(enable);
+
+			if (enable)
+			{
+				if (!st.tmr.started())
+				{
+					st.tmr.interval(16);
+					st.tmr.elapse([this]{
+						_m_flush_stream();
+					});
+					st.tmr.start();
+				}
+			}
+			else
+			{
+				st.tmr.stop();
+				_m_flush_stream();
+			}
+		}
+
+		const std::shared_ptr<line_stream>& text_editor::stream_queue() const
+		{
+			return impl_->stream.queue;
+		}
+
 		void text_editor::move_ns(bool to_north)
 		{
 			const bool redraw_required = _m_cancel_select(0);
@@ -2542,11 +3916,7 @@ namespace nana{	namespace widgets
 			auto const behavior = impl_->capacities.behavior;
 			auto const sections = behavior->line(pos.y);
 
-			std::size_t lines = 0;	//lines before the caret line;
-			for (std::size_t i = 0; i < pos.y; ++i)
-			{
-				lines += behavior->take_lines(i);
-			}
+			std::size_t lines = behavior->take_lines_before(pos.y);	//lines before the caret line;
 
 			const text_section * sct_ptr = nullptr;
 			nana::point scrpos;
@@ -2861,6 +4231,69 @@ namespace nana{	namespace widgets
 			impl_->cview->content_size(csize);
 		}
 
+		void text_editor::_m_flush_stream()
+		{
+			auto & st = impl_->stream;
+
+			auto lines = st.queue->take();
+			if (lines.empty())
+				return;
+
+			auto & tb = impl_->textbase;
+			auto const behavior = impl_->capacities.behavior;
+			auto const line_px = static_cast<int>(line_height());
+
+			//The view follows the appended lines if it shows the end of text.
+			auto const view_bottom = impl_->cview->origin().y + static_cast<int>(impl_->cview->view_area().height);
+			bool const follow = (view_bottom + line_px >= static_cast<int>(impl_->cview->content_size().height));
+
+			auto first = lines.begin();
+			if (tb.empty())
+				tb.replace(0, std::move(*first++));
+
+			auto const last_line = tb.lines() - 1;
+			auto const inserted = static_cast<std::size_t>(lines.end() - first);
+			tb.insertln(last_line + 1, std::make_move_iterator(first), std::make_move_iterator(lines.end()));
+
+			behavior->add_lines(last_line, inserted);
+			_m_pre_calc_lines(last_line, inserted + 1);
+
+			if (st.max_lines && (tb.lines() > st.max_lines))
+			{
+				//Discards the oldest lines
+				auto const discards = tb.lines() - st.max_lines;
+				auto const discarded_rows = behavior->take_lines_before(discards);
+
+				tb.erase(0, discards);
+				behavior->merge_lines(0, discards);
+
+				//The undo steps are invalid because the positions of lines are changed.
+				impl_->undo.clear();
+
+				for (auto pt : { &points_.caret, &select_.a, &select_.b })
+				{
+					if (pt->y < discards)
+						*pt = upoint{};
+					else
+						pt->y -= static_cast<unsigned>(discards);
+				}
+
+				if (!follow)
+					impl_->cview->move_origin(point{ 0, -static_cast<int>(discarded_rows) * line_px });
+			}
+
+			_m_reset_content_size(false);
+
+			if (follow)
+			{
+				move_caret_end(false);
+				_m_adjust_view();
+			}
+
+			impl_->try_refresh = sync_graph::refresh;
+			API::refresh_window(window_);
+		}
+
 		void text_editor::_m_reset()
 		{
 			points_.caret.x = points_.caret.y = 0;
@@ -3234,7 +4667,6 @@ namespace nana{	namespace widgets
 			canvas.typeface(graph_.typeface());
 			::nana::point canvas_text_pos;
 
-			auto ent_pos = pos;
 			const auto str_end = str + len;
 			auto & entities = parser.entities();
 
@@ -3261,7 +4693,8 @@ namespace nana{	namespace widgets
 
 					canvas.rectangle(true);
 
-					ent_pos.x += ent_off;
+					//The position of each entity is relative to the beginning of the string.
+					point ent_pos{ pos.x + ent_off, pos.y };
 
 
 					if (rtl)
@@ -3338,9 +4771,25 @@ namespace nana{	namespace widgets
 
 			auto const reordered = unicode_reorder(text_ptr, text_len);
 
-			//Parse highlight keywords
+			//Parse highlight keywords, the keywords of the text are cached unless it is masked.
 			keyword_parser parser;
-			parser.parse({ text_ptr, text_len }, impl_->keywords);
+			if (impl_->lexer.worker)
+			{
+				auto & lx = impl_->lexer;
+				if ((!lx.tmr.started()) && lx.worker->pending(impl_->textbase))
+					lx.tmr.start();
+
+				if (text_ptr == sct.begin)
+					parser.parse(text_ptr, text_len, text_coord, *lx.worker, impl_->keywords);
+			}
+			else if (text_ptr == sct.begin)
+				parser.parse(text_ptr, text_len, text_coord, impl_->keywords, impl_->textbase);
+			else
+				parser.parse(text_ptr, text_len, impl_->keywords);
+
+			//The matches are not highlighted for a masked text.
+			if (text_ptr == sct.begin)
+				parser.append_matches(text_ptr, text_len, text_coord, impl_->matches, impl_->keywords, impl_->textbase);
 
 			const auto line_h_pixels = line_height();
 
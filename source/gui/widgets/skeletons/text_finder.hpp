@@ -0,0 +1,324 @@
+/*
+ *	A Text Finder Implementation
+ *	Nana C++ Library(http://www.nanapro.org)
+ *	Copyright(C) 2017 Jinhao(cnjinhao@hotmail.com)
+ *
+ *	Distributed under the Boost Software License, Version 1.0.
+ *	(See accompanying file LICENSE_1_0.txt or copy at
+ *	http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *	@file: nana/gui/widgets/skeletons/text_finder.hpp
+ */
+
+#ifndef NANA_WIDGETS_SKELETONS_TEXT_FINDER_INCLUDED
+#define NANA_WIDGETS_SKELETONS_TEXT_FINDER_INCLUDED
+
+#include <nana/gui/widgets/skeletons/text_editor_part.hpp>
+#include <nana/threads/pool.hpp>
+#include <string>
+#include <vector>
+#include <regex>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <cwchar>
+#include <cwctype>
+
+namespace nana { namespace widgets {
+namespace skeletons
+{
+	//A matcher of a pattern in a line. A literal pattern is searched by Boyer-Moore-Horspool algorithm, and a regular
+	//expression is searched by std::wregex. A matcher is not modified by searching, it can be shared by threads.
+	class text_matcher
+	{
+		static const std::size_t skip_size = 256;	//The characters are mapped into the skip table by their low bits.
+	public:
+		//Throws std::regex_error if the regular expression is invalid.
+		text_matcher(const std::wstring& pattern, const text_search_options& opt)
+			: opt_(opt), pattern_(pattern)
+		{
+			if (opt_.regex)
+			{
+				auto flags = std::regex_constants::ECMAScript;
+				if (!opt_.case_sensitive)
+					flags |= std::regex_constants::icase;
+
+				regex_.reset(new std::wregex(pattern_, flags));
+				return;
+			}
+
+			auto const m = pattern_.size();
+			for (auto & ch : pattern_)
+				ch = _m_fold(ch);
+
+			std::fill(skip_, skip_ + skip_size, m);
+			for (std::size_t i = 0; i + 1 < m; ++i)
+				skip_[pattern_[i] % skip_size] = m - 1 - i;
+		}
+
+		bool empty() const
+		{
+			return pattern_.empty();
+		}
+
+		//Calls fn(begin, end) for each match in the text, the matches are not overlapped.
+		template<typename Function>
+		void search(const wchar_t* text, std::size_t len, Function fn) const
+		{
+			if (pattern_.empty())
+				return;
+
+			if (regex_)
+			{
+				for (std::wcregex_iterator i(text, text + len, *regex_), end; i != end; ++i)
+				{
+					auto const pos = static_cast<std::size_t>(i->position());
+					auto const n = static_cast<std::size_t>(i->length());
+					if (n && _m_whole_word(text, len, pos, n))
+						fn(pos, pos + n);
+				}
+				return;
+			}
+
+			auto const m = pattern_.size();
+			if (len < m)
+				return;
+
+			if (1 == m && opt_.case_sensitive)
+			{
+				//wmemchr is vectorized by the C library
+				for (auto p = text, end = text + len; (p = std::wmemchr(p, pattern_[0], end - p)) != nullptr; ++p)
+				{
+					auto const pos = static_cast<std::size_t>(p - text);
+					if (_m_whole_word(text, len, pos, 1))
+						fn(pos, pos + 1);
+				}
+				return;
+			}
+
+			std::size_t pos = 0;
+			while (pos + m <= len)
+			{
+				auto j = m;
+				while (j && (_m_fold(text[pos + j - 1]) == pattern_[j - 1]))
+					--j;
+
+				if ((0 == j) && _m_whole_word(text, len, pos, m))
+				{
+					fn(pos, pos + m);
+					pos += m;
+				}
+				else
+					pos += skip_[_m_fold(text[pos + m - 1]) % skip_size];
+			}
+		}
+
+		//Replaces the matches of a line and returns the number of replaced matches. The replacement of a regular
+		//expression may refer to the submatches, such as $1.
+		std::size_t replace(const std::wstring& line, const std::wstring& replacement, std::wstring& out) const
+		{
+			out.clear();
+
+			std::size_t count = 0;
+			std::size_t last = 0;
+			if (regex_)
+			{
+				for (std::wsregex_iterator i(line.begin(), line.end(), *regex_), end; i != end; ++i)
+				{
+					auto const pos = static_cast<std::size_t>(i->position());
+					auto const n = static_cast<std::size_t>(i->length());
+					if (0 == n || !_m_whole_word(line.c_str(), line.size(), pos, n))
+						continue;
+
+					out.append(line, last, pos - last);
+					out += i->format(replacement);
+					last = pos + n;
+					++count;
+				}
+			}
+			else
+			{
+				search(line.c_str(), line.size(), [&](std::size_t begin, std::size_t end)
+				{
+					out.append(line, last, begin - last);
+					out += replacement;
+					last = end;
+					++count;
+				});
+			}
+
+			out.append(line, last, std::wstring::npos);
+			return count;
+		}
+	private:
+		wchar_t _m_fold(wchar_t ch) const
+		{
+			return (opt_.case_sensitive ? ch : static_cast<wchar_t>(std::towlower(ch)));
+		}
+
+		bool _m_whole_word(const wchar_t* text, std::size_t len, std::size_t pos, std::size_t n) const
+		{
+			if (!opt_.whole_word)
+				return true;
+
+			auto is_word = [](wchar_t ch)
+			{
+				return (std::iswalnum(ch) || (L'_' == ch));
+			};
+
+			return !((pos && is_word(text[pos - 1])) || ((pos + n < len) && is_word(text[pos + n])));
+		}
+	private:
+		text_search_options const opt_;
+		std::wstring pattern_;		//The folded pattern if it is a literal pattern.
+		std::size_t skip_[skip_size];
+		std::unique_ptr<std::wregex> regex_;
+	};
+
+	//Searches the lines of a textbase in chunks. The chunks are searched by the calling thread and the threads of
+	//a shared pool, and the matches are reported by the calling thread in the order of lines.
+	class text_finder
+	{
+		static const std::size_t chunk_lines = 2048;
+	public:
+		using report_fn = std::function<bool(const std::vector<text_range>&)>;
+
+		//Searches all the lines, the fn is invoked with the matches of each chunk which has matches, and the search is
+		//stopped if it returns false. The lines are read by peek() concurrently, so the textbase should not be indexing
+		//and it should not be modified until it returns. Returns the number of reported matches.
+		template<typename Textbase>
+		static std::size_t find_all(const Textbase& tb, const text_matcher& matcher, const report_fn& fn)
+		{
+			auto const lines = tb.lines();
+			auto const chunks = (lines + chunk_lines - 1) / chunk_lines;
+			if (0 == chunks || matcher.empty())
+				return 0;
+
+			auto search_chunk = [&tb, &matcher, lines](std::size_t chunk, std::vector<text_range>& matches)
+			{
+				typename Textbase::string_type buf;
+				for (auto pos = chunk * chunk_lines, end = (std::min)(pos + chunk_lines, lines); pos < end; ++pos)
+				{
+					auto & text = tb.peek(pos, buf);
+					matcher.search(text.c_str(), text.size(), [&matches, pos](std::size_t begin, std::size_t end)
+					{
+						matches.emplace_back(upoint(static_cast<unsigned>(begin), static_cast<unsigned>(pos)), upoint(static_cast<unsigned>(end), static_cast<unsigned>(pos)));
+					});
+				}
+			};
+
+			//The state is shared with the tasks, a task may be run after all the chunks are finished, and it
+			//only accesses the textbase when it claims a chunk.
+			struct state
+			{
+				std::mutex mutex;
+				std::condition_variable cond;
+				std::size_t next{ 0 };
+				std::size_t running{ 0 };
+				bool cancel{ false };
+				std::exception_ptr error;
+				std::vector<std::vector<text_range>> results;
+				std::vector<char> done;
+			};
+
+			auto st = std::make_shared<state>();
+			st->results.resize(chunks);
+			st->done.resize(chunks);
+
+			//Claims a chunk and searches it, returns false if there is not a chunk to be searched.
+			auto claim = [st, search_chunk, chunks](std::unique_lock<std::mutex>& lock)
+			{
+				if (st->cancel || (st->next == chunks))
+					return false;
+
+				auto const chunk = st->next++;
+				++st->running;
+				lock.unlock();
+
+				std::vector<text_range> matches;
+				std::exception_ptr error;
+				try
+				{
+					search_chunk(chunk, matches);
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				lock.lock();
+				--st->running;
+				st->results[chunk].swap(matches);
+				st->done[chunk] = 1;
+				if (error && !st->error)
+				{
+					st->error = error;
+					st->cancel = true;
+				}
+				st->cond.notify_all();
+				return true;
+			};
+
+			auto const hardware_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+			auto const tasks = (std::min)(std::size_t(hardware_threads) - 1, chunks - 1);
+			for (std::size_t i = 0; i < tasks; ++i)
+			{
+				threads::shared_pool().push([st, claim]
+				{
+					std::unique_lock<std::mutex> lock(st->mutex);
+					while (claim(lock));
+				});
+			}
+
+			std::size_t reported = 0;
+			std::unique_lock<std::mutex> lock(st->mutex);
+			for (std::size_t chunk = 0; (chunk < chunks) && !st->cancel;)
+			{
+				if (st->done[chunk])
+				{
+					std::vector<text_range> matches;
+					matches.swap(st->results[chunk++]);
+					if (matches.empty())
+						continue;
+
+					lock.unlock();
+					bool proceed = false;
+					try
+					{
+						proceed = fn(matches);
+						reported += matches.size();
+					}
+					catch (...)
+					{
+						lock.lock();
+						st->error = std::current_exception();
+						break;
+					}
+					lock.lock();
+
+					if (!proceed)
+						st->cancel = true;
+				}
+				else if (!claim(lock))
+					st->cond.wait(lock);
+			}
+
+			//Waits for the claimed chunks, because they are accessing the textbase.
+			st->cancel = true;
+			st->cond.wait(lock, [&st]{ return (0 == st->running); });
+
+			if (st->error)
+				std::rethrow_exception(st->error);
+
+			return reported;
+		}
+	};
+}
+}
+}
+
+#endif
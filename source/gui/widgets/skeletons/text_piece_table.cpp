@@ -0,0 +1,236 @@
+/*
+*	A piece table for the text of textbase
+*	Nana C++ Library(http://www.nanapro.org)
+*	Copyright(C) 2003-2017 Jinhao(cnjinhao@hotmail.com)
+*
+*	Distributed under the Boost Software License, Version 1.0.
+*	(See accompanying file LICENSE_1_0.txt or copy at
+*	http://www.boost.org/LICENSE_1_0.txt)
+*
+*	@file: nana/gui/widgets/skeletons/text_piece_table.cpp
+*/
+
+#include <nana/gui/widgets/skeletons/text_piece_table.hpp>
+#include <nana/deploy.hpp>
+#include <fstream>
+
+#if defined(NANA_WINDOWS)
+#	include <windows.h>
+#elif defined(NANA_POSIX)
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <cerrno>
+#endif
+
+namespace nana {
+	namespace widgets {
+		namespace skeletons
+		{
+#if defined(NANA_POSIX)
+			//The files smaller than the threshold are read into the buffer.
+			constexpr off_t mapping_threshold = 16 * 1024 * 1024;
+
+			//Determines whether a file is opened for writing by any process. It is detected by a read lease
+			//which is refused for such a file, the file is assumed not written if the lease is not supported.
+			static bool opened_for_writing(int fd)
+			{
+#	if defined(F_SETLEASE)
+				if (0 == ::fcntl(fd, F_SETLEASE, F_RDLCK))
+				{
+					::fcntl(fd, F_SETLEASE, F_UNLCK);
+					return false;
+				}
+				return (EAGAIN == errno);
+#	else
+				static_cast<void>(fd);
+				return false;
+#	endif
+			}
+#endif
+
+			//class text_file_view
+			text_file_view::text_file_view(text_file_view&& other)
+				:	mapped_(other.mapped_),
+					size_(other.size_),
+					bytes_(std::move(other.bytes_))
+			{
+				file_id_[0] = other.file_id_[0];
+				file_id_[1] = other.file_id_[1];
+				other.mapped_ = nullptr;
+				other.size_ = 0;
+			}
+
+			text_file_view& text_file_view::operator=(text_file_view&& other)
+			{
+				if (this != &other)
+				{
+					close();
+					mapped_ = other.mapped_;
+					size_ = other.size_;
+					bytes_ = std::move(other.bytes_);
+					file_id_[0] = other.file_id_[0];
+					file_id_[1] = other.file_id_[1];
+
+					other.mapped_ = nullptr;
+					other.size_ = 0;
+				}
+				return *this;
+			}
+
+			text_file_view::~text_file_view()
+			{
+				close();
+			}
+
+			bool text_file_view::open(const char* file_utf8)
+			{
+				close();
+				if (!file_utf8)
+					return false;
+
+#if defined(NANA_WINDOWS)
+				HANDLE file = ::CreateFileW(to_nstring(file_utf8).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (INVALID_HANDLE_VALUE == file)
+					return false;
+
+				LARGE_INTEGER file_size;
+				if (::GetFileSizeEx(file, &file_size) && file_size.QuadPart && (static_cast<unsigned long long>(file_size.QuadPart) <= (std::numeric_limits<std::size_t>::max)()))
+				{
+					HANDLE mapping = ::CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+					if (mapping)
+					{
+						//The view keeps a reference to the mapping object.
+						mapped_ = static_cast<const char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+						::CloseHandle(mapping);
+
+						BY_HANDLE_FILE_INFORMATION info;
+						if (mapped_ && ::GetFileInformationByHandle(file, &info))
+						{
+							file_id_[0] = info.dwVolumeSerialNumber;
+							file_id_[1] = (static_cast<unsigned long long>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+						}
+					}
+				}
+				::CloseHandle(file);
+
+				if (mapped_)
+				{
+					size_ = static_cast<std::size_t>(file_size.QuadPart);
+					return true;
+				}
+#elif defined(NANA_POSIX)
+				int fd = ::open(to_osmbstr(file_utf8).c_str(), O_RDONLY);
+				if (fd < 0)
+					return false;
+
+				//A mapped file raises SIGBUS when its pages are read after the file is truncated by another process.
+				//The small files and the files which are opened for writing, e.g. the logs, are read into the buffer.
+				struct stat st;
+				if ((0 == ::fstat(fd, &st)) && S_ISREG(st.st_mode) && (st.st_size >= mapping_threshold) && !opened_for_writing(fd))
+				{
+					auto addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+					if (MAP_FAILED != addr)
+					{
+						//The lines are indexed from the beginning to the end
+						::madvise(addr, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+						mapped_ = static_cast<const char*>(addr);
+						size_ = static_cast<std::size_t>(st.st_size);
+						file_id_[0] = static_cast<unsigned long long>(st.st_dev);
+						file_id_[1] = static_cast<unsigned long long>(st.st_ino);
+					}
+				}
+				::close(fd);
+
+				if (mapped_)
+					return true;
+#endif
+				//Reads the whole file if it can't be mapped.
+				std::ifstream ifs(to_osmbstr(file_utf8), std::ios::binary);
+				if (!ifs)
+					return false;
+
+				ifs.seekg(0, std::ios::end);
+				auto const size = static_cast<std::size_t>(ifs.tellg());
+				ifs.seekg(0, std::ios::beg);
+
+				bytes_.resize(size);
+				if (size)
+					ifs.read(&bytes_[0], static_cast<std::streamsize>(size));
+
+				bytes_.resize(static_cast<std::size_t>(ifs.gcount()));
+				return true;
+			}
+
+			void text_file_view::assign(std::string&& bytes)
+			{
+				close();
+				bytes_ = std::move(bytes);
+			}
+
+			void text_file_view::close()
+			{
+				if (mapped_)
+				{
+#if defined(NANA_WINDOWS)
+					::UnmapViewOfFile(mapped_);
+#elif defined(NANA_POSIX)
+					::munmap(const_cast<char*>(mapped_), size_);
+#endif
+					mapped_ = nullptr;
+					size_ = 0;
+				}
+				std::string{}.swap(bytes_);
+			}
+
+			bool text_file_view::maps(const char* file_utf8) const
+			{
+				if (!(mapped_ && file_utf8))
+					return false;
+
+#if defined(NANA_WINDOWS)
+				HANDLE file = ::CreateFileW(to_nstring(file_utf8).c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (INVALID_HANDLE_VALUE == file)
+					return false;
+
+				BY_HANDLE_FILE_INFORMATION info;
+				bool const same = ::GetFileInformationByHandle(file, &info) &&
+					(file_id_[0] == info.dwVolumeSerialNumber) &&
+					(file_id_[1] == ((static_cast<unsigned long long>(info.nFileIndexHigh) << 32) | info.nFileIndexLow));
+
+				::CloseHandle(file);
+				return same;
+#elif defined(NANA_POSIX)
+				struct stat st;
+				return (0 == ::stat(to_osmbstr(file_utf8).c_str(), &st)) &&
+					(file_id_[0] == static_cast<unsigned long long>(st.st_dev)) &&
+					(file_id_[1] == static_cast<unsigned long long>(st.st_ino));
+#else
+				return false;
+#endif
+			}
+
+			void text_file_view::detach()
+			{
+				if (mapped_)
+				{
+					std::string bytes(mapped_, size_);
+					close();
+					bytes_ = std::move(bytes);
+				}
+			}
+
+			const char* text_file_view::data() const
+			{
+				return (mapped_ ? mapped_ : bytes_.data());
+			}
+
+			std::size_t text_file_view::size() const
+			{
+				return (mapped_ ? size_ : bytes_.size());
+			}
+			//end class text_file_view
+		}//end namespace skeletons
+	}//end namespace widgets
+}//end namespace nana
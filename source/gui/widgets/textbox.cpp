@@ -61,6 +61,11 @@ namespace drawerbase {
 			return editor_;
 		}
 
+		const std::shared_ptr<widgets::skeletons::line_stream>& drawer::stream_queue() const
+		{
+			return stream_;
+		}
+
 		void drawer::attached(widget_reference wdg, graph_reference graph)
 		{
 			auto wd = wdg.handle();
@@ -69,6 +74,7 @@ namespace drawerbase {
 			auto scheme = API::dev::get_scheme(wdg);
 
 			editor_ = new text_editor(wd, graph, dynamic_cast<::nana::widgets::skeletons::text_editor_scheme*>(scheme));
+			stream_ = editor_->stream_queue();
 
 			evt_agent_.reset(new event_agent(static_cast<::nana::textbox&>(wdg), editor_->text_position()));
 			editor_->textbase().set_event_agent(evt_agent_.get());
@@ -408,6 +414,24 @@ namespace drawerbase {
 			return *this;
 		}
 
+		textbox& textbox::stream_lines(bool enable, std::size_t max_lines)
+		{
+			internal_scope_guard lock;
+			auto editor = get_drawer_trigger().editor();
+			if (editor)
+				editor->stream(enable, max_lines);
+
+			return *this;
+		}
+
+		bool textbox::push_line(const std::string& text_utf8)
+		{
+			//It doesn't lock the GUI, because it is designed for the threads which produce lines frequently. The queue
+			//is set when the widget is created and it is disabled when the editor is destroyed, the editor is not accessed.
+			auto & queue = get_drawer_trigger().stream_queue();
+			return (queue && queue->push(to_wstring(text_utf8)));
+		}
+
 		/// Determine wheter the text is auto-line changed.
 		bool textbox::line_wrapped() const
 		{
@@ -656,6 +680,52 @@ namespace drawerbase {
 			}
 		}
 
+		void textbox::set_lexer(std::shared_ptr<widgets::skeletons::text_lexer_interface> lexer)
+		{
+			internal_scope_guard lock;
+			auto editor = get_drawer_trigger().editor();
+			if (editor)
+			{
+				editor->set_lexer(std::move(lexer));
+				API::refresh_window(handle());
+			}
+		}
+
+		std::size_t textbox::find_all(const std::string& pattern_utf8, const search_options& opt, std::function<bool(const std::vector<text_range>&)> fn)
+		{
+			internal_scope_guard lock;
+			auto editor = get_drawer_trigger().editor();
+			if (editor && fn)
+				return editor->find_all(to_wstring(pattern_utf8), opt, fn);
+
+			return 0;
+		}
+
+		std::size_t textbox::replace_all(const std::string& pattern_utf8, const std::string& replacement_utf8, const search_options& opt)
+		{
+			internal_scope_guard lock;
+			auto editor = get_drawer_trigger().editor();
+			if (editor)
+			{
+				auto count = editor->replace_all(to_wstring(pattern_utf8), to_wstring(replacement_utf8), opt);
+				if (editor->try_refresh())
+					API::update_window(handle());
+				return count;
+			}
+			return 0;
+		}
+
+		void textbox::highlight_matches(const std::string& pattern_utf8, const search_options& opt, const std::string& scheme)
+		{
+			internal_scope_guard lock;
+			auto editor = get_drawer_trigger().editor();
+			if (editor)
+			{
+				editor->highlight_matches(to_wstring(pattern_utf8), opt, scheme);
+				API::refresh_window(handle());
+			}
+		}
+
 		textbox& textbox::text_align(::nana::align alignment)
 		{
 			internal_scope_guard lock;
@@ -720,6 +790,14 @@ namespace drawerbase {
 				editor->set_undo_queue_length(len);
 		}
 
+		void textbox::set_undo_memory_limit(std::size_t bytes)
+		{
+			internal_scope_guard lock;
+			auto editor = get_drawer_trigger().editor();
+			if (editor)
+				editor->set_undo_memory_limit(bytes);
+		}
+
 		std::size_t textbox::display_line_count() const noexcept
 		{
 			internal_scope_guard lock;
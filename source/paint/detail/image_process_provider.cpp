@@ -2,6 +2,13 @@
 #include <nana/paint/detail/image_process_provider.hpp>
 
 #include <nana/paint/detail/image_processor.hpp>
+#include "image_processor_simd.hpp"
+#include <nana/threads/pool.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
 
 namespace nana
 {
@@ -24,6 +31,31 @@ namespace paint
 			add<paint::detail::algorithms::blend>(blend_, "blend");
 			add<paint::detail::algorithms::bresenham_line>(line_, "bresenham_line");
 			add<paint::detail::algorithms::superfast_blur>(blur_, "superfast_blur");
+
+#if defined(NANA_SIMD_X86)
+			//The SIMD versions are employed if the CPU supports them, the scalar versions are still
+			//available by their names.
+			auto & cpu = paint::detail::algorithms::simd::cpu();
+			if(cpu.sse2)
+			{
+				add<paint::detail::algorithms::bilinear_interoplation_sse2>(stretch_, "bilinear interoplation sse2");
+				add<paint::detail::algorithms::alpha_blend_sse2>(alpha_blend_, "alpha_blend sse2");
+				add<paint::detail::algorithms::blend_sse2>(blend_, "blend sse2");
+
+				set(stretch_, "bilinear interoplation sse2");
+				set(alpha_blend_, "alpha_blend sse2");
+				set(blend_, "blend sse2");
+			}
+
+			if(cpu.avx2)
+			{
+				add<paint::detail::algorithms::alpha_blend_avx2>(alpha_blend_, "alpha_blend avx2");
+				add<paint::detail::algorithms::blend_avx2>(blend_, "blend avx2");
+
+				set(alpha_blend_, "alpha_blend avx2");
+				set(blend_, "blend avx2");
+			}
+#endif
 		}
 
 		image_process_provider::stretch_tag& image_process_provider::ref_stretch_tag()
@@ -104,6 +136,86 @@ namespace paint
 		{
 			return _m_read(blur_, name);
 		}
+
+		//Concurrency
+		void image_process_provider::concurrency(std::size_t max_threads)
+		{
+			concurrency_.max_threads = max_threads;
+		}
+
+		void image_process_provider::concurrency_threshold(std::size_t pixels)
+		{
+			concurrency_.threshold = pixels;
+		}
+
+		void image_process_provider::parallel_bands(std::size_t lines, std::size_t pixels_per_line, const std::function<void(std::size_t, std::size_t)>& fn)
+		{
+			const std::size_t hardware_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+			const std::size_t max_threads = concurrency_.max_threads;
+
+			const std::size_t bands = (std::min)(lines, (max_threads ? (std::min)(max_threads, hardware_threads) : hardware_threads));
+			if ((bands < 2) || (lines * pixels_per_line < concurrency_.threshold))
+			{
+				fn(0, lines);
+				return;
+			}
+
+			//The bands are claimed by the tasks and the calling thread. A task may be run after all the bands are
+			//finished, therefore the state is shared and fn is only accessed when a band is claimed.
+			struct band_state
+			{
+				std::atomic<std::size_t> next{ 0 };
+				std::mutex mutex;
+				std::condition_variable cond;
+				std::size_t finished{ 0 };
+				std::exception_ptr error;	//The first exception thrown by fn, the remaining bands are skipped.
+			};
+
+			auto state = std::make_shared<band_state>();
+			auto fnptr = &fn;
+
+			auto run = [state, fnptr, lines, bands]
+			{
+				std::size_t band;
+				while ((band = state->next++) < bands)
+				{
+					std::exception_ptr error;
+					try
+					{
+						bool failed;
+						{
+							std::lock_guard<std::mutex> lock(state->mutex);
+							failed = static_cast<bool>(state->error);
+						}
+
+						if (!failed)
+							(*fnptr)(lines * band / bands, lines * (band + 1) / bands);
+					}
+					catch (...)
+					{
+						error = std::current_exception();
+					}
+
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if (error && !state->error)
+						state->error = error;
+
+					if (++state->finished == bands)
+						state->cond.notify_one();
+				}
+			};
+
+			for (std::size_t i = 1; i < bands; ++i)
+				threads::shared_pool().push(run);
+
+			run();
+
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->cond.wait(lock, [&state, bands]{ return (state->finished == bands); });
+
+			if (state->error)
+				std::rethrow_exception(state->error);
+		}
 	//end class image_process_provider
 	}
 }
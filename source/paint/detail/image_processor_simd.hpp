@@ -0,0 +1,440 @@
+/*
+ *	Image Processor Algorithm Implementation with SIMD
+ *	Nana C++ Library(http://www.nanapro.org)
+ *	Copyright(C) 2003-2017 Jinhao(cnjinhao@hotmail.com)
+ *
+ *	Distributed under the Boost Software License, Version 1.0.
+ *	(See accompanying file LICENSE_1_0.txt or copy at
+ *	http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *	@file: nana/paint/detail/image_processor_simd.hpp
+ *	@brief: The SSE2/AVX2 versions of the image processors in nana/paint/detail/image_processor.hpp,
+ *		they are employed by the image_process_provider when the CPU supports the instructions.
+ *		The results of alpha_blend and stretch are same as the scalar versions, the result of
+ *		blend may differ by 1 because of the fixed-point fade rate.
+ */
+
+#ifndef NANA_PAINT_DETAIL_IMAGE_PROCESSOR_SIMD_HPP
+#define NANA_PAINT_DETAIL_IMAGE_PROCESSOR_SIMD_HPP
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#	define NANA_SIMD_X86
+#	define NANA_SIMD_TARGET_SSE2
+#	define NANA_SIMD_TARGET_AVX2
+#	include <intrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	define NANA_SIMD_X86
+#	define NANA_SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#	define NANA_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(NANA_SIMD_X86)
+
+#include <nana/paint/detail/image_processor.hpp>
+#include <immintrin.h>
+#include <memory>
+
+namespace nana
+{
+namespace paint
+{
+namespace detail
+{
+	namespace algorithms
+	{
+		namespace simd
+		{
+			struct cpu_features
+			{
+				bool sse2;
+				bool avx2;
+			};
+
+			inline const cpu_features& cpu()
+			{
+				static const cpu_features features = []{
+					cpu_features ft;
+#if defined(_MSC_VER)
+					int info[4];
+					::__cpuid(info, 0);
+					const int max_leaf = info[0];
+
+					::__cpuid(info, 1);
+					ft.sse2 = ((info[3] & (1 << 26)) != 0);
+
+					//AVX2 requires the OS saves the YMM registers
+					const bool os_avx = ((info[2] & (1 << 27)) != 0) && ((::_xgetbv(0) & 0x6) == 0x6);
+					ft.avx2 = false;
+					if (os_avx && (max_leaf >= 7))
+					{
+						::__cpuidex(info, 7, 0);
+						ft.avx2 = ((info[1] & (1 << 5)) != 0);
+					}
+#else
+					__builtin_cpu_init();
+					ft.sse2 = (0 != __builtin_cpu_supports("sse2"));
+					ft.avx2 = (0 != __builtin_cpu_supports("avx2"));
+#endif
+					return ft;
+				}();
+				return features;
+			}
+
+			//The scalar version of alpha blending for a pixel, it is same as algorithms::alpha_blend.
+			inline void alpha_blend_pixel(pixel_argb_t* d, const pixel_argb_t* s)
+			{
+				const unsigned alpha = s->element.alpha_channel;
+				if (alpha)
+				{
+					if (alpha != 255)
+					{
+						d->element.red = unsigned(d->element.red * (255 - alpha) + s->element.red * alpha) / 255;
+						d->element.green = unsigned(d->element.green * (255 - alpha) + s->element.green * alpha) / 255;
+						d->element.blue = unsigned(d->element.blue * (255 - alpha) + s->element.blue * alpha) / 255;
+					}
+					else
+						*d = *s;
+				}
+			}
+
+			//The fixed-point version of fade table, d = d * fade_rate + s * (1 - fade_rate).
+			inline void blend_pixel(pixel_argb_t* d, const pixel_argb_t* s, unsigned fade16)
+			{
+				d->element.red = static_cast<unsigned char>(s->element.red + ((d->element.red * fade16) >> 16) - ((s->element.red * fade16) >> 16));
+				d->element.green = static_cast<unsigned char>(s->element.green + ((d->element.green * fade16) >> 16) - ((s->element.green * fade16) >> 16));
+				d->element.blue = static_cast<unsigned char>(s->element.blue + ((d->element.blue * fade16) >> 16) - ((s->element.blue * fade16) >> 16));
+			}
+
+			inline unsigned fade_rate16(double fade_rate)
+			{
+				if (fade_rate <= 0)
+					return 0;
+
+				auto n = static_cast<unsigned>(fade_rate * 65536 + 0.5);
+				return (n > 0xFFFF ? 0xFFFF : n);
+			}
+
+			//@brief: Blends 8 channels(2 pixels) in 16bits lanes, d = (d * (255 - w) + s * w) / 255
+			//		The division is exact for the values which are not greater than 255 * 255.
+			NANA_SIMD_TARGET_SSE2 inline __m128i alpha_blend_epi16(__m128i d, __m128i s, __m128i w)
+			{
+				const __m128i c255 = _mm_set1_epi16(255);
+				const __m128i one = _mm_set1_epi16(1);
+
+				__m128i x = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(c255, w)), _mm_mullo_epi16(s, w));
+				return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+			}
+
+			NANA_SIMD_TARGET_AVX2 inline __m256i alpha_blend_epi16(__m256i d, __m256i s, __m256i w)
+			{
+				const __m256i c255 = _mm256_set1_epi16(255);
+				const __m256i one = _mm256_set1_epi16(1);
+
+				__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_sub_epi16(c255, w)), _mm256_mullo_epi16(s, w));
+				return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)), 8);
+			}
+
+			//@brief: Alpha-blends a row of pixels. The weight of RGB is the source alpha, the weight of alpha channel
+			//		is 255 if the source alpha is 255, otherwise it is 0 for keeping the destination alpha.
+			NANA_SIMD_TARGET_SSE2 inline void alpha_blend_row_sse2(pixel_argb_t* d, const pixel_argb_t* s, unsigned n)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i opaque = _mm_set1_epi32(255);
+				const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+				unsigned i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+					const __m128i a = _mm_srli_epi32(sp, 24);
+
+					//Skip the transparent pixels
+					if (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)))
+						continue;
+
+					const __m128i dp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+
+					__m128i w = _mm_or_si128(_mm_or_si128(a, _mm_slli_epi32(a, 8)), _mm_slli_epi32(a, 16));
+					w = _mm_or_si128(w, _mm_and_si128(_mm_cmpeq_epi32(a, opaque), alpha_mask));
+
+					const __m128i lo = alpha_blend_epi16(_mm_unpacklo_epi8(dp, zero), _mm_unpacklo_epi8(sp, zero), _mm_unpacklo_epi8(w, zero));
+					const __m128i hi = alpha_blend_epi16(_mm_unpackhi_epi8(dp, zero), _mm_unpackhi_epi8(sp, zero), _mm_unpackhi_epi8(w, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(lo, hi));
+				}
+
+				for (; i < n; ++i)
+					alpha_blend_pixel(d + i, s + i);
+			}
+
+			NANA_SIMD_TARGET_AVX2 inline void alpha_blend_row_avx2(pixel_argb_t* d, const pixel_argb_t* s, unsigned n)
+			{
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i opaque = _mm256_set1_epi32(255);
+				const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+				unsigned i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const __m256i sp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+					const __m256i a = _mm256_srli_epi32(sp, 24);
+
+					//Skip the transparent pixels
+					if (-1 == _mm256_movemask_epi8(_mm256_cmpeq_epi32(a, zero)))
+						continue;
+
+					const __m256i dp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+
+					__m256i w = _mm256_or_si256(_mm256_or_si256(a, _mm256_slli_epi32(a, 8)), _mm256_slli_epi32(a, 16));
+					w = _mm256_or_si256(w, _mm256_and_si256(_mm256_cmpeq_epi32(a, opaque), alpha_mask));
+
+					//The unpack and pack operate in 128bits lanes, the order of pixels is kept.
+					const __m256i lo = alpha_blend_epi16(_mm256_unpacklo_epi8(dp, zero), _mm256_unpacklo_epi8(sp, zero), _mm256_unpacklo_epi8(w, zero));
+					const __m256i hi = alpha_blend_epi16(_mm256_unpackhi_epi8(dp, zero), _mm256_unpackhi_epi8(sp, zero), _mm256_unpackhi_epi8(w, zero));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_packus_epi16(lo, hi));
+				}
+
+				for (; i < n; ++i)
+					alpha_blend_pixel(d + i, s + i);
+			}
+
+			//@brief: Blends a row of pixels, d = s + d * fade_rate - s * fade_rate. The alpha channel of d is kept.
+			NANA_SIMD_TARGET_SSE2 inline void blend_row_sse2(pixel_argb_t* d, const pixel_argb_t* s, unsigned n, unsigned fade16)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i fade = _mm_set1_epi16(static_cast<short>(fade16));
+				const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+				unsigned i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+					const __m128i dp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+
+					__m128i s16 = _mm_unpacklo_epi8(sp, zero);
+					const __m128i lo = _mm_sub_epi16(_mm_add_epi16(s16, _mm_mulhi_epu16(_mm_unpacklo_epi8(dp, zero), fade)), _mm_mulhi_epu16(s16, fade));
+
+					s16 = _mm_unpackhi_epi8(sp, zero);
+					const __m128i hi = _mm_sub_epi16(_mm_add_epi16(s16, _mm_mulhi_epu16(_mm_unpackhi_epi8(dp, zero), fade)), _mm_mulhi_epu16(s16, fade));
+
+					const __m128i px = _mm_or_si128(_mm_andnot_si128(alpha_mask, _mm_packus_epi16(lo, hi)), _mm_and_si128(dp, alpha_mask));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), px);
+				}
+
+				for (; i < n; ++i)
+					blend_pixel(d + i, s + i, fade16);
+			}
+
+			NANA_SIMD_TARGET_AVX2 inline void blend_row_avx2(pixel_argb_t* d, const pixel_argb_t* s, unsigned n, unsigned fade16)
+			{
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i fade = _mm256_set1_epi16(static_cast<short>(fade16));
+				const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+				unsigned i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const __m256i sp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+					const __m256i dp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+
+					__m256i s16 = _mm256_unpacklo_epi8(sp, zero);
+					const __m256i lo = _mm256_sub_epi16(_mm256_add_epi16(s16, _mm256_mulhi_epu16(_mm256_unpacklo_epi8(dp, zero), fade)), _mm256_mulhi_epu16(s16, fade));
+
+					s16 = _mm256_unpackhi_epi8(sp, zero);
+					const __m256i hi = _mm256_sub_epi16(_mm256_add_epi16(s16, _mm256_mulhi_epu16(_mm256_unpackhi_epi8(dp, zero), fade)), _mm256_mulhi_epu16(s16, fade));
+
+					const __m256i px = _mm256_or_si256(_mm256_andnot_si256(alpha_mask, _mm256_packus_epi16(lo, hi)), _mm256_and_si256(dp, alpha_mask));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), px);
+				}
+
+				for (; i < n; ++i)
+					blend_pixel(d + i, s + i, fade16);
+			}
+
+			//@brief: Interpolates a pixel by 4 neighbours, it is same as the scalar bilinear_interoplation.
+			//		The horizontal interpolation is computed by madd, and the vertical interpolation is computed
+			//		in float, the values are less than 2^24 and they are exact in float.
+			NANA_SIMD_TARGET_SSE2 inline unsigned bilinear_pixel_sse2(unsigned col0, unsigned col1, unsigned col2, unsigned col3, __m128i wu, __m128 wv_minus, __m128 wv)
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				const __m128i top = _mm_madd_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(col0)), _mm_cvtsi32_si128(static_cast<int>(col2))), zero), wu);
+				const __m128i bottom = _mm_madd_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(col1)), _mm_cvtsi32_si128(static_cast<int>(col3))), zero), wu);
+
+				const __m128 v = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(top), wv_minus), _mm_mul_ps(_mm_cvtepi32_ps(bottom), wv));
+				const __m128i px = _mm_srli_epi32(_mm_cvttps_epi32(v), 16);
+
+				const __m128i px16 = _mm_packs_epi32(px, zero);
+				return static_cast<unsigned>(_mm_cvtsi128_si32(_mm_packus_epi16(px16, zero)));
+			}
+
+			struct bilinear_column
+			{
+				int x;
+				int iu;
+				int iu_minus_coef;
+			};
+
+			NANA_SIMD_TARGET_SSE2 inline void bilinear_row_sse2(pixel_argb_t* i, const pixel_argb_t* s_line, const pixel_argb_t* next_s_line, const bilinear_column* columns, std::size_t width, int right_bound, unsigned iv, bool is_alpha_channel)
+			{
+				const __m128 wv_minus = _mm_set1_ps(static_cast<float>(256 - iv));
+				const __m128 wv = _mm_set1_ps(static_cast<float>(iv));
+
+				for (std::size_t x = 0; x < width; ++x, ++i)
+				{
+					const bilinear_column el = columns[x];
+
+					const unsigned col0 = s_line[el.x].value;
+					const unsigned col1 = next_s_line[el.x].value;
+					const unsigned col2 = (el.x < right_bound ? s_line[el.x + 1].value : col0);
+					const unsigned col3 = (el.x < right_bound ? next_s_line[el.x + 1].value : col1);
+
+					pixel_argb_t px;
+					px.value = bilinear_pixel_sse2(col0, col1, col2, col3, _mm_set1_epi32((el.iu << 16) | el.iu_minus_coef), wv_minus, wv);
+
+					if (is_alpha_channel)
+					{
+						const unsigned alpha_chn = px.element.alpha_channel;
+						if (alpha_chn)
+						{
+							if (alpha_chn != 255)
+							{
+								i->element.red = unsigned(i->element.red * (255 - alpha_chn) + px.element.red * alpha_chn) / 255;
+								i->element.green = unsigned(i->element.green * (255 - alpha_chn) + px.element.green * alpha_chn) / 255;
+								i->element.blue = unsigned(i->element.blue * (255 - alpha_chn) + px.element.blue * alpha_chn) / 255;
+							}
+							else
+								i->value = (px.value & 0xFFFFFF) | (i->value & 0xFF000000);
+						}
+					}
+					else
+						i->value = (px.value & 0xFFFFFF) | (i->value & 0xFF000000);
+				}
+			}
+		}//end namespace simd
+
+		template<void(*RowProcessor)(pixel_argb_t*, const pixel_argb_t*, unsigned)>
+		class alpha_blend_simd
+			: public image_process::alpha_blend_interface
+		{
+			//process
+			virtual void process(const paint::pixel_buffer& s_pixbuf, const nana::rectangle& s_r, paint::pixel_buffer& d_pixbuf, const nana::point& d_pos) const
+			{
+				auto d_rgb = d_pixbuf.at(d_pos);
+				auto s_rgb = s_pixbuf.raw_ptr(s_r.y) + s_r.x;
+				if (d_rgb && s_rgb)
+				{
+					const auto d_bytes_pl = d_pixbuf.bytes_per_line();
+					const auto s_bytes_pl = s_pixbuf.bytes_per_line();
+					image_process_provider::instance().parallel_bands(s_r.height, s_r.width, [&](std::size_t begin, std::size_t end)
+					{
+						for (auto line = begin; line < end; ++line)
+							RowProcessor(pixel_at(d_rgb, line * d_bytes_pl), pixel_at(s_rgb, line * s_bytes_pl), s_r.width);
+					});
+				}
+			}
+		};
+
+		template<void(*RowProcessor)(pixel_argb_t*, const pixel_argb_t*, unsigned, unsigned)>
+		class blend_simd
+			: public image_process::blend_interface
+		{
+			//process
+			virtual void process(const paint::pixel_buffer& s_pixbuf, const nana::rectangle& s_r, paint::pixel_buffer& d_pixbuf, const nana::point& d_pos, double fade_rate) const
+			{
+				auto d_rgb = d_pixbuf.raw_ptr(d_pos.y) + d_pos.x;
+				auto s_rgb = s_pixbuf.raw_ptr(s_r.y) + s_r.x;
+				if (d_rgb && s_rgb)
+				{
+					const auto fade16 = simd::fade_rate16(fade_rate);
+					const auto d_bytes_pl = d_pixbuf.bytes_per_line();
+					const auto s_bytes_pl = s_pixbuf.bytes_per_line();
+					image_process_provider::instance().parallel_bands(s_r.height, s_r.width, [&](std::size_t begin, std::size_t end)
+					{
+						for (auto line = begin; line < end; ++line)
+							RowProcessor(pixel_at(d_rgb, line * d_bytes_pl), pixel_at(s_rgb, line * s_bytes_pl), s_r.width, fade16);
+					});
+				}
+			}
+		};
+
+		using alpha_blend_sse2 = alpha_blend_simd<simd::alpha_blend_row_sse2>;
+		using alpha_blend_avx2 = alpha_blend_simd<simd::alpha_blend_row_avx2>;
+		using blend_sse2 = blend_simd<simd::blend_row_sse2>;
+		using blend_avx2 = blend_simd<simd::blend_row_avx2>;
+
+		class bilinear_interoplation_sse2
+			: public image_process::stretch_interface
+		{
+			void process(const paint::pixel_buffer & s_pixbuf, const nana::rectangle& r_src, paint::pixel_buffer & pixbuf, const nana::rectangle& r_dst) const
+			{
+				const auto s_bytes_per_line = s_pixbuf.bytes_per_line();
+
+				const int shift_size = 8;
+				const std::size_t coef = 1 << shift_size;
+
+				double rate_x = double(r_src.width) / r_dst.width;
+				double rate_y = double(r_src.height) / r_dst.height;
+
+				const int right_bound = static_cast<int>(r_src.width) - 1 + r_src.x;
+
+				const nana::pixel_argb_t * s_raw_pixel_buffer = s_pixbuf.raw_ptr(0);
+
+				const int bottom = r_src.y + static_cast<int>(r_src.height - 1);
+
+				std::unique_ptr<simd::bilinear_column[]> x_u_table{ new simd::bilinear_column[r_dst.width] };
+
+				for(std::size_t x = 0; x < r_dst.width; ++x)
+				{
+					double u = (int(x) + 0.5) * rate_x - 0.5;
+					simd::bilinear_column el;
+					el.x = r_src.x;
+					if(u < 0)
+					{
+						u = 0;
+					}
+					else
+					{
+						int ipart = static_cast<int>(u);
+						el.x += ipart;
+						u -= ipart;
+					}
+					el.iu = static_cast<int>(u * coef);
+					el.iu_minus_coef = coef - el.iu;
+					x_u_table[x] = el;
+				}
+
+				const bool is_alpha_channel = s_pixbuf.alpha_channel();
+
+				image_process_provider::instance().parallel_bands(r_dst.height, r_dst.width, [&](std::size_t begin, std::size_t end)
+				{
+					for(std::size_t row = begin; row < end; ++row)
+					{
+						double v = (int(row) + 0.5) * rate_y - 0.5;
+						int sy = r_src.y;
+						if(v < 0)
+						{
+							v = 0;
+						}
+						else
+						{
+							int ipart = static_cast<int>(v);
+							sy += ipart;
+							v -= ipart;
+						}
+
+						const unsigned iv = static_cast<unsigned>(v * coef);
+
+						const nana::pixel_argb_t * s_line = pixel_at(s_raw_pixel_buffer,  sy * s_bytes_per_line);
+						const nana::pixel_argb_t * next_s_line = pixel_at(s_line, (sy < bottom ? s_bytes_per_line : 0));
+
+						simd::bilinear_row_sse2(pixbuf.raw_ptr(row + r_dst.y) + r_dst.x, s_line, next_s_line, x_u_table.get(), r_dst.width, right_bound, iv, is_alpha_channel);
+					}
+				});
+			}
+		};
+	}
+}
+}
+}
+#endif	//NANA_SIMD_X86
+#endif
@@ -15,11 +15,13 @@
 #include <nana/paint/detail/native_paint_interface.hpp>
 #include <nana/paint/pixel_buffer.hpp>
 #include <nana/gui/layout_utility.hpp>
+#include <limits>
 
 #if defined(NANA_WINDOWS)
 	#include <windows.h>
 #elif defined(NANA_X11)
 	#include <X11/Xlib.h>
+	#include <algorithm>
 #endif
 
 namespace nana
@@ -143,12 +145,9 @@ namespace detail
 			return nana::size(size.cx, size.cy);
 #elif defined(NANA_X11)
 	#if defined(NANA_USE_XFT)
-		std::string utf8str = to_utf8(std::wstring(text, len));
-		XGlyphInfo ext;
+		//The width is the sum of glyph advances, it is same as what XftTextExtents returns.
 		XftFont * fs = reinterpret_cast<XftFont*>(dw->font->native_handle());
-		::XftTextExtentsUtf8(nana::detail::platform_spec::instance().open_display(), fs,
-								reinterpret_cast<XftChar8*>(const_cast<char*>(utf8str.c_str())), utf8str.size(), &ext);
-		return nana::size(ext.xOff, fs->ascent + fs->descent);
+		return nana::size(dw->font->glyph_advances(text, len, nullptr), fs->ascent + fs->descent);
 	#else
 		XRectangle ink;
 		XRectangle logic;
@@ -187,6 +186,68 @@ namespace detail
 	#if defined(NANA_USE_XFT)
 		auto fs = reinterpret_cast<XftFont*>(dw->font->native_handle());
 
+		if (dw->glyph_run.depth)
+		{
+			//Defer the glyphs, they are appended to the last group if it is in current text color, otherwise a
+			//new group is started to keep the drawing order of overlapped text.
+			auto & run = dw->glyph_run;
+			auto const & clr = dw->xft_fgcolor.color;
+
+			bool same_color = false;
+			if (run.used)
+			{
+				auto const & last = run.groups[run.used - 1].color.color;
+				same_color = (last.red == clr.red && last.green == clr.green && last.blue == clr.blue && last.alpha == clr.alpha);
+			}
+
+			if (!same_color)
+			{
+				if (run.used == run.groups.size())
+					run.groups.emplace_back();
+
+				run.groups[run.used++].color = dw->xft_fgcolor;
+			}
+
+			auto grp = &run.groups[run.used - 1];
+
+			auto & advances = dw->glyph_run.advances;
+			advances.resize(len);
+			dw->font->glyph_advances(str, len, advances.data());
+
+			//The coordinates of XftGlyphFontSpec are 16-bit. A glyph whose origin is out of the range is outside of
+			//any drawable, it is dropped instead of being wrapped around into the drawable.
+			auto const in_range = [](long long v)
+			{
+				return ((std::numeric_limits<short>::min)() <= v && v <= (std::numeric_limits<short>::max)());
+			};
+
+			long long const y = static_cast<long long>(pos.y) + fs->ascent;
+			if (in_range(y))
+			{
+				XftGlyphFontSpec spec;
+				spec.font = fs;
+				spec.y = static_cast<short>(y);
+
+				long long x = pos.x;
+				for (std::size_t i = 0; i < len; ++i)
+				{
+					if (in_range(x))
+					{
+						spec.x = static_cast<short>(x);
+						spec.glyph = ::XftCharIndex(disp, fs, str[i]);
+						grp->glyphs.push_back(spec);
+					}
+					else if (x > 0)
+						break;
+
+					x += advances[i];
+				}
+			}
+
+			dw->glyph_run.pending = true;
+			return;
+		}
+
 		//Fixed missing array declaration by dareg
 		std::unique_ptr<FT_UInt[]> glyphs_ptr(new FT_UInt[len]);
 		auto glyphs = glyphs_ptr.get();
@@ -214,6 +275,16 @@ namespace detail
 		}
 		XmbDrawString(display, dw->pixmap, reinterpret_cast<XFontSet>(dw->font->handle), dw->context, pos.x, pos.y + ascent + descent, buf, len);
 	#endif
+#endif
+	}
+
+	void flush_glyph_run(drawable_type dw)
+	{
+#if defined(NANA_USE_XFT)
+		if (dw && dw->glyph_run.pending)
+			dw->flush_glyph_run();
+#else
+		static_cast<void>(dw);
 #endif
 	}
 }//end namespace detail
@@ -384,6 +384,9 @@ namespace paint
 			impl_->font_shadow = f;
 			if(impl_->handle && (false == f.empty()))
 			{
+				//The deferred glyphs refer to the native handle of current font, which may be released.
+				detail::flush_glyph_run(impl_->handle);
+
 				impl_->handle->font = f.impl_->real_font;
 #if defined(NANA_WINDOWS)
 				::SelectObject(impl_->handle->context, reinterpret_cast<HFONT>(f.impl_->real_font->native_handle()));
@@ -485,19 +488,10 @@ namespace paint
 			delete [] dx;
 #elif defined(NANA_X11) && defined(NANA_USE_XFT)
 
-			auto disp = nana::detail::platform_spec::instance().open_display();
-			auto xft = reinterpret_cast<XftFont*>(impl_->handle->font->native_handle());
-
-			XGlyphInfo extents;
+			impl_->handle->font->glyph_advances(str, len, pxbuf);
 			for(std::size_t i = 0; i < len; ++i)
 			{
-				if(str[i] != '\t')
-				{
-					FT_UInt glyphs = ::XftCharIndex(disp, xft, str[i]);
-					::XftGlyphExtents(disp, xft, &glyphs, 1, &extents);
-					pxbuf[i] = extents.xOff;
-				}
-				else
+				if(str[i] == '\t')
 					pxbuf[i] = tab_pixels;
 			}
 #endif
@@ -598,6 +592,7 @@ namespace paint
 				::BitBlt(impl_->handle->context, r_dst.x, r_dst.y, r_dst.width, r_dst.height, dc, 0, 0, SRCCOPY);
 				::ReleaseDC(reinterpret_cast<HWND>(src), dc);
 #elif defined(NANA_X11)
+				detail::flush_glyph_run(impl_->handle);
 				::XCopyArea(nana::detail::platform_spec::instance().open_display(),
 						reinterpret_cast<Window>(src), impl_->handle->pixmap, impl_->handle->context,
 						0, 0, r_dst.width, r_dst.height, r_dst.x, r_dst.y);
@@ -615,6 +610,7 @@ namespace paint
 				::BitBlt(impl_->handle->context, r_dst.x, r_dst.y, r_dst.width, r_dst.height, dc, p_src.x, p_src.y, SRCCOPY);
 				::ReleaseDC(reinterpret_cast<HWND>(src), dc);
 #elif defined(NANA_X11)
+				detail::flush_glyph_run(impl_->handle);
 				::XCopyArea(nana::detail::platform_spec::instance().open_display(),
 						reinterpret_cast<Window>(src), impl_->handle->pixmap, impl_->handle->context,
 						p_src.x, p_src.y, r_dst.width, r_dst.height, r_dst.x, r_dst.y);
@@ -630,6 +626,8 @@ namespace paint
 #if defined(NANA_WINDOWS)
 				::BitBlt(impl_->handle->context, r_dst.x, r_dst.y, r_dst.width, r_dst.height, src.impl_->handle->context, 0, 0, SRCCOPY);
 #elif defined(NANA_X11)
+				detail::flush_glyph_run(src.impl_->handle);
+				detail::flush_glyph_run(impl_->handle);
 				::XCopyArea(nana::detail::platform_spec::instance().open_display(),
 						src.impl_->handle->pixmap, impl_->handle->pixmap, impl_->handle->context,
 						0, 0, r_dst.width, r_dst.height, r_dst.x, r_dst.y);
@@ -645,6 +643,8 @@ namespace paint
 #if defined(NANA_WINDOWS)
 				::BitBlt(impl_->handle->context, r_dst.x, r_dst.y, r_dst.width, r_dst.height, src.impl_->handle->context, p_src.x, p_src.y, SRCCOPY);
 #elif defined(NANA_X11)
+				detail::flush_glyph_run(src.impl_->handle);
+				detail::flush_glyph_run(impl_->handle);
 				::XCopyArea(nana::detail::platform_spec::instance().open_display(),
 						src.impl_->handle->pixmap, impl_->handle->pixmap, impl_->handle->context,
 						p_src.x, p_src.y, r_dst.width, r_dst.height, r_dst.x, r_dst.y);
@@ -754,6 +754,9 @@ namespace paint
 #if defined(NANA_WINDOWS)
 				::BitBlt(dst.impl_->handle->context, x, y, impl_->size.width, impl_->size.height, impl_->handle->context, 0, 0, SRCCOPY);
 #elif defined(NANA_X11)
+				detail::flush_glyph_run(impl_->handle);
+				detail::flush_glyph_run(dst.impl_->handle);
+
 				Display* display = nana::detail::platform_spec::instance().open_display();
 				::XCopyArea(display,
 					impl_->handle->pixmap, dst.impl_->handle->pixmap, impl_->handle->context,
@@ -787,7 +790,8 @@ namespace paint
 				Display * display = spec.open_display();
 				
 				nana::detail::platform_scope_guard lock;
-				
+
+				detail::flush_glyph_run(impl_->handle);
 				::XCopyArea(display,
 					impl_->handle->pixmap, reinterpret_cast<Window>(dst), impl_->handle->context,
 						sx, sy, width, height, dx, dy);
@@ -803,6 +807,44 @@ namespace paint
 			}
 		}
 
+		void graphics::paste(native_window_type dst, const std::vector<::nana::rectangle>& areas) const
+		{
+			if (impl_->handle && !areas.empty())
+			{
+#if defined(NANA_WINDOWS)
+				HDC dc = ::GetDC(reinterpret_cast<HWND>(dst));
+				if (dc)
+				{
+					for (auto & r : areas)
+						::BitBlt(dc, r.x, r.y, r.width, r.height, impl_->handle->context, r.x, r.y, SRCCOPY);
+					::ReleaseDC(reinterpret_cast<HWND>(dst), dc);
+				}
+#elif defined(NANA_X11)
+				auto & spec = nana::detail::platform_spec::instance();
+
+				Display * display = spec.open_display();
+
+				nana::detail::platform_scope_guard lock;
+
+				detail::flush_glyph_run(impl_->handle);
+				for (auto & r : areas)
+				{
+					::XCopyArea(display,
+						impl_->handle->pixmap, reinterpret_cast<Window>(dst), impl_->handle->context,
+							r.x, r.y, r.width, r.height, r.x, r.y);
+				}
+
+				XWindowAttributes attr;
+				spec.set_error_handler();
+				::XGetWindowAttributes(display, reinterpret_cast<Window>(dst), &attr);
+				if (BadWindow != spec.rev_error_handler() && attr.map_state != IsUnmapped)
+					::XMapWindow(display, reinterpret_cast<Window>(dst));
+
+				::XFlush(display);
+#endif
+			}
+		}
+
 		void graphics::paste(drawable_type dst, int x, int y) const
 		{
 			if(impl_->handle && dst && impl_->handle != dst)
@@ -810,6 +852,9 @@ namespace paint
 #if defined (NANA_WINDOWS)
 				::BitBlt(dst->context, x, y, impl_->size.width, impl_->size.height, impl_->handle->context, 0, 0, SRCCOPY);
 #elif defined(NANA_X11)
+				detail::flush_glyph_run(impl_->handle);
+				detail::flush_glyph_run(dst);
+
 				Display * display = nana::detail::platform_spec::instance().open_display();
 				::XCopyArea(display,
 					impl_->handle->pixmap, dst->pixmap, impl_->handle->context,
@@ -827,6 +872,9 @@ namespace paint
 #if defined(NANA_WINDOWS)
 				::BitBlt(dst.impl_->handle->context, x, y, r_src.width, r_src.height, impl_->handle->context, r_src.x, r_src.y, SRCCOPY);
 #elif defined(NANA_X11)
+				detail::flush_glyph_run(impl_->handle);
+				detail::flush_glyph_run(dst.impl_->handle);
+
 				Display* display = nana::detail::platform_spec::instance().open_display();
 				::XCopyArea(display,
 					impl_->handle->pixmap, dst.impl_->handle->pixmap, impl_->handle->context,
@@ -858,6 +906,25 @@ namespace paint
 #endif
 		}
 
+		void graphics::glyph_run_begin()
+		{
+#if defined(NANA_USE_XFT)
+			if (impl_->handle)
+				++(impl_->handle->glyph_run.depth);
+#endif
+		}
+
+		void graphics::glyph_run_end()
+		{
+#if defined(NANA_USE_XFT)
+			if (impl_->handle && impl_->handle->glyph_run.depth)
+			{
+				if (0 == --(impl_->handle->glyph_run.depth))
+					impl_->handle->flush_glyph_run();
+			}
+#endif
+		}
+
 		unsigned graphics::width() const{
 			return impl_->size.width;
 		}
@@ -37,6 +37,16 @@ namespace nana
 				detail::image_process_provider & p = detail::image_process_provider::instance();
 				p.set(p.ref_blur_tag(), name);			
 			}
+
+			void selector::concurrency(std::size_t max_threads)
+			{
+				detail::image_process_provider::instance().concurrency(max_threads);
+			}
+
+			void selector::concurrency_threshold(std::size_t pixels)
+			{
+				detail::image_process_provider::instance().concurrency_threshold(pixels);
+			}
 			//end class selector
 		}
 	}
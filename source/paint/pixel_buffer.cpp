@@ -21,6 +21,15 @@
 #include <cstring>
 #include <cmath>
 
+#if defined(NANA_X11)
+#	include <X11/extensions/XShm.h>
+#	include <sys/ipc.h>
+#	include <sys/shm.h>
+#	include <cstdlib>
+#	include <vector>
+#	include <algorithm>
+#endif
+
 namespace nana{	namespace paint
 {
 	nana::rectangle valid_rectangle(const size& s, const rectangle& r)
@@ -45,6 +54,205 @@ namespace nana{	namespace paint
 	}
 #endif
 
+#if defined(NANA_X11)
+	//The MIT-SHM segments which are shared with the X server. The pixels of XShmGetImage and XShmPutImage
+	//are transferred through a segment rather than the X connection. The segments are kept for reusing,
+	//because attaching a segment to the X server requires a round trip.
+	class shm_pool
+	{
+		shm_pool()
+		{
+			nana::detail::platform_scope_guard psg;
+			available_ = (True == ::XShmQueryExtension(nana::detail::platform_spec::instance().open_display()));
+		}
+	public:
+		//The pixels of a small image are transferred through the X connection, it is cheaper than a round trip.
+		static constexpr std::size_t min_bytes = 0x10000;
+		static constexpr std::size_t max_idle = 4;
+
+		struct segment
+		{
+			XShmSegmentInfo info;
+			std::size_t bytes;
+		};
+
+		~shm_pool()
+		{
+			for (auto seg : idle_)
+				_m_destroy(seg);
+		}
+
+		static shm_pool& instance()
+		{
+			static shm_pool obj;
+			return obj;
+		}
+
+		//@brief: Returns a segment which is not less than the specified bytes. It returns nullptr if the
+		//		MIT-SHM is not supported by the X server, e.g. a remote display.
+		segment* acquire(std::size_t bytes)
+		{
+			nana::detail::platform_scope_guard psg;
+			if (!available_)
+				return nullptr;
+
+			segment * fit = nullptr;
+			for (auto i = idle_.begin(); i != idle_.end(); ++i)
+			{
+				if (((*i)->bytes >= bytes) && ((nullptr == fit) || ((*i)->bytes < fit->bytes)))
+					fit = *i;
+			}
+
+			if (fit)
+			{
+				idle_.erase(std::find(idle_.begin(), idle_.end(), fit));
+				return fit;
+			}
+
+			return _m_create((bytes + min_bytes - 1) / min_bytes * min_bytes);
+		}
+
+		void release(segment* seg)
+		{
+			nana::detail::platform_scope_guard psg;
+			idle_.push_back(seg);
+			if (idle_.size() > max_idle)
+			{
+				//Destroys the smallest one
+				auto i = std::min_element(idle_.begin(), idle_.end(), [](const segment* a, const segment* b){
+					return a->bytes < b->bytes;
+				});
+				_m_destroy(*i);
+				idle_.erase(i);
+			}
+		}
+	private:
+		segment* _m_create(std::size_t bytes)
+		{
+			auto & spec = nana::detail::platform_spec::instance();
+			auto disp = spec.open_display();
+
+			std::unique_ptr<segment> seg{ new segment };
+			seg->bytes = bytes;
+			seg->info.shmid = ::shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+			if (seg->info.shmid < 0)
+				return nullptr;
+
+			seg->info.shmaddr = reinterpret_cast<char*>(::shmat(seg->info.shmid, nullptr, 0));
+			if (reinterpret_cast<char*>(-1) == seg->info.shmaddr)
+			{
+				::shmctl(seg->info.shmid, IPC_RMID, nullptr);
+				return nullptr;
+			}
+			seg->info.readOnly = False;
+
+			//The X server refuses the attachment if it can't access the segment, such as the remote display
+			//which advertises the extension. The MIT-SHM is disabled from then on.
+			spec.set_error_handler();
+			auto attached = ::XShmAttach(disp, &seg->info);
+			::XSync(disp, False);
+			if (spec.rev_error_handler() || !attached)
+			{
+				available_ = false;
+				::shmdt(seg->info.shmaddr);
+				::shmctl(seg->info.shmid, IPC_RMID, nullptr);
+				return nullptr;
+			}
+
+			//The segment is removed by the system after both the client and X server detach it.
+			::shmctl(seg->info.shmid, IPC_RMID, nullptr);
+			return seg.release();
+		}
+
+		static void _m_destroy(segment* seg)
+		{
+			::XShmDetach(nana::detail::platform_spec::instance().open_display(), &seg->info);
+			::shmdt(seg->info.shmaddr);
+			delete seg;
+		}
+	private:
+		bool available_;
+		std::vector<segment*> idle_;
+	};
+
+	//An XImage whose pixels are stored in a segment of shm_pool. The image() returns nullptr if
+	//the MIT-SHM is unavailable or the image format is not the 32bits per pixel.
+	class shm_image
+		: private nana::noncopyable
+	{
+	public:
+		shm_image(unsigned width, unsigned height)
+		{
+			const std::size_t bytes = std::size_t(width) * height * sizeof(pixel_color_t);
+			if (bytes < shm_pool::min_bytes)
+				return;
+
+			auto & spec = nana::detail::platform_spec::instance();
+			const int depth = spec.screen_depth();
+			if (24 != depth && 32 != depth)
+				return;
+
+			seg_ = shm_pool::instance().acquire(bytes);
+			if (!seg_)
+				return;
+
+			nana::detail::platform_scope_guard psg;
+			image_ = ::XShmCreateImage(spec.open_display(), spec.screen_visual(), depth, ZPixmap, nullptr, &seg_->info, width, height);
+			if (image_ && (32 == image_->bits_per_pixel) && (std::size_t(image_->bytes_per_line) == width * sizeof(pixel_color_t)))
+			{
+				image_->data = seg_->info.shmaddr;
+				return;
+			}
+
+			if (image_)
+				XDestroyImage(image_);
+
+			image_ = nullptr;
+			shm_pool::instance().release(seg_);
+			seg_ = nullptr;
+		}
+
+		~shm_image()
+		{
+			if (image_)
+			{
+				image_->data = nullptr;	//The data is owned by the segment
+				XDestroyImage(image_);
+				shm_pool::instance().release(seg_);
+			}
+		}
+
+		XImage* image() const
+		{
+			return image_;
+		}
+
+		pixel_color_t* pixels() const
+		{
+			return reinterpret_cast<pixel_color_t*>(image_->data);
+		}
+
+		bool get(Drawable dw, int x, int y)
+		{
+			nana::detail::platform_scope_guard psg;
+			return (True == ::XShmGetImage(nana::detail::platform_spec::instance().open_display(), dw, image_, x, y, AllPlanes));
+		}
+
+		void put(Drawable dw, GC gc, int src_x, int src_y, int x, int y, unsigned width, unsigned height)
+		{
+			auto disp = nana::detail::platform_spec::instance().open_display();
+			nana::detail::platform_scope_guard psg;
+			::XShmPutImage(disp, dw, gc, image_, src_x, src_y, x, y, width, height, False);
+
+			//The X server reads the segment asynchronously, wait for it before the pixels are modified.
+			::XSync(disp, False);
+		}
+	private:
+		XImage * image_{ nullptr };
+		shm_pool::segment * seg_{ nullptr };
+	};
+#endif
+
 	struct pixel_buffer::pixel_buffer_storage
 		: private nana::noncopyable
 	{
@@ -86,6 +294,7 @@ namespace nana{	namespace paint
 		{
 			bool attached;
 			XImage * image;
+			std::unique_ptr<shm_image> shm;	//The image is shared with X server when it is not null
 		}x11;
 #endif
 
@@ -138,9 +347,20 @@ namespace nana{	namespace paint
 			nana::detail::platform_spec & spec = nana::detail::platform_spec::instance();
 
 			//Ensure that the pixmap is updated before we copy its content.
+			paint::detail::flush_glyph_run(drawable);
 			::XFlush(spec.open_display());
-			x11.image = ::XGetImage(spec.open_display(), drawable->pixmap, valid_r.x, valid_r.y, valid_r.width, valid_r.height, AllPlanes, ZPixmap);
 			x11.attached = true;
+
+			x11.shm.reset(new shm_image(valid_r.width, valid_r.height));
+			if (x11.shm->image() && x11.shm->get(drawable->pixmap, valid_r.x, valid_r.y))
+			{
+				x11.image = x11.shm->image();
+				raw_pixel_buffer = x11.shm->pixels();
+				return;
+			}
+			x11.shm.reset();
+
+			x11.image = ::XGetImage(spec.open_display(), drawable->pixmap, valid_r.x, valid_r.y, valid_r.width, valid_r.height, AllPlanes, ZPixmap);
 			if(nullptr == x11.image)
 				throw std::runtime_error("Nana.pixel_buffer: XGetImage failed");
 
@@ -173,7 +393,13 @@ namespace nana{	namespace paint
 			if(nullptr == drawable) //not attached
 				x11.image->data = nullptr;	//the image data is allocated by pixel_buffer when it is not attached with a drawable
 			else if(x11.attached)	//the image should be uploaded when it is attached.
+			{
+				paint::detail::flush_glyph_run(drawable);
 				put(drawable->pixmap, drawable->context, 0, 0, valid_r.x, valid_r.y, valid_r.width, valid_r.height);
+			}
+
+			if(x11.shm)	//raw_pixel_buffer refers to the segment of the shared image
+				return;
 
 			if(x11.image->data != reinterpret_cast<char*>(raw_pixel_buffer))
 				delete [] raw_pixel_buffer;
@@ -310,6 +536,29 @@ namespace nana{	namespace paint
 		void detach()
 		{
 			x11.attached = false;
+			if (x11.shm)
+			{
+				//Moves the pixels out of the shared image, the segment is returned to the pool for other transfers.
+				auto & spec = nana::detail::platform_spec::instance();
+				const std::size_t bytes = bytes_per_line * pixel_size.height;
+
+				auto data = reinterpret_cast<char*>(::malloc(bytes));
+				if (!data)
+					throw std::bad_alloc();
+
+				std::memcpy(data, raw_pixel_buffer, bytes);
+
+				//The data is freed by XDestroyImage
+				x11.image = ::XCreateImage(spec.open_display(), spec.screen_visual(), 32, ZPixmap, 0, data, pixel_size.width, pixel_size.height, 32, 0);
+				if (!x11.image)
+				{
+					::free(data);
+					throw std::runtime_error("Nana.pixel_buffer: XCreateImage failed");
+				}
+
+				raw_pixel_buffer = reinterpret_cast<pixel_color_t*>(data);
+				x11.shm.reset();
+			}
 		}
 
 		void put(Drawable dw, GC gc, int src_x, int src_y, int x, int y, unsigned width, unsigned height)
@@ -318,6 +567,31 @@ namespace nana{	namespace paint
 			Display * disp = spec.open_display();
 			const int depth = spec.screen_depth();
 
+			if(x11.shm)
+			{
+				x11.shm->put(dw, gc, src_x, src_y, x, y, width, height);
+				return;
+			}
+
+			if(sizeof(pixel_color_t) * 8 == depth || 24 == depth)
+			{
+				//Copies the pixels to a shared image, the X server reads them without transferring through the connection.
+				shm_image shm{ width, height };
+				if (shm.image())
+				{
+					auto d = shm.pixels();
+					auto s = raw_pixel_buffer + src_x + pixel_size.width * src_y;
+					for (unsigned row = 0; row < height; ++row)
+					{
+						std::memcpy(d, s, width * sizeof(pixel_color_t));
+						d += width;
+						s += pixel_size.width;
+					}
+					shm.put(dw, gc, 0, 0, x, y, width, height);
+					return;
+				}
+			}
+
 			XImage* img = ::XCreateImage(disp, spec.screen_visual(), depth, ZPixmap, 0, 0, pixel_size.width, pixel_size.height, (16 == depth ? 16 : 32), 0);
 			if(sizeof(pixel_color_t) * 8 == depth || 24 == depth)
 			{
@@ -485,9 +759,13 @@ namespace nana{	namespace paint
 		unsigned width, height;
 		unsigned border, depth;
 		nana::detail::platform_scope_guard psg;
+		paint::detail::flush_glyph_run(drawable);
 		::XFlush(spec.open_display());
 		::XGetGeometry(spec.open_display(), drawable->pixmap, &root, &x, &y, &width, &height, &border, &depth);
-		XImage * image = ::XGetImage(spec.open_display(), drawable->pixmap, r.x, r.y, r.width, r.height, AllPlanes, ZPixmap);
+		shm_image shm{ r.width, r.height };
+		XImage * image = shm.image();
+		if ((nullptr == image) || !shm.get(drawable->pixmap, r.x, r.y))
+			image = ::XGetImage(spec.open_display(), drawable->pixmap, r.x, r.y, r.width, r.height, AllPlanes, ZPixmap);
 
 		storage_ = std::make_shared<pixel_buffer_storage>(want_r.width, want_r.height);
 		auto pixbuf = storage_->raw_pixel_buffer;
@@ -536,11 +814,13 @@ namespace nana{	namespace paint
 		}
 		else
 		{
-			XDestroyImage(image);
+			if(image != shm.image())
+				XDestroyImage(image);
 			return false;
 		}
 
-		XDestroyImage(image);
+		if(image != shm.image())
+			XDestroyImage(image);
 #endif
         return true;
 	}
@@ -731,6 +1011,7 @@ namespace nana{	namespace paint
 				src_r.x, static_cast<int>(sp->pixel_size.height) - src_r.y - src_r.height, 0, sp->pixel_size.height,
 				sp->raw_pixel_buffer, &bi, DIB_RGB_COLORS);
 #elif defined(NANA_X11)
+			paint::detail::flush_glyph_run(drawable);
 			sp->put(drawable->pixmap, drawable->context, src_r.x, src_r.y, p_dst.x, p_dst.y, src_r.width, src_r.height);
 #endif
 		}
@@ -16,12 +16,15 @@
 #include <deque>
 #include <vector>
 #include <atomic>
+#include <algorithm>
 
 #if defined(STD_THREAD_NOT_SUPPORTED)
+    #include <nana/std_thread.hpp>
     #include <nana/std_mutex.hpp>
     #include <nana/std_condition_variable.hpp>
 
 #else
+    #include <thread>
     #include <condition_variable>
     #include <mutex>
 #endif
@@ -413,5 +416,11 @@ namespace threads
 		}
 	//end class pool
 
+	pool& shared_pool()
+	{
+		//The calling thread of a parallel algorithm works as well, therefore a thread is left for it.
+		static pool shared((std::max)(std::thread::hardware_concurrency(), 2u) - 1);
+		return shared;
+	}
 }//end namespace threads
 }//end namespace nana